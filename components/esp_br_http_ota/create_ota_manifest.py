@@ -0,0 +1,69 @@
+#!/usr/bin/env python3
+
+import argparse
+import hashlib
+import json
+import struct
+import sys
+
+FILETAG_BR_OTA_IMAGE = 5
+FILETAG_BR_OTA_DELTA = 7
+FILETAG_IMAGE_FORMAT = 0xfe
+FILETAG_IMAGE_HEADER = 0xff
+FILETAG_MASK = 0xff
+
+HEADER_ENTRY_SIZE = 3 * 4
+
+
+def read_file(path):
+    with open(path, 'rb') as fin:
+        return fin.read()
+
+
+def get_rcp_image_id(image):
+    # The image ID is the SHA-256 of the header and the image format, which hold the digest of every other subfile.
+    tag, header_size, _ = struct.unpack_from('<LLL', image, 0)
+    if tag != FILETAG_IMAGE_HEADER or header_size % HEADER_ENTRY_SIZE != 0 or header_size > len(image):
+        sys.exit('Invalid RCP image header')
+    image_format_end = 0
+    for entry_offset in range(HEADER_ENTRY_SIZE, header_size, HEADER_ENTRY_SIZE):
+        tag, size, offset = struct.unpack_from('<LLL', image, entry_offset)
+        if tag & FILETAG_MASK in (FILETAG_BR_OTA_IMAGE, FILETAG_BR_OTA_DELTA):
+            sys.exit('The RCP image of a manifest shall not hold the Border Router firmware')
+        if tag & FILETAG_MASK == FILETAG_IMAGE_FORMAT:
+            image_format_end = offset + size
+    if image_format_end == 0:
+        sys.exit('The RCP image of a manifest shall be of version 2')
+    return hashlib.sha256(image[:image_format_end]).hexdigest()
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Create the manifest of the RCP image and the Border Router firmware '
+                                     'updated by esp_br_http_ota_manifest()')
+    parser.add_argument('--rcp-image', type=str, required=False,
+                        help='The RCP image created by create_ota_image.py without --br-firmware')
+    parser.add_argument('--rcp-url', type=str, required=False,
+                        help='The URL of the RCP image, relative to the manifest or absolute')
+    parser.add_argument('--host-firmware', type=str, required=False, help='The Border Router firmware binary')
+    parser.add_argument('--host-url', type=str, required=False,
+                        help='The URL of the Border Router firmware, relative to the manifest or absolute')
+    parser.add_argument('--output', type=str, required=True)
+    args = parser.parse_args()
+    if bool(args.rcp_image) != bool(args.rcp_url) or bool(args.host_firmware) != bool(args.host_url):
+        sys.exit('Each component requires both its file and its URL')
+    manifest = {}
+    if args.rcp_image:
+        rcp_image = read_file(args.rcp_image)
+        manifest['rcp'] = {'url': args.rcp_url, 'size': len(rcp_image), 'sha256': get_rcp_image_id(rcp_image)}
+    if args.host_firmware:
+        host_firmware = read_file(args.host_firmware)
+        manifest['host'] = {'url': args.host_url, 'size': len(host_firmware),
+                            'sha256': hashlib.sha256(host_firmware).hexdigest()}
+    if not manifest:
+        sys.exit('The manifest shall list at least one component')
+    with open(args.output, 'w') as fout:
+        json.dump(manifest, fout, indent=4)
+
+
+if __name__ == '__main__':
+    main()
@@ -6,7 +6,10 @@
 
 #pragma once
 
+#include <stdbool.h>
+
 #include "esp_http_client.h"
+#include "esp_rcp_progress.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -15,6 +18,9 @@ extern "C" {
 /**
  * @brief This function performs Border Router OTA by downloading from a HTTPS server.
  *
+ * With CONFIG_BR_HTTP_OTA_RESUME enabled, a download interrupted by the network is resumed with HTTP Range requests,
+ * and a download interrupted by a restart is resumed from the checkpoint saved in NVS by the next call.
+ *
  * @param[in] http_config       The HTTP server download config
  *
  * @return
@@ -26,6 +32,133 @@ extern "C" {
  */
 esp_err_t esp_br_http_ota(esp_http_client_config_t *http_config);
 
+/**
+ * @brief This function registers the callback reporting the progress of writing the Border Router firmware.
+ *
+ * The progress of the ESP_RCP_PROGRESS_PHASE_HOST_DOWNLOAD phase is reported. The progress of storing the RCP image
+ * is reported by the callback registered with esp_rcp_ota_register_progress_callback().
+ *
+ * @param[in] callback  The progress callback, NULL to unregister it.
+ * @param[in] user_ctx  The user context passed to the callback.
+ *
+ * @return
+ *  - ESP_OK
+ *
+ */
+esp_err_t esp_br_http_ota_register_progress_callback(esp_rcp_progress_cb_t callback, void *user_ctx);
+
+/**
+ * @brief The sink of the image downloaded by esp_br_http_ota_bench().
+ */
+typedef enum {
+    ESP_BR_HTTP_OTA_BENCH_SINK_NULL = 0, /*!< The image is discarded once received */
+    ESP_BR_HTTP_OTA_BENCH_SINK_STORAGE,  /*!< The image is written to the RCP image storage and the OTA partition */
+} esp_br_http_ota_bench_sink_t;
+
+/**
+ * @brief The configuration of esp_br_http_ota_bench().
+ */
+typedef struct {
+    esp_br_http_ota_bench_sink_t sink; /*!< Where the downloaded image is written */
+    size_t read_size;                  /*!< The bytes requested by each read of the connection, 0 for the default */
+    bool confirm_overwrite;            /*!< Shall be true with the storage sink, which overwrites the backup images */
+} esp_br_http_ota_bench_config_t;
+
+/**
+ * @brief The time spent in each phase of the download by esp_br_http_ota_bench().
+ */
+typedef struct {
+    int64_t connect_us;        /*!< The time to connect to the server and receive the response headers */
+    int64_t total_us;          /*!< The time from the connection to the end of the download */
+    uint32_t network_bytes;    /*!< The bytes read from the connection */
+    int64_t network_us;        /*!< The time spent reading the connection */
+    uint32_t rcp_store_bytes;  /*!< The bytes of the image passed to the RCP OTA, 0 with the null sink */
+    int64_t rcp_store_us;      /*!< The time spent storing the RCP image */
+    uint32_t host_write_bytes; /*!< The bytes of the Border Router firmware written, 0 with the null sink */
+    int64_t host_write_us;     /*!< The time spent writing the Border Router firmware to the OTA partition */
+} esp_br_http_ota_bench_result_t;
+
+/**
+ * @brief This function downloads an OTA image and measures the throughput of each phase, without updating anything.
+ *
+ * The connection is read and the data is written in turn, so the time of each phase is measured alone. With the
+ * storage sink the RCP image and the Border Router firmware are written to the inactive RCP image slot and the next
+ * OTA partition, but the image is neither submitted nor set as the boot partition, and the OTA checkpoint is erased.
+ * The inactive slot holds the RCP image rolled back to if the running one fails, so the storage sink is only run with
+ * confirm_overwrite set.
+ *
+ * @param[in]  http_config      The HTTP server download config
+ * @param[in]  bench_config     The benchmark config
+ * @param[out] result           The time spent in each phase
+ *
+ * @return
+ *  - ESP_OK
+ *  - ESP_FAIL
+ *  - ESP_ERR_NO_MEM            If the read buffer cannot be allocated.
+ *  - ESP_ERR_INVALID_ARG       If an argument is NULL, the http config does not contain an url, or the storage sink
+ *                              is not confirmed.
+ *  - ESP_ERR_INVALID_SIZE      If the image is truncated, with the storage sink.
+ *
+ */
+esp_err_t esp_br_http_ota_bench(esp_http_client_config_t *http_config,
+                                const esp_br_http_ota_bench_config_t *bench_config,
+                                esp_br_http_ota_bench_result_t *result);
+
+/**
+ * @brief This function updates the RCP image and the Border Router firmware listed by a manifest.
+ *
+ * The manifest is a JSON object with the optional "rcp" and "host" entries, each holding the "url", the "size" and
+ * the hex "sha256" digest of the component. A relative URL is resolved against the URL of the manifest. The digest
+ * of the RCP image is its image ID, the SHA-256 of its header and image format, so the RCP image shall be of
+ * version 2. The digest of the Border Router firmware is the one of its binary.
+ *
+ * The components whose digest matches the installed one are skipped, the others are fetched on concurrent HTTP
+ * connections. Nothing is switched unless both are fetched and verified. The RCP image slot and the boot partition
+ * are then switched together, and the switch is completed by esp_br_http_ota_init() on the next boot if
+ * the device restarts in between.
+ *
+ * @param[in]  http_config      The HTTP config of the manifest, also used to fetch the components
+ * @param[out] updated          Whether any component is updated, the device shall then restart
+ *
+ * @return
+ *  - ESP_OK
+ *  - ESP_FAIL
+ *  - ESP_ERR_NO_MEM            If the buffers or the fetch tasks cannot be allocated.
+ *  - ESP_ERR_INVALID_ARG       If an argument is NULL, the http config does not contain an url, or the manifest is
+ *                              invalid.
+ *  - ESP_ERR_INVALID_SIZE      If the manifest is too large or a component does not match its size.
+ *  - ESP_ERR_INVALID_CRC       If a component does not match its digest.
+ *
+ */
+esp_err_t esp_br_http_ota_manifest(esp_http_client_config_t *http_config, bool *updated);
+
+/**
+ * @brief This function initializes the Border Router OTA on boot.
+ *
+ * It completes the manifest update interrupted by a restart, see esp_br_http_ota_complete_commit(). It shall be
+ * called on every boot once NVS is initialized, after esp_rcp_update_init() if the RCP update is enabled, and before
+ * the RCP is checked.
+ *
+ * @return
+ *  - ESP_OK                    If no update is pending or the update is completed.
+ *  - Others                    If the RCP image cannot be submitted or the boot partition cannot be set.
+ *
+ */
+esp_err_t esp_br_http_ota_init(void);
+
+/**
+ * @brief This function completes the manifest update interrupted by a restart while it was committed.
+ *
+ * It is called by esp_br_http_ota_init(). The RCP image is only submitted if the interrupted update included it, so
+ * esp_rcp_update_init() is not needed otherwise. The device restarts if the boot partition is switched.
+ *
+ * @return
+ *  - ESP_OK                    If no update is pending or the update is completed.
+ *  - Others                    If the RCP image cannot be submitted or the boot partition cannot be set.
+ *
+ */
+esp_err_t esp_br_http_ota_complete_commit(void);
+
 #define OTA_MAX_WRITE_SIZE 16
 
 #ifdef __cplusplus
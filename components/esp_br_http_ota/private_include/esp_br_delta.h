@@ -0,0 +1,82 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+#include "esp_rcp_firmware.h"
+#include "mbedtls/sha256.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The state of applying a host firmware delta subfile to the running firmware. */
+typedef struct {
+    esp_ota_handle_t ota_handle;          /* the OTA handle the new firmware is written to */
+    const esp_partition_t *source;        /* the partition of the running firmware */
+    esp_rcp_delta_header_t header;
+    size_t header_read;
+    esp_rcp_delta_op_t op;                /* the operation being received */
+    size_t op_read;                       /* the bytes of op received */
+    uint32_t op_done;                     /* the bytes of the inserted data of op written */
+    uint32_t target_written;              /* the bytes of the new firmware written */
+    mbedtls_sha256_context target_sha256; /* the digest of the new firmware written */
+    uint8_t *copy_buffer;
+} esp_br_delta_t;
+
+/**
+ * @brief Begin applying a host firmware delta to the running firmware.
+ *
+ * @param[out] delta       The delta state.
+ * @param[in]  ota_handle  The OTA handle the new firmware is written to with esp_ota_write().
+ *
+ * @return
+ *      -   ESP_OK              : On success
+ *      -   ESP_ERR_NOT_FOUND   : The running partition is not found
+ *      -   ESP_ERR_NO_MEM      : Failed to allocate the copy buffer
+ */
+esp_err_t esp_br_delta_begin(esp_br_delta_t *delta, esp_ota_handle_t ota_handle);
+
+/**
+ * @brief Apply the next @param size bytes of the delta subfile.
+ *
+ * The running firmware is checked against the source digest of the delta once the delta header is received.
+ *
+ * @return
+ *      -   ESP_OK              : On success
+ *      -   ESP_ERR_INVALID_CRC : The running firmware is not the source of the delta
+ *      -   ESP_ERR_INVALID_ARG : The delta is invalid
+ *      -   Other               : Failed to read the running firmware or to write the new firmware
+ */
+esp_err_t esp_br_delta_write(esp_br_delta_t *delta, const void *data, size_t size);
+
+/**
+ * @brief Finish applying the delta and check the new firmware against the target digest of the delta.
+ *
+ * The delta state is released regardless of the result.
+ *
+ * @return
+ *      -   ESP_OK                  : On success
+ *      -   ESP_ERR_INVALID_SIZE    : The delta is incomplete
+ *      -   ESP_ERR_INVALID_CRC     : The new firmware does not match its digest
+ */
+esp_err_t esp_br_delta_end(esp_br_delta_t *delta);
+
+/**
+ * @brief Release the delta state without checking the new firmware.
+ */
+void esp_br_delta_abort(esp_br_delta_t *delta);
+
+#ifdef __cplusplus
+}
+#endif
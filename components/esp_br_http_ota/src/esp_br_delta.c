@@ -0,0 +1,161 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "esp_br_delta.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_check.h"
+#include "esp_log.h"
+
+#define TAG "BR_DELTA"
+#define COPY_BUFFER_SIZE 4096
+
+esp_err_t esp_br_delta_begin(esp_br_delta_t *delta, esp_ota_handle_t ota_handle)
+{
+    memset(delta, 0, sizeof(*delta));
+    delta->ota_handle = ota_handle;
+    delta->source = esp_ota_get_running_partition();
+    ESP_RETURN_ON_FALSE(delta->source, ESP_ERR_NOT_FOUND, TAG, "Failed to find the running partition");
+    delta->copy_buffer = malloc(COPY_BUFFER_SIZE);
+    ESP_RETURN_ON_FALSE(delta->copy_buffer, ESP_ERR_NO_MEM, TAG, "Failed to allocate the copy buffer");
+    mbedtls_sha256_init(&delta->target_sha256);
+    mbedtls_sha256_starts(&delta->target_sha256, 0);
+    return ESP_OK;
+}
+
+static esp_err_t verify_source(esp_br_delta_t *delta)
+{
+    esp_err_t ret = ESP_OK;
+    uint8_t sha256[sizeof(delta->header.source_sha256)];
+    mbedtls_sha256_context ctx;
+
+    ESP_RETURN_ON_FALSE(delta->header.source_size <= delta->source->size, ESP_ERR_INVALID_CRC, TAG,
+                        "Delta source of %" PRIu32 " bytes exceeds the running partition", delta->header.source_size);
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_starts(&ctx, 0);
+    for (uint32_t done = 0; done < delta->header.source_size;) {
+        size_t read_size = delta->header.source_size - done < COPY_BUFFER_SIZE ? delta->header.source_size - done
+                                                                                : COPY_BUFFER_SIZE;
+        ESP_GOTO_ON_ERROR(esp_partition_read(delta->source, done, delta->copy_buffer, read_size), exit, TAG,
+                          "Failed to read the running firmware");
+        mbedtls_sha256_update(&ctx, delta->copy_buffer, read_size);
+        done += read_size;
+    }
+    mbedtls_sha256_finish(&ctx, sha256);
+    ESP_GOTO_ON_FALSE(memcmp(sha256, delta->header.source_sha256, sizeof(sha256)) == 0, ESP_ERR_INVALID_CRC, exit,
+                      TAG, "The running firmware is not the source of the delta");
+exit:
+    mbedtls_sha256_free(&ctx);
+    return ret;
+}
+
+static esp_err_t write_target(esp_br_delta_t *delta, const void *data, size_t size)
+{
+    ESP_RETURN_ON_ERROR(esp_ota_write(delta->ota_handle, data, size), TAG, "Failed to write ota");
+    mbedtls_sha256_update(&delta->target_sha256, data, size);
+    delta->target_written += size;
+    return ESP_OK;
+}
+
+static esp_err_t copy_source(esp_br_delta_t *delta, uint32_t offset, uint32_t size)
+{
+    while (size > 0) {
+        size_t copy_size = size < COPY_BUFFER_SIZE ? size : COPY_BUFFER_SIZE;
+        ESP_RETURN_ON_ERROR(esp_partition_read(delta->source, offset, delta->copy_buffer, copy_size), TAG,
+                            "Failed to read the running firmware");
+        ESP_RETURN_ON_ERROR(write_target(delta, delta->copy_buffer, copy_size), TAG, "Failed to copy");
+        offset += copy_size;
+        size -= copy_size;
+    }
+    return ESP_OK;
+}
+
+// Check the received operation, and apply it at once if it copies from the source.
+static esp_err_t start_op(esp_br_delta_t *delta)
+{
+    esp_rcp_delta_op_t *op = &delta->op;
+
+    ESP_RETURN_ON_FALSE(op->size <= delta->header.target_size - delta->target_written, ESP_ERR_INVALID_ARG, TAG,
+                        "Delta operation exceeds the new firmware");
+    if (op->type == ESP_RCP_DELTA_OP_COPY) {
+        ESP_RETURN_ON_FALSE(op->offset <= delta->header.source_size &&
+                                op->size <= delta->header.source_size - op->offset,
+                            ESP_ERR_INVALID_ARG, TAG, "Delta copy exceeds the source firmware");
+        ESP_RETURN_ON_ERROR(copy_source(delta, op->offset, op->size), TAG, "Failed to apply the delta");
+        delta->op_read = 0;
+    } else {
+        ESP_RETURN_ON_FALSE(op->type == ESP_RCP_DELTA_OP_INSERT, ESP_ERR_INVALID_ARG, TAG,
+                            "Invalid delta operation %" PRIu32, op->type);
+        delta->op_done = 0;
+        if (op->size == 0) {
+            delta->op_read = 0;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_br_delta_write(esp_br_delta_t *delta, const void *data, size_t size)
+{
+    const uint8_t *cur = data;
+
+    while (size > 0) {
+        size_t consumed = 0;
+        if (delta->header_read < sizeof(delta->header)) {
+            consumed = size < sizeof(delta->header) - delta->header_read ? size
+                                                                         : sizeof(delta->header) - delta->header_read;
+            memcpy((uint8_t *)&delta->header + delta->header_read, cur, consumed);
+            delta->header_read += consumed;
+            if (delta->header_read == sizeof(delta->header)) {
+                ESP_RETURN_ON_ERROR(verify_source(delta), TAG, "Failed to verify the delta source");
+                ESP_LOGI(TAG, "Applying the delta to %" PRIu32 " bytes of the running firmware",
+                         delta->header.source_size);
+            }
+        } else if (delta->op_read < sizeof(delta->op)) {
+            consumed = size < sizeof(delta->op) - delta->op_read ? size : sizeof(delta->op) - delta->op_read;
+            memcpy((uint8_t *)&delta->op + delta->op_read, cur, consumed);
+            delta->op_read += consumed;
+            if (delta->op_read == sizeof(delta->op)) {
+                ESP_RETURN_ON_ERROR(start_op(delta), TAG, "Invalid delta");
+            }
+        } else {
+            consumed = size < delta->op.size - delta->op_done ? size : delta->op.size - delta->op_done;
+            ESP_RETURN_ON_ERROR(write_target(delta, cur, consumed), TAG, "Failed to insert");
+            delta->op_done += consumed;
+            if (delta->op_done == delta->op.size) {
+                delta->op_read = 0;
+            }
+        }
+        cur += consumed;
+        size -= consumed;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_br_delta_end(esp_br_delta_t *delta)
+{
+    esp_err_t ret = ESP_OK;
+    uint8_t sha256[sizeof(delta->header.target_sha256)];
+
+    ESP_GOTO_ON_FALSE(delta->header_read == sizeof(delta->header) && delta->op_read == 0 &&
+                          delta->target_written == delta->header.target_size,
+                      ESP_ERR_INVALID_SIZE, exit, TAG, "Delta is incomplete");
+    mbedtls_sha256_finish(&delta->target_sha256, sha256);
+    ESP_GOTO_ON_FALSE(memcmp(sha256, delta->header.target_sha256, sizeof(sha256)) == 0, ESP_ERR_INVALID_CRC, exit,
+                      TAG, "New firmware does not match the digest of the delta");
+exit:
+    esp_br_delta_abort(delta);
+    return ret;
+}
+
+void esp_br_delta_abort(esp_br_delta_t *delta)
+{
+    mbedtls_sha256_free(&delta->target_sha256);
+    free(delta->copy_buffer);
+    delta->copy_buffer = NULL;
+}
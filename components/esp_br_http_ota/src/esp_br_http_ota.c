@@ -5,17 +5,103 @@
  */
 
 #include "esp_br_http_ota.h"
+#include "cJSON.h"
+#include "esp_br_delta.h"
 #include "esp_check.h"
 #include "esp_log.h"
+#include "esp_openthread.h"
+#include "esp_openthread_lock.h"
 #include "esp_ota_ops.h"
+#include "esp_partition.h"
 #include "esp_rcp_firmware.h"
 #include "esp_rcp_ota.h"
+#include "esp_rcp_progress.h"
+#include "esp_rcp_update.h"
+#include "esp_heap_caps.h"
+#include "esp_idf_version.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "mbedtls/sha256.h"
+#include "nvs.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
 
 #define DEFAULT_REQUEST_SIZE 64 * 1024
 #define TAG "BR_OTA"
-#define DOWNLOAD_BUFFER_SIZE 1024
+#define DOWNLOAD_BUFFER_SIZE CONFIG_BR_HTTP_OTA_READ_SIZE
+#define HTTP_STATUS_PARTIAL_CONTENT 206
+#define CHECKPOINT_NVS_NAMESPACE "br_ota"
+#define CHECKPOINT_NVS_KEY "checkpoint"
+#define COMMIT_NVS_KEY "commit"
+// The RCP can only be released from the Thread stack and attached again at runtime since ESP-IDF v5.1.
+#define RCP_STREAM_FLASH (CONFIG_BR_HTTP_OTA_RCP_STREAM_FLASH && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0))
+#define MANIFEST_MAX_SIZE 2048
+// The fetch tasks run the TLS handshake of their HTTPS connection.
+#define MANIFEST_FETCH_TASK_STACK_SIZE 8192
+
+#if CONFIG_BR_HTTP_OTA_RESUME
+#define RESUME_MAX_RETRY CONFIG_BR_HTTP_OTA_RESUME_MAX_RETRY
+#define RESUME_RETRY_DELAY_MS CONFIG_BR_HTTP_OTA_RESUME_RETRY_DELAY_MS
+#else
+#define RESUME_MAX_RETRY 0
+#define RESUME_RETRY_DELAY_MS 0
+#endif
+
+#if CONFIG_BR_HTTP_OTA_PIPELINE
+#define PIPELINE_SLOT_NUM CONFIG_BR_HTTP_OTA_PIPELINE_SLOT_NUM
+#define PIPELINE_SLOT_SIZE CONFIG_BR_HTTP_OTA_PIPELINE_SLOT_SIZE
+#define PIPELINE_READER_STACK_SIZE 4096
+
+typedef struct {
+    char *data;
+    int len;       /* the bytes read into data, negative if the connection is lost */
+    bool complete; /* whether the response is complete after the data */
+} ota_pipeline_slot_t;
+
+typedef struct {
+    esp_http_client_handle_t http_client;
+    char *buffer;                  /* the data of all the slots */
+    ota_pipeline_slot_t slots[PIPELINE_SLOT_NUM];
+    QueueHandle_t free_slots;      /* the slots to be filled by the reader task */
+    QueueHandle_t filled_slots;    /* the slots to be written, in the order of the data */
+    SemaphoreHandle_t reader_done; /* given when the reader task exits */
+    volatile bool stop;
+} ota_pipeline_t;
+#endif
+
+typedef struct {
+    esp_rcp_ota_handle_t rcp_ota_handle;
+    esp_ota_handle_t host_ota_handle;
+    uint32_t image_offset;                /* the bytes of the image processed */
+    uint32_t stream_offset;               /* the image offset of the next byte from the HTTP connection */
+    bool connection_lost;                 /* whether the last failure is caused by the network */
+    uint32_t br_fw_size;
+    uint32_t br_fw_downloaded;
+    mbedtls_sha256_context br_fw_sha256;
+    uint8_t br_fw_digest[32];
+    bool verify_br_fw;
+    bool br_fw_delta;                     /* whether the Border Router firmware is a delta to the running one */
+    esp_br_delta_t delta;
+    esp_rcp_progress_tracker_t host_progress;
+    esp_rcp_ota_checkpoint_t checkpoint;  /* the latest checkpoint of the RCP OTA */
+    bool checkpoint_valid;
+    bool bench;                           /* whether the image is downloaded by esp_br_http_ota_bench() */
+    int64_t rcp_store_us;                 /* the time spent storing the RCP image */
+    int64_t host_write_us;                /* the time spent writing the Border Router firmware */
+#if RCP_STREAM_FLASH
+    esp_err_t stream_result;
+#endif
+} ota_download_t;
 
 static char s_download_data_buf[DOWNLOAD_BUFFER_SIZE];
+static esp_rcp_progress_cb_t s_progress_callback = NULL;
+static void *s_progress_user_ctx = NULL;
 
 static bool process_again(int status_code)
 {
@@ -129,80 +215,1083 @@ static int http_client_read_check_connection(esp_http_client_handle_t client, ch
     return len;
 }
 
+#if RCP_STREAM_FLASH
+static esp_err_t detach_rcp(void)
+{
+    esp_err_t ret;
+
+    // Hand the UART of the RCP over to the serial loader.
+    esp_openthread_lock_acquire(portMAX_DELAY);
+    ret = esp_openthread_rcp_deinit();
+    esp_openthread_lock_release();
+    return ret;
+}
+
+static void attach_rcp(void)
+{
+    esp_openthread_lock_acquire(portMAX_DELAY);
+    if (esp_openthread_rcp_init() != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to attach the RCP, restart to recover");
+    }
+    esp_openthread_lock_release();
+}
+
+// Flash the RCP image in use from the storage. If a newly submitted image fails, the previous image is used from
+// the next boot. The image restored after a failed download stays in use, since the other slot is partially written.
+static void flash_stored_rcp_image(bool submitted)
+{
+    ESP_LOGW(TAG, "Flashing the RCP from the stored image");
+    esp_err_t err = esp_rcp_update();
+    if (err == ESP_OK || submitted) {
+        esp_rcp_mark_image_verified(err == ESP_OK);
+    } else {
+        ESP_LOGE(TAG, "Failed to restore the RCP, restart to recover");
+    }
+}
+#endif
+
+static esp_err_t begin_host_ota(ota_download_t *download)
+{
+    esp_rcp_ota_handle_t rcp_ota_handle = download->rcp_ota_handle;
+
+#if RCP_STREAM_FLASH
+    download->stream_result = esp_rcp_ota_get_stream_flash_result(rcp_ota_handle);
+#endif
+    esp_rcp_filetag_t br_fw_tag = FILETAG_HOST_FIRMWARE;
+    download->br_fw_size = esp_rcp_ota_get_subfile_size(rcp_ota_handle, FILETAG_HOST_FIRMWARE);
+    if (download->br_fw_size == 0) {
+        br_fw_tag = FILETAG_HOST_FIRMWARE_DELTA;
+        download->br_fw_size = esp_rcp_ota_get_subfile_size(rcp_ota_handle, FILETAG_HOST_FIRMWARE_DELTA);
+    }
+    // Only images of version 2 carry the digest of the Border Router firmware.
+    download->verify_br_fw =
+        esp_rcp_ota_get_subfile_sha256(rcp_ota_handle, br_fw_tag, download->br_fw_digest) == ESP_OK;
+    if (download->br_fw_size == 0) {
+        return ESP_OK;
+    }
+    const esp_partition_t *update_partition = esp_ota_get_next_update_partition(NULL);
+    ESP_RETURN_ON_FALSE(update_partition != NULL, ESP_ERR_NOT_FOUND, TAG, "Failed to find ota partition");
+    ESP_RETURN_ON_ERROR(esp_ota_begin(update_partition, OTA_WITH_SEQUENTIAL_WRITES, &download->host_ota_handle), TAG,
+                        "Failed to begin host OTA");
+    if (br_fw_tag == FILETAG_HOST_FIRMWARE_DELTA) {
+        download->br_fw_delta = true;
+        ESP_RETURN_ON_ERROR(esp_br_delta_begin(&download->delta, download->host_ota_handle), TAG,
+                            "Failed to begin the Border Router firmware delta");
+    }
+    esp_rcp_progress_begin(&download->host_progress, ESP_RCP_PROGRESS_PHASE_HOST_DOWNLOAD, download->br_fw_size,
+                           s_progress_callback, s_progress_user_ctx);
+    mbedtls_sha256_starts(&download->br_fw_sha256, 0);
+    return ESP_OK;
+}
+
+static bool is_download_done(ota_download_t *download)
+{
+    return esp_rcp_ota_get_state(download->rcp_ota_handle) == ESP_RCP_OTA_STATE_FINISHED &&
+        download->br_fw_downloaded >= download->br_fw_size;
+}
+
+#if CONFIG_BR_HTTP_OTA_RESUME
+static esp_err_t load_checkpoint(esp_rcp_ota_checkpoint_t *checkpoint)
+{
+    esp_err_t ret = ESP_OK;
+    nvs_handle_t nvs_handle = 0;
+    size_t size = sizeof(*checkpoint);
+
+    // The namespace and the key are missing while no download is interrupted, which is not an error.
+    ret = nvs_open(CHECKPOINT_NVS_NAMESPACE, NVS_READONLY, &nvs_handle);
+    if (ret != ESP_OK) {
+        if (ret != ESP_ERR_NVS_NOT_FOUND) {
+            ESP_LOGE(TAG, "Failed to open the OTA checkpoint: %s", esp_err_to_name(ret));
+        }
+        return ret;
+    }
+    ret = nvs_get_blob(nvs_handle, CHECKPOINT_NVS_KEY, checkpoint, &size);
+    if (ret == ESP_OK && size != sizeof(*checkpoint)) {
+        ret = ESP_ERR_INVALID_SIZE;
+    }
+    nvs_close(nvs_handle);
+    return ret;
+}
+
+static void save_checkpoint(const esp_rcp_ota_checkpoint_t *checkpoint)
+{
+    nvs_handle_t nvs_handle = 0;
+
+    if (nvs_open(CHECKPOINT_NVS_NAMESPACE, NVS_READWRITE, &nvs_handle) != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to open NVS, the OTA checkpoint is not saved");
+        return;
+    }
+    if (checkpoint) {
+        nvs_set_blob(nvs_handle, CHECKPOINT_NVS_KEY, checkpoint, sizeof(*checkpoint));
+    } else {
+        nvs_erase_key(nvs_handle, CHECKPOINT_NVS_KEY);
+    }
+    if (nvs_commit(nvs_handle) != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to commit the OTA checkpoint");
+    }
+    nvs_close(nvs_handle);
+}
+#else
+static esp_err_t load_checkpoint(esp_rcp_ota_checkpoint_t *checkpoint)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+static void save_checkpoint(const esp_rcp_ota_checkpoint_t *checkpoint)
+{
+}
+#endif
+
+// Save the checkpoint of the RCP OTA whenever it advances, a stored subfile is then complete and synced.
+static void update_checkpoint(ota_download_t *download)
+{
+    esp_rcp_ota_checkpoint_t checkpoint;
+
+    // A benchmark download is never resumed.
+    if (download->bench || esp_rcp_ota_get_checkpoint(download->rcp_ota_handle, &checkpoint) != ESP_OK ||
+        (download->checkpoint_valid && checkpoint.offset == download->checkpoint.offset)) {
+        return;
+    }
+    download->checkpoint = checkpoint;
+    download->checkpoint_valid = true;
+    save_checkpoint(&checkpoint);
+}
+
+// Process the data at @p offset of the image, the data already processed is skipped.
+static esp_err_t process_data(ota_download_t *download, uint32_t offset, const char *data, size_t len)
+{
+    ESP_RETURN_ON_FALSE(offset <= download->image_offset, ESP_ERR_INVALID_STATE, TAG, "Missing data at %" PRIu32,
+                        download->image_offset);
+    if (offset + len <= download->image_offset) {
+        return ESP_OK;
+    }
+    if (offset < download->image_offset) {
+        data += download->image_offset - offset;
+        len -= download->image_offset - offset;
+    }
+    while (len > 0 && !is_download_done(download)) {
+        size_t consumed = 0;
+        int64_t start_us = esp_timer_get_time();
+        if (esp_rcp_ota_get_state(download->rcp_ota_handle) != ESP_RCP_OTA_STATE_FINISHED) {
+            ESP_RETURN_ON_ERROR(esp_rcp_ota_receive(download->rcp_ota_handle, data, len, &consumed), TAG,
+                                "Failed to receive host RCP OTA data");
+            download->rcp_store_us += esp_timer_get_time() - start_us;
+            update_checkpoint(download);
+            if (esp_rcp_ota_get_state(download->rcp_ota_handle) == ESP_RCP_OTA_STATE_FINISHED) {
+                ESP_RETURN_ON_ERROR(begin_host_ota(download), TAG, "Failed to begin host OTA");
+            }
+        } else {
+            consumed = len < download->br_fw_size - download->br_fw_downloaded
+                ? len
+                : download->br_fw_size - download->br_fw_downloaded;
+            if (download->br_fw_delta) {
+                ESP_RETURN_ON_ERROR(esp_br_delta_write(&download->delta, data, consumed), TAG,
+                                    "Failed to apply the Border Router firmware delta");
+            } else {
+                ESP_RETURN_ON_ERROR(esp_ota_write(download->host_ota_handle, data, consumed), TAG,
+                                    "Failed to write ota");
+            }
+            download->host_write_us += esp_timer_get_time() - start_us;
+            mbedtls_sha256_update(&download->br_fw_sha256, (const uint8_t *)data, consumed);
+            download->br_fw_downloaded += consumed;
+            esp_rcp_progress_update(&download->host_progress, download->br_fw_downloaded);
+        }
+        data += consumed;
+        len -= consumed;
+        download->image_offset += consumed;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t connect_range(ota_download_t *download, esp_http_client_handle_t http_client, uint32_t from,
+                               uint32_t to)
+{
+    char range[sizeof("bytes=4294967295-4294967295")];
+    esp_err_t ret = ESP_OK;
+
+    if (to) {
+        snprintf(range, sizeof(range), "bytes=%" PRIu32 "-%" PRIu32, from, to - 1);
+    } else {
+        snprintf(range, sizeof(range), "bytes=%" PRIu32 "-", from);
+    }
+    esp_http_client_set_header(http_client, "Range", range);
+    ret = _http_connect(http_client);
+    if (ret != ESP_OK) {
+        // The server refusing the request is not worth a retry.
+        int status_code = esp_http_client_get_status_code(http_client);
+        download->connection_lost = status_code < HttpStatus_BadRequest || status_code >= HttpStatus_InternalError;
+        ESP_LOGE(TAG, "Failed to connect to HTTP server");
+        return ret;
+    }
+    // A server ignoring the range sends the whole image.
+    download->stream_offset = esp_http_client_get_status_code(http_client) == HTTP_STATUS_PARTIAL_CONTENT ? from : 0;
+    return ESP_OK;
+}
+
+// Check that the image on the server is the one of the checkpoint by the digest of its header and image format.
+static esp_err_t verify_image_prefix(ota_download_t *download, esp_http_client_handle_t http_client)
+{
+    esp_err_t ret = ESP_OK;
+    uint32_t prefix_size = download->checkpoint.prefix_size;
+    uint32_t received = 0;
+    uint8_t image_id[sizeof(download->checkpoint.image_id)];
+    mbedtls_sha256_context sha256;
+
+    ESP_RETURN_ON_ERROR(connect_range(download, http_client, 0, prefix_size), TAG, "Failed to request image prefix");
+    mbedtls_sha256_init(&sha256);
+    mbedtls_sha256_starts(&sha256, 0);
+    while (received < prefix_size) {
+        size_t read_size = prefix_size - received < sizeof(s_download_data_buf) ? prefix_size - received
+                                                                                : sizeof(s_download_data_buf);
+        int len = http_client_read_check_connection(http_client, s_download_data_buf, read_size);
+        download->connection_lost = len <= 0;
+        ESP_GOTO_ON_FALSE(len > 0, ESP_FAIL, exit, TAG, "Failed to download image prefix");
+        mbedtls_sha256_update(&sha256, (const uint8_t *)s_download_data_buf, len);
+        received += len;
+    }
+    mbedtls_sha256_finish(&sha256, image_id);
+    ESP_GOTO_ON_FALSE(memcmp(image_id, download->checkpoint.image_id, sizeof(image_id)) == 0, ESP_ERR_INVALID_CRC,
+                      exit, TAG, "Image on the server does not match the checkpoint");
+exit:
+    mbedtls_sha256_free(&sha256);
+    esp_http_client_close(http_client);
+    return ret;
+}
+
+static esp_err_t connect_image(ota_download_t *download, esp_http_client_handle_t http_client)
+{
+    download->connection_lost = false;
+    if (download->image_offset == 0) {
+        esp_http_client_delete_header(http_client, "Range");
+        download->stream_offset = 0;
+        ESP_RETURN_ON_ERROR(_http_connect(http_client), TAG, "Failed to connect to HTTP server");
+        return ESP_OK;
+    }
+    ESP_RETURN_ON_ERROR(verify_image_prefix(download, http_client), TAG, "Failed to verify the image");
+    ESP_LOGI(TAG, "Resuming the download at %" PRIu32, download->image_offset);
+    return connect_range(download, http_client, download->image_offset, 0);
+}
+
+#if CONFIG_BR_HTTP_OTA_PIPELINE
+static void *alloc_pipeline_buffer(size_t size)
+{
+    void *buffer = NULL;
+
+#if CONFIG_BR_HTTP_OTA_PIPELINE_PSRAM
+    buffer = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (buffer == NULL) {
+        ESP_LOGW(TAG, "Failed to allocate the OTA ring buffer in PSRAM");
+    }
+#endif
+    if (buffer == NULL) {
+        buffer = heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    return buffer;
+}
+
+static void delete_pipeline(ota_pipeline_t *pipeline)
+{
+    if (pipeline->free_slots) {
+        vQueueDelete(pipeline->free_slots);
+    }
+    if (pipeline->filled_slots) {
+        vQueueDelete(pipeline->filled_slots);
+    }
+    if (pipeline->reader_done) {
+        vSemaphoreDelete(pipeline->reader_done);
+    }
+    heap_caps_free(pipeline->buffer);
+    free(pipeline);
+}
+
+static esp_err_t create_pipeline(esp_http_client_handle_t http_client, ota_pipeline_t **out_pipeline)
+{
+    esp_err_t ret = ESP_OK;
+    ota_pipeline_t *pipeline = calloc(1, sizeof(ota_pipeline_t));
+
+    ESP_RETURN_ON_FALSE(pipeline, ESP_ERR_NO_MEM, TAG, "Failed to allocate the OTA pipeline");
+    pipeline->http_client = http_client;
+    pipeline->buffer = alloc_pipeline_buffer(PIPELINE_SLOT_NUM * PIPELINE_SLOT_SIZE);
+    pipeline->free_slots = xQueueCreate(PIPELINE_SLOT_NUM, sizeof(ota_pipeline_slot_t *));
+    pipeline->filled_slots = xQueueCreate(PIPELINE_SLOT_NUM, sizeof(ota_pipeline_slot_t *));
+    pipeline->reader_done = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(pipeline->buffer && pipeline->free_slots && pipeline->filled_slots && pipeline->reader_done,
+                      ESP_ERR_NO_MEM, exit, TAG, "Failed to allocate the OTA ring buffer");
+    for (int i = 0; i < PIPELINE_SLOT_NUM; i++) {
+        ota_pipeline_slot_t *slot = &pipeline->slots[i];
+        slot->data = pipeline->buffer + i * PIPELINE_SLOT_SIZE;
+        xQueueSend(pipeline->free_slots, &slot, 0);
+    }
+    *out_pipeline = pipeline;
+exit:
+    if (ret != ESP_OK) {
+        delete_pipeline(pipeline);
+    }
+    return ret;
+}
+
+// Fill the free slots with the data from the HTTP connection until the response is complete or the read fails.
+static void pipeline_reader_task(void *ctx)
+{
+    ota_pipeline_t *pipeline = ctx;
+    ota_pipeline_slot_t *slot = NULL;
+
+    while (!pipeline->stop && xQueueReceive(pipeline->free_slots, &slot, portMAX_DELAY) == pdTRUE) {
+        if (pipeline->stop) {
+            break;
+        }
+        slot->len = http_client_read_check_connection(pipeline->http_client, slot->data, PIPELINE_SLOT_SIZE);
+        slot->complete = esp_http_client_is_complete_data_received(pipeline->http_client);
+        xQueueSend(pipeline->filled_slots, &slot, portMAX_DELAY);
+        if (slot->len < 0 || slot->complete) {
+            break;
+        }
+    }
+    xSemaphoreGive(pipeline->reader_done);
+    vTaskDelete(NULL);
+}
+
+// Stop the reader, the slots it waits for are given back until it exits.
+static void stop_pipeline_reader(ota_pipeline_t *pipeline)
+{
+    ota_pipeline_slot_t *slot = NULL;
+
+    pipeline->stop = true;
+    while (xSemaphoreTake(pipeline->reader_done, 0) != pdTRUE) {
+        if (xQueueReceive(pipeline->filled_slots, &slot, pdMS_TO_TICKS(10)) == pdTRUE) {
+            xQueueSend(pipeline->free_slots, &slot, 0);
+        }
+    }
+}
+
+// The HTTP connection is read by a reader task into the ring of slots, while the caller writes the filled slots to
+// the RCP image and the OTA partition, so the network receive overlaps with flash programming.
+static esp_err_t receive_image(ota_download_t *download, esp_http_client_handle_t http_client)
+{
+    esp_err_t ret = ESP_OK;
+    ota_pipeline_t *pipeline = NULL;
+    ota_pipeline_slot_t *slot = NULL;
+    bool complete = false;
+
+    ESP_RETURN_ON_ERROR(create_pipeline(http_client, &pipeline), TAG, "Failed to create the OTA pipeline");
+    if (xTaskCreate(pipeline_reader_task, "ota_reader", PIPELINE_READER_STACK_SIZE, pipeline,
+                    uxTaskPriorityGet(NULL), NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create the OTA reader task");
+        delete_pipeline(pipeline);
+        return ESP_ERR_NO_MEM;
+    }
+    while (!is_download_done(download)) {
+        ESP_GOTO_ON_FALSE(!complete, ESP_ERR_INVALID_SIZE, exit, TAG, "Image is truncated");
+        xQueueReceive(pipeline->filled_slots, &slot, portMAX_DELAY);
+        download->connection_lost = slot->len < 0;
+        complete = slot->complete;
+        if (slot->len >= 0) {
+            ret = process_data(download, download->stream_offset, slot->data, slot->len);
+            download->stream_offset += slot->len;
+        }
+        xQueueSend(pipeline->free_slots, &slot, 0);
+        ESP_GOTO_ON_FALSE(!download->connection_lost, ESP_FAIL, exit, TAG, "Failed to download");
+        ESP_GOTO_ON_ERROR(ret, exit, TAG, "Failed to process data");
+    }
+exit:
+    stop_pipeline_reader(pipeline);
+    delete_pipeline(pipeline);
+    return ret;
+}
+#else
+static esp_err_t receive_image(ota_download_t *download, esp_http_client_handle_t http_client)
+{
+    bool complete = false;
+
+    while (!is_download_done(download)) {
+        ESP_RETURN_ON_FALSE(!complete, ESP_ERR_INVALID_SIZE, TAG, "Image is truncated");
+        int len = http_client_read_check_connection(http_client, s_download_data_buf, sizeof(s_download_data_buf));
+        download->connection_lost = len < 0;
+        ESP_RETURN_ON_FALSE(len >= 0, ESP_FAIL, TAG, "Failed to download");
+        complete = esp_http_client_is_complete_data_received(http_client);
+        ESP_RETURN_ON_ERROR(process_data(download, download->stream_offset, s_download_data_buf, len), TAG,
+                            "Failed to process data");
+        download->stream_offset += len;
+    }
+    return ESP_OK;
+}
+#endif
+
+// Resume the RCP OTA from the checkpoint saved before the device restarted.
+static esp_err_t resume_download(ota_download_t *download, const esp_rcp_ota_checkpoint_t *checkpoint)
+{
+    ESP_RETURN_ON_ERROR(esp_rcp_ota_resume(download->rcp_ota_handle, checkpoint, &download->image_offset), TAG,
+                        "Failed to resume RCP OTA");
+    download->checkpoint = *checkpoint;
+    download->checkpoint_valid = true;
+    if (esp_rcp_ota_get_state(download->rcp_ota_handle) == ESP_RCP_OTA_STATE_FINISHED) {
+        ESP_RETURN_ON_ERROR(begin_host_ota(download), TAG, "Failed to begin host OTA");
+    }
+    return ESP_OK;
+}
+
+static void abort_download(ota_download_t *download)
+{
+    if (download->br_fw_delta) {
+        esp_br_delta_abort(&download->delta);
+    }
+    if (download->host_ota_handle) {
+        esp_ota_abort(download->host_ota_handle);
+    }
+    if (download->rcp_ota_handle) {
+        esp_rcp_ota_abort(download->rcp_ota_handle);
+    }
+    esp_rcp_progress_end(&download->host_progress, false);
+    mbedtls_sha256_free(&download->br_fw_sha256);
+}
+
+static esp_err_t begin_download(ota_download_t *download)
+{
+    memset(download, 0, sizeof(*download));
+#if RCP_STREAM_FLASH
+    download->stream_result = ESP_ERR_INVALID_STATE;
+#endif
+    mbedtls_sha256_init(&download->br_fw_sha256);
+    return esp_rcp_ota_begin(&download->rcp_ota_handle);
+}
+
 static esp_err_t download_ota_image(esp_http_client_config_t *config)
 {
     esp_err_t ret = ESP_OK;
-    bool download_done = false;
-    esp_rcp_ota_handle_t rcp_ota_handle = 0;
-    esp_ota_handle_t host_ota_handle = 0;
-    uint32_t br_fw_downloaded = 0;
-    uint32_t br_fw_size = 0;
-    char *br_fist_write_ptr = NULL;
-    size_t br_first_write_size = 0;
+    ota_download_t download;
+    esp_rcp_ota_checkpoint_t checkpoint;
+    bool resumed = false;
+#if RCP_STREAM_FLASH
+    bool rcp_detached = false;
+#endif
     ESP_LOGI(TAG, "Downloading from %s\n", config->url);
     esp_http_client_handle_t http_client = esp_http_client_init(config);
     ESP_RETURN_ON_FALSE(http_client != NULL, ESP_FAIL, TAG, "Failed to create HTTP client");
-    ESP_GOTO_ON_ERROR(esp_rcp_ota_begin(&rcp_ota_handle), exit, TAG, "Failed to begin RCP OTA");
-    ESP_GOTO_ON_ERROR(_http_connect(http_client), exit, TAG, "Failed to connect to HTTP server");
+    ESP_GOTO_ON_ERROR(begin_download(&download), exit, TAG, "Failed to begin RCP OTA");
+    if (load_checkpoint(&checkpoint) == ESP_OK) {
+        resumed = resume_download(&download, &checkpoint) == ESP_OK;
+        if (!resumed) {
+            ESP_LOGW(TAG, "Discarding the OTA checkpoint");
+            abort_download(&download);
+            ESP_GOTO_ON_ERROR(begin_download(&download), exit, TAG, "Failed to begin RCP OTA");
+        }
+    }
+    if (!resumed) {
+        save_checkpoint(NULL);
+    }
 
-    while (!download_done) {
-        int len = http_client_read_check_connection(http_client, s_download_data_buf, sizeof(s_download_data_buf));
-        size_t rcp_ota_received_len = 0;
-        ESP_GOTO_ON_FALSE(len >= 0, ESP_FAIL, exit, TAG, "Failed to download");
-        download_done = esp_http_client_is_complete_data_received(http_client);
-        ESP_GOTO_ON_ERROR(esp_rcp_ota_receive(rcp_ota_handle, s_download_data_buf, len, &rcp_ota_received_len), exit,
-                          TAG, "Failed to receive host RCP OTA data");
-        if (esp_rcp_ota_get_state(rcp_ota_handle) == ESP_RCP_OTA_STATE_FINISHED) {
-            br_fw_size = esp_rcp_ota_get_subfile_size(rcp_ota_handle, FILETAG_HOST_FIRMWARE);
-            br_fist_write_ptr = &s_download_data_buf[rcp_ota_received_len];
-            br_first_write_size = len - rcp_ota_received_len;
+    for (int retry = 0;; retry++) {
+        ret = connect_image(&download, http_client);
+        if (ret == ESP_ERR_INVALID_CRC && resumed) {
+            // The image on the server has changed since the checkpoint was saved, start over.
+            ESP_LOGW(TAG, "Discarding the OTA checkpoint of another image");
+            abort_download(&download);
+            save_checkpoint(NULL);
+            resumed = false;
+            ESP_GOTO_ON_ERROR(begin_download(&download), exit, TAG, "Failed to begin RCP OTA");
+            ret = connect_image(&download, http_client);
+        }
+#if RCP_STREAM_FLASH
+        if (ret == ESP_OK && !resumed && !rcp_detached) {
+            ESP_GOTO_ON_ERROR(detach_rcp(), exit, TAG, "Failed to detach the RCP");
+            rcp_detached = true;
+            ESP_GOTO_ON_ERROR(esp_rcp_ota_enable_stream_flash(download.rcp_ota_handle), exit, TAG,
+                              "Failed to enable RCP flashing");
+        }
+#endif
+        if (ret == ESP_OK) {
+            ret = receive_image(&download, http_client);
+        }
+        if (ret == ESP_OK || !download.connection_lost || !download.checkpoint_valid || retry >= RESUME_MAX_RETRY) {
             break;
         }
+        esp_http_client_close(http_client);
+        ESP_LOGW(TAG, "Connection lost at %" PRIu32 ", retrying in %d ms (%d/%d)", download.image_offset,
+                 RESUME_RETRY_DELAY_MS, retry + 1, RESUME_MAX_RETRY);
+        vTaskDelay(pdMS_TO_TICKS(RESUME_RETRY_DELAY_MS));
     }
-    if (br_fw_size > 0) {
-        const esp_partition_t *update_partition = esp_ota_get_next_update_partition(NULL);
-        ESP_GOTO_ON_FALSE(update_partition != NULL, ESP_ERR_NOT_FOUND, exit, TAG, "Failed to find ota partition");
-        ESP_GOTO_ON_ERROR(esp_ota_begin(update_partition, OTA_WITH_SEQUENTIAL_WRITES, &host_ota_handle), exit, TAG,
-                          "Failed to begin host OTA");
-        if (br_fist_write_ptr && br_first_write_size > 0) {
-            ESP_GOTO_ON_ERROR(esp_ota_write(host_ota_handle, br_fist_write_ptr, br_first_write_size), exit, TAG,
-                              "Failed to write ota");
-            br_fw_downloaded += br_first_write_size;
-            ESP_LOGD(TAG, "Border Router firmware download %lu/%lu bytes", br_fw_downloaded, br_fw_size);
-        }
-        while (!download_done && br_fw_downloaded < br_fw_size) {
-            int len = http_client_read_check_connection(http_client, s_download_data_buf, sizeof(s_download_data_buf));
-            download_done = esp_http_client_is_complete_data_received(http_client);
-            ESP_GOTO_ON_FALSE(len >= 0, ESP_FAIL, exit, TAG, "Failed to download");
-            br_fw_downloaded += len;
-            ESP_GOTO_ON_ERROR(esp_ota_write(host_ota_handle, s_download_data_buf, len), exit, TAG,
-                              "Failed to write ota");
-            ESP_LOGD(TAG, "Border Router firmware download %lu/%lu bytes", br_fw_downloaded, br_fw_size);
-        }
-        ret = esp_ota_end(host_ota_handle);
-        host_ota_handle = 0;
+    ESP_GOTO_ON_ERROR(ret, exit, TAG, "Failed to download the OTA image");
+
+    if (download.br_fw_size > 0) {
+        if (download.verify_br_fw) {
+            uint8_t digest[sizeof(download.br_fw_digest)];
+            mbedtls_sha256_finish(&download.br_fw_sha256, digest);
+            ESP_GOTO_ON_FALSE(memcmp(digest, download.br_fw_digest, sizeof(digest)) == 0, ESP_ERR_INVALID_CRC, exit,
+                              TAG, "Border Router firmware does not match its SHA-256 digest");
+        }
+        if (download.br_fw_delta) {
+            download.br_fw_delta = false;
+            ESP_GOTO_ON_ERROR(esp_br_delta_end(&download.delta), exit, TAG,
+                              "Failed to apply the Border Router firmware delta");
+        }
+        ret = esp_ota_end(download.host_ota_handle);
+        download.host_ota_handle = 0;
         ESP_GOTO_ON_ERROR(ret, exit, TAG, "Failed to end host OTA");
         ESP_GOTO_ON_ERROR(esp_ota_set_boot_partition(esp_ota_get_next_update_partition(NULL)), exit, TAG,
                           "Failed to set boot partition");
+        esp_rcp_progress_end(&download.host_progress, true);
     }
-    ret = esp_rcp_ota_end(rcp_ota_handle);
+    ret = esp_rcp_ota_end(download.rcp_ota_handle);
     if (ret != ESP_OK) {
         // rollback the host boot partition when failing to end RCP OTA
         esp_ota_set_boot_partition(esp_ota_get_next_update_partition(NULL));
     }
-    rcp_ota_handle = 0;
+    download.rcp_ota_handle = 0;
+#if RCP_STREAM_FLASH
+    if (ret == ESP_OK && rcp_detached && download.stream_result != ESP_OK) {
+        // The new image is stored and submitted, fall back to flashing it.
+        flash_stored_rcp_image(true);
+    }
+#endif
 exit:
     _http_cleanup(http_client);
-    if (ret != ESP_OK && host_ota_handle) {
-        esp_ota_abort(host_ota_handle);
+    if (ret == ESP_OK || !download.connection_lost) {
+        // Keep the checkpoint only for a download interrupted by the network.
+        save_checkpoint(NULL);
+    }
+    if (ret != ESP_OK) {
+        abort_download(&download);
+    } else {
+        mbedtls_sha256_free(&download.br_fw_sha256);
+        esp_rcp_progress_end(&download.host_progress, false);
+    }
+#if RCP_STREAM_FLASH
+    if (ret != ESP_OK && rcp_detached) {
+        // The RCP may be partially flashed, restore the image in use and give the RCP back to the Thread stack.
+        flash_stored_rcp_image(false);
+        attach_rcp();
     }
-    if (ret != ESP_OK && rcp_ota_handle) {
-        esp_rcp_ota_abort(rcp_ota_handle);
+#endif
+    return ret;
+}
+
+/*-----------------------------------------------------
+ Manifest update: the RCP image and the Border Router firmware are fetched from their own URLs.
+-----------------------------------------------------*/
+typedef enum {
+    MANIFEST_COMPONENT_RCP = 0,
+    MANIFEST_COMPONENT_HOST,
+    MANIFEST_COMPONENT_NUM,
+} manifest_component_t;
+
+typedef struct manifest_fetch manifest_fetch_t;
+
+typedef struct manifest_fetch {
+    const char *name;
+    char *url;
+    uint32_t size;
+    uint8_t sha256[32];        /* the image ID of the RCP image, the digest of the Border Router firmware */
+    bool needed;               /* whether it is listed and differs from the installed one */
+    esp_err_t (*write)(manifest_fetch_t *fetch, const char *data, size_t len);
+    esp_err_t (*finish)(manifest_fetch_t *fetch);
+    esp_http_client_config_t http_config;
+    esp_rcp_ota_handle_t rcp_ota_handle;
+    esp_ota_handle_t host_ota_handle;
+    const esp_partition_t *host_partition;
+    mbedtls_sha256_context host_sha256;
+    esp_rcp_progress_tracker_t host_progress;
+    uint32_t received;
+    SemaphoreHandle_t done;
+    esp_err_t result;
+} manifest_fetch_t;
+
+// The changes to apply on the next boot if the device restarts while committing a manifest update.
+typedef struct {
+    int8_t rcp_seq;        /* the RCP image slot to submit, -1 if the RCP image is not updated */
+    uint32_t host_address; /* the address of the OTA partition to boot, 0 if the firmware is not updated */
+} manifest_commit_t;
+
+static esp_err_t load_commit(manifest_commit_t *commit)
+{
+    esp_err_t ret = ESP_OK;
+    nvs_handle_t nvs_handle = 0;
+    size_t size = sizeof(*commit);
+
+    // The namespace and the key are missing while no commit is interrupted, which is not an error.
+    ret = nvs_open(CHECKPOINT_NVS_NAMESPACE, NVS_READONLY, &nvs_handle);
+    if (ret != ESP_OK) {
+        if (ret != ESP_ERR_NVS_NOT_FOUND) {
+            ESP_LOGE(TAG, "Failed to open the OTA commit: %s", esp_err_to_name(ret));
+        }
+        return ret;
+    }
+    ret = nvs_get_blob(nvs_handle, COMMIT_NVS_KEY, commit, &size);
+    if (ret == ESP_OK && size != sizeof(*commit)) {
+        ret = ESP_ERR_INVALID_SIZE;
+    }
+    nvs_close(nvs_handle);
+    return ret;
+}
+
+static esp_err_t save_commit(const manifest_commit_t *commit)
+{
+    esp_err_t ret = ESP_OK;
+    nvs_handle_t nvs_handle = 0;
+
+    ESP_RETURN_ON_ERROR(nvs_open(CHECKPOINT_NVS_NAMESPACE, NVS_READWRITE, &nvs_handle), TAG, "Failed to open NVS");
+    if (commit) {
+        ret = nvs_set_blob(nvs_handle, COMMIT_NVS_KEY, commit, sizeof(*commit));
+    } else {
+        ret = nvs_erase_key(nvs_handle, COMMIT_NVS_KEY);
+        ret = ret == ESP_ERR_NVS_NOT_FOUND ? ESP_OK : ret;
+    }
+    if (ret == ESP_OK) {
+        ret = nvs_commit(nvs_handle);
+    }
+    nvs_close(nvs_handle);
+    return ret;
+}
+
+static esp_err_t parse_sha256(const char *hex, uint8_t *sha256)
+{
+    ESP_RETURN_ON_FALSE(strlen(hex) == 64, ESP_ERR_INVALID_ARG, TAG, "Invalid SHA-256 digest %s", hex);
+    for (int i = 0; i < 32; i++) {
+        unsigned int byte;
+        ESP_RETURN_ON_FALSE(sscanf(hex + 2 * i, "%2x", &byte) == 1, ESP_ERR_INVALID_ARG, TAG,
+                            "Invalid SHA-256 digest %s", hex);
+        sha256[i] = byte;
+    }
+    return ESP_OK;
+}
+
+// A URL without a scheme is relative to the directory of the manifest.
+static char *resolve_url(const char *manifest_url, const char *url)
+{
+    char *resolved = NULL;
+
+    if (strstr(url, "://")) {
+        return strdup(url);
+    }
+    const char *dir_end = strrchr(manifest_url, '/');
+    size_t dir_len = dir_end ? dir_end - manifest_url + 1 : 0;
+    resolved = malloc(dir_len + strlen(url) + 1);
+    if (resolved) {
+        memcpy(resolved, manifest_url, dir_len);
+        strcpy(resolved + dir_len, url);
+    }
+    return resolved;
+}
+
+static esp_err_t parse_manifest_entry(const cJSON *root, const char *manifest_url, manifest_fetch_t *fetch)
+{
+    const cJSON *entry = cJSON_GetObjectItemCaseSensitive(root, fetch->name);
+
+    if (entry == NULL) {
+        return ESP_OK;
+    }
+    const cJSON *url = cJSON_GetObjectItemCaseSensitive(entry, "url");
+    const cJSON *size = cJSON_GetObjectItemCaseSensitive(entry, "size");
+    const cJSON *sha256 = cJSON_GetObjectItemCaseSensitive(entry, "sha256");
+    ESP_RETURN_ON_FALSE(cJSON_IsString(url) && cJSON_IsNumber(size) && size->valuedouble > 0 &&
+                            size->valuedouble <= UINT32_MAX && cJSON_IsString(sha256),
+                        ESP_ERR_INVALID_ARG, TAG, "Invalid %s entry in the manifest", fetch->name);
+    ESP_RETURN_ON_ERROR(parse_sha256(sha256->valuestring, fetch->sha256), TAG, "Invalid %s digest", fetch->name);
+    fetch->size = (uint32_t)size->valuedouble;
+    fetch->url = resolve_url(manifest_url, url->valuestring);
+    ESP_RETURN_ON_FALSE(fetch->url, ESP_ERR_NO_MEM, TAG, "Failed to allocate the %s URL", fetch->name);
+    fetch->needed = true;
+    return ESP_OK;
+}
+
+static esp_err_t download_manifest(esp_http_client_config_t *config, cJSON **out_root)
+{
+    esp_err_t ret = ESP_OK;
+    int len = 0;
+    char *data = malloc(MANIFEST_MAX_SIZE + 1);
+    esp_http_client_handle_t http_client = NULL;
+
+    ESP_RETURN_ON_FALSE(data, ESP_ERR_NO_MEM, TAG, "Failed to allocate the manifest buffer");
+    http_client = esp_http_client_init(config);
+    ESP_GOTO_ON_FALSE(http_client, ESP_FAIL, exit, TAG, "Failed to create HTTP client");
+    ESP_GOTO_ON_ERROR(_http_connect(http_client), exit, TAG, "Failed to connect to HTTP server");
+    while (len < MANIFEST_MAX_SIZE && !esp_http_client_is_complete_data_received(http_client)) {
+        int read_len = http_client_read_check_connection(http_client, data + len, MANIFEST_MAX_SIZE - len);
+        ESP_GOTO_ON_FALSE(read_len >= 0, ESP_FAIL, exit, TAG, "Failed to download the manifest");
+        if (read_len == 0) {
+            break;
+        }
+        len += read_len;
     }
+    ESP_GOTO_ON_FALSE(esp_http_client_is_complete_data_received(http_client), ESP_ERR_INVALID_SIZE, exit, TAG,
+                      "The manifest exceeds %d bytes", MANIFEST_MAX_SIZE);
+    data[len] = '\0';
+    *out_root = cJSON_Parse(data);
+    ESP_GOTO_ON_FALSE(*out_root, ESP_ERR_INVALID_ARG, exit, TAG, "Failed to parse the manifest");
+exit:
+    if (http_client) {
+        _http_cleanup(http_client);
+    }
+    free(data);
     return ret;
 }
 
+// Compare the RCP image in the current slot with the manifest by its image ID.
+static bool is_rcp_image_installed(const manifest_fetch_t *fetch)
+{
+    uint8_t image_id[sizeof(fetch->sha256)];
+
+    return esp_rcp_load_image_id_in_storage(image_id) == ESP_OK &&
+        memcmp(image_id, fetch->sha256, sizeof(image_id)) == 0;
+}
+
+// Compare the running firmware with the manifest by the digest of its first bytes, the size of the new firmware.
+static bool is_host_firmware_installed(const manifest_fetch_t *fetch)
+{
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    uint8_t sha256[sizeof(fetch->sha256)];
+    mbedtls_sha256_context ctx;
+    bool installed = false;
+    uint8_t *buffer = NULL;
+
+    if (running == NULL || fetch->size > running->size) {
+        return false;
+    }
+    buffer = malloc(DOWNLOAD_BUFFER_SIZE);
+    if (buffer == NULL) {
+        return false;
+    }
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_starts(&ctx, 0);
+    for (uint32_t done = 0; done < fetch->size;) {
+        size_t read_size = fetch->size - done < DOWNLOAD_BUFFER_SIZE ? fetch->size - done : DOWNLOAD_BUFFER_SIZE;
+        if (esp_partition_read(running, done, buffer, read_size) != ESP_OK) {
+            goto exit;
+        }
+        mbedtls_sha256_update(&ctx, buffer, read_size);
+        done += read_size;
+    }
+    mbedtls_sha256_finish(&ctx, sha256);
+    installed = memcmp(sha256, fetch->sha256, sizeof(sha256)) == 0;
+exit:
+    mbedtls_sha256_free(&ctx);
+    free(buffer);
+    return installed;
+}
+
+static esp_err_t write_rcp_image(manifest_fetch_t *fetch, const char *data, size_t len)
+{
+    while (len > 0) {
+        size_t consumed = 0;
+        ESP_RETURN_ON_FALSE(esp_rcp_ota_get_state(fetch->rcp_ota_handle) != ESP_RCP_OTA_STATE_FINISHED,
+                            ESP_ERR_INVALID_SIZE, TAG, "The RCP image exceeds its header");
+        ESP_RETURN_ON_ERROR(esp_rcp_ota_receive(fetch->rcp_ota_handle, data, len, &consumed), TAG,
+                            "Failed to receive RCP OTA data");
+        data += consumed;
+        len -= consumed;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t finish_rcp_image(manifest_fetch_t *fetch)
+{
+    esp_rcp_ota_checkpoint_t checkpoint;
+
+    ESP_RETURN_ON_FALSE(esp_rcp_ota_get_state(fetch->rcp_ota_handle) == ESP_RCP_OTA_STATE_FINISHED,
+                        ESP_ERR_INVALID_SIZE, TAG, "The RCP image is truncated");
+    // Every file has been checked against the image format, so the image ID covers the whole image.
+    ESP_RETURN_ON_FALSE(esp_rcp_ota_get_checkpoint(fetch->rcp_ota_handle, &checkpoint) == ESP_OK,
+                        ESP_ERR_NOT_SUPPORTED, TAG, "The RCP image of a manifest shall be of version 2");
+    ESP_RETURN_ON_FALSE(memcmp(checkpoint.image_id, fetch->sha256, sizeof(fetch->sha256)) == 0,
+                        ESP_ERR_INVALID_CRC, TAG, "The RCP image does not match the manifest");
+    return ESP_OK;
+}
+
+static esp_err_t write_host_firmware(manifest_fetch_t *fetch, const char *data, size_t len)
+{
+    ESP_RETURN_ON_ERROR(esp_ota_write(fetch->host_ota_handle, data, len), TAG, "Failed to write ota");
+    mbedtls_sha256_update(&fetch->host_sha256, (const uint8_t *)data, len);
+    esp_rcp_progress_update(&fetch->host_progress, fetch->received + len);
+    return ESP_OK;
+}
+
+static esp_err_t finish_host_firmware(manifest_fetch_t *fetch)
+{
+    uint8_t sha256[sizeof(fetch->sha256)];
+
+    mbedtls_sha256_finish(&fetch->host_sha256, sha256);
+    ESP_RETURN_ON_FALSE(memcmp(sha256, fetch->sha256, sizeof(sha256)) == 0, ESP_ERR_INVALID_CRC, TAG,
+                        "The Border Router firmware does not match the manifest");
+    return ESP_OK;
+}
+
+static esp_err_t fetch_component(manifest_fetch_t *fetch)
+{
+    esp_err_t ret = ESP_OK;
+    esp_http_client_handle_t http_client = NULL;
+    char *buffer = malloc(DOWNLOAD_BUFFER_SIZE);
+
+    ESP_RETURN_ON_FALSE(buffer, ESP_ERR_NO_MEM, TAG, "Failed to allocate the %s buffer", fetch->name);
+    fetch->http_config.url = fetch->url;
+    http_client = esp_http_client_init(&fetch->http_config);
+    ESP_GOTO_ON_FALSE(http_client, ESP_FAIL, exit, TAG, "Failed to create HTTP client");
+    ESP_GOTO_ON_ERROR(_http_connect(http_client), exit, TAG, "Failed to connect to %s", fetch->url);
+    while (fetch->received < fetch->size) {
+        size_t read_size = fetch->size - fetch->received < DOWNLOAD_BUFFER_SIZE ? fetch->size - fetch->received
+                                                                                : DOWNLOAD_BUFFER_SIZE;
+        int len = http_client_read_check_connection(http_client, buffer, read_size);
+        ESP_GOTO_ON_FALSE(len > 0, ESP_FAIL, exit, TAG, "Failed to download %s at %" PRIu32, fetch->name,
+                          fetch->received);
+        ESP_GOTO_ON_ERROR(fetch->write(fetch, buffer, len), exit, TAG, "Failed to write %s", fetch->name);
+        fetch->received += len;
+    }
+    ret = fetch->finish(fetch);
+exit:
+    if (http_client) {
+        _http_cleanup(http_client);
+    }
+    free(buffer);
+    return ret;
+}
+
+static void fetch_component_task(void *ctx)
+{
+    manifest_fetch_t *fetch = (manifest_fetch_t *)ctx;
+
+    fetch->result = fetch_component(fetch);
+    xSemaphoreGive(fetch->done);
+    vTaskDelete(NULL);
+}
+
+static esp_err_t begin_fetch(manifest_fetch_t *fetch)
+{
+    if (fetch->write == write_rcp_image) {
+        // The inactive RCP image slot is overwritten, the checkpoint of an interrupted download no longer holds.
+        save_checkpoint(NULL);
+        return esp_rcp_ota_begin(&fetch->rcp_ota_handle);
+    }
+    fetch->host_partition = esp_ota_get_next_update_partition(NULL);
+    ESP_RETURN_ON_FALSE(fetch->host_partition, ESP_ERR_NOT_FOUND, TAG, "Failed to find ota partition");
+    ESP_RETURN_ON_FALSE(fetch->size <= fetch->host_partition->size, ESP_ERR_INVALID_SIZE, TAG,
+                        "The Border Router firmware exceeds the ota partition");
+    ESP_RETURN_ON_ERROR(esp_ota_begin(fetch->host_partition, OTA_WITH_SEQUENTIAL_WRITES, &fetch->host_ota_handle),
+                        TAG, "Failed to begin host OTA");
+    mbedtls_sha256_starts(&fetch->host_sha256, 0);
+    esp_rcp_progress_begin(&fetch->host_progress, ESP_RCP_PROGRESS_PHASE_HOST_DOWNLOAD, fetch->size,
+                           s_progress_callback, s_progress_user_ctx);
+    return ESP_OK;
+}
+
+static void abort_fetch(manifest_fetch_t *fetch)
+{
+    if (fetch->rcp_ota_handle) {
+        esp_rcp_ota_abort(fetch->rcp_ota_handle);
+        fetch->rcp_ota_handle = 0;
+    }
+    if (fetch->host_ota_handle) {
+        esp_ota_abort(fetch->host_ota_handle);
+        fetch->host_ota_handle = 0;
+    }
+    esp_rcp_progress_end(&fetch->host_progress, false);
+}
+
+/*
+ * The RCP slot and the boot partition are switched after a commit record is saved, so the device completes the
+ * update on the next boot by esp_br_http_ota_complete_commit() if it restarts in between. A failure to switch them
+ * rolls back the RCP slot instead.
+ */
+static esp_err_t commit_manifest(manifest_fetch_t *rcp, manifest_fetch_t *host)
+{
+    esp_err_t ret = ESP_OK;
+    manifest_commit_t commit = {.rcp_seq = -1, .host_address = 0};
+
+    if (host->needed) {
+        ret = esp_ota_end(host->host_ota_handle);
+        host->host_ota_handle = 0;
+        ESP_RETURN_ON_ERROR(ret, TAG, "Failed to end host OTA");
+        esp_rcp_progress_end(&host->host_progress, true);
+        commit.host_address = host->host_partition->address;
+    }
+    if (rcp->needed) {
+        commit.rcp_seq = esp_rcp_get_next_update_seq();
+    }
+    ESP_RETURN_ON_ERROR(save_commit(&commit), TAG, "Failed to save the commit record");
+    if (rcp->needed) {
+        ret = esp_rcp_ota_end(rcp->rcp_ota_handle);
+        rcp->rcp_ota_handle = 0;
+        ESP_GOTO_ON_ERROR(ret, exit, TAG, "Failed to submit the RCP image");
+    }
+    if (host->needed) {
+        ESP_GOTO_ON_ERROR(esp_ota_set_boot_partition(host->host_partition), exit, TAG, "Failed to set boot partition");
+    }
+exit:
+    if (ret != ESP_OK && rcp->needed && esp_rcp_get_update_seq() == commit.rcp_seq) {
+        esp_rcp_mark_image_verified(false);
+    }
+    save_commit(NULL);
+    return ret;
+}
+
+esp_err_t esp_br_http_ota_manifest(esp_http_client_config_t *http_config, bool *updated)
+{
+    esp_err_t ret = ESP_OK;
+    cJSON *root = NULL;
+    manifest_fetch_t fetches[MANIFEST_COMPONENT_NUM] = {
+        [MANIFEST_COMPONENT_RCP] = {.name = "rcp", .write = write_rcp_image, .finish = finish_rcp_image},
+        [MANIFEST_COMPONENT_HOST] = {.name = "host", .write = write_host_firmware, .finish = finish_host_firmware},
+    };
+
+    ESP_RETURN_ON_FALSE(http_config && http_config->url && updated, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    *updated = false;
+    ESP_LOGI(TAG, "Downloading the manifest from %s", http_config->url);
+    ESP_RETURN_ON_ERROR(download_manifest(http_config, &root), TAG, "Failed to download the manifest");
+    for (int i = 0; i < MANIFEST_COMPONENT_NUM; i++) {
+        mbedtls_sha256_init(&fetches[i].host_sha256);
+        fetches[i].http_config = *http_config;
+        ESP_GOTO_ON_ERROR(parse_manifest_entry(root, http_config->url, &fetches[i]), exit, TAG,
+                          "Failed to parse the manifest");
+    }
+    if (fetches[MANIFEST_COMPONENT_RCP].needed && is_rcp_image_installed(&fetches[MANIFEST_COMPONENT_RCP])) {
+        ESP_LOGI(TAG, "The RCP image is up to date");
+        fetches[MANIFEST_COMPONENT_RCP].needed = false;
+    }
+    if (fetches[MANIFEST_COMPONENT_HOST].needed && is_host_firmware_installed(&fetches[MANIFEST_COMPONENT_HOST])) {
+        ESP_LOGI(TAG, "The Border Router firmware is up to date");
+        fetches[MANIFEST_COMPONENT_HOST].needed = false;
+    }
+
+    // Fetch the components on their own connections, the network receive of one overlaps the flash writes of the
+    // other.
+    for (int i = 0; i < MANIFEST_COMPONENT_NUM; i++) {
+        manifest_fetch_t *fetch = &fetches[i];
+        if (!fetch->needed) {
+            continue;
+        }
+        ESP_GOTO_ON_ERROR(begin_fetch(fetch), exit, TAG, "Failed to begin the %s update", fetch->name);
+        fetch->done = xSemaphoreCreateBinary();
+        ESP_GOTO_ON_FALSE(fetch->done, ESP_ERR_NO_MEM, exit, TAG, "Failed to create the %s semaphore", fetch->name);
+        if (xTaskCreate(fetch_component_task, "ota_fetch", MANIFEST_FETCH_TASK_STACK_SIZE, fetch,
+                        uxTaskPriorityGet(NULL), NULL) != pdPASS) {
+            vSemaphoreDelete(fetch->done);
+            fetch->done = NULL;
+            ESP_GOTO_ON_FALSE(false, ESP_ERR_NO_MEM, exit, TAG, "Failed to create the %s fetch task", fetch->name);
+        }
+    }
+exit:
+    for (int i = 0; i < MANIFEST_COMPONENT_NUM; i++) {
+        if (fetches[i].done) {
+            xSemaphoreTake(fetches[i].done, portMAX_DELAY);
+            vSemaphoreDelete(fetches[i].done);
+            ret = ret == ESP_OK ? fetches[i].result : ret;
+        }
+    }
+    if (ret == ESP_OK && (fetches[MANIFEST_COMPONENT_RCP].needed || fetches[MANIFEST_COMPONENT_HOST].needed)) {
+        ret = commit_manifest(&fetches[MANIFEST_COMPONENT_RCP], &fetches[MANIFEST_COMPONENT_HOST]);
+        *updated = ret == ESP_OK;
+    }
+    for (int i = 0; i < MANIFEST_COMPONENT_NUM; i++) {
+        abort_fetch(&fetches[i]);
+        mbedtls_sha256_free(&fetches[i].host_sha256);
+        free(fetches[i].url);
+    }
+    cJSON_Delete(root);
+    return ret;
+}
+
+esp_err_t esp_br_http_ota_complete_commit(void)
+{
+    manifest_commit_t commit;
+
+    if (load_commit(&commit) != ESP_OK) {
+        return ESP_OK;
+    }
+    ESP_LOGW(TAG, "Completing the update interrupted by a restart");
+    if (commit.rcp_seq >= 0 && esp_rcp_get_update_seq() != commit.rcp_seq) {
+        ESP_RETURN_ON_ERROR(esp_rcp_submit_new_image(), TAG, "Failed to submit the RCP image");
+    }
+    if (commit.host_address) {
+        const esp_partition_t *partition = esp_ota_get_next_update_partition(NULL);
+        if (partition && partition->address == commit.host_address) {
+            esp_err_t err = esp_ota_set_boot_partition(partition);
+            save_commit(NULL);
+            ESP_RETURN_ON_ERROR(err, TAG, "Failed to set boot partition");
+            esp_restart();
+        }
+    }
+    return save_commit(NULL);
+}
+
+esp_err_t esp_br_http_ota_init(void)
+{
+    return esp_br_http_ota_complete_commit();
+}
+
+esp_err_t esp_br_http_ota_register_progress_callback(esp_rcp_progress_cb_t callback, void *user_ctx)
+{
+    s_progress_callback = callback;
+    s_progress_user_ctx = user_ctx;
+    return ESP_OK;
+}
+
 esp_err_t esp_br_http_ota(esp_http_client_config_t *http_config)
 {
     return download_ota_image(http_config);
 }
+
+esp_err_t esp_br_http_ota_bench(esp_http_client_config_t *http_config,
+                                const esp_br_http_ota_bench_config_t *bench_config,
+                                esp_br_http_ota_bench_result_t *result)
+{
+    esp_err_t ret = ESP_OK;
+    ota_download_t download;
+    esp_http_client_handle_t http_client = NULL;
+    char *buffer = NULL;
+    size_t read_size = 0;
+    bool storage = false;
+    int64_t start_us = 0;
+
+    ESP_RETURN_ON_FALSE(http_config && http_config->url && bench_config && result, ESP_ERR_INVALID_ARG, TAG,
+                        "Invalid benchmark config");
+    storage = bench_config->sink == ESP_BR_HTTP_OTA_BENCH_SINK_STORAGE;
+    ESP_RETURN_ON_FALSE(!storage || bench_config->confirm_overwrite, ESP_ERR_INVALID_ARG, TAG,
+                        "The storage benchmark overwrites the backup images and shall be confirmed");
+    read_size = bench_config->read_size ? bench_config->read_size : DOWNLOAD_BUFFER_SIZE;
+    memset(result, 0, sizeof(*result));
+    memset(&download, 0, sizeof(download));
+    buffer = malloc(read_size);
+    ESP_RETURN_ON_FALSE(buffer, ESP_ERR_NO_MEM, TAG, "Failed to allocate the read buffer");
+    http_client = esp_http_client_init(http_config);
+    ESP_GOTO_ON_FALSE(http_client, ESP_FAIL, exit, TAG, "Failed to create HTTP client");
+    if (storage) {
+        // The inactive RCP image slot is overwritten, the checkpoint of an interrupted download no longer holds.
+        ESP_LOGW(TAG, "Overwriting the backup RCP image and the next OTA partition, the OTA checkpoint is erased");
+        save_checkpoint(NULL);
+        ESP_GOTO_ON_ERROR(begin_download(&download), exit, TAG, "Failed to begin RCP OTA");
+        download.bench = true;
+    }
+
+    start_us = esp_timer_get_time();
+    ESP_GOTO_ON_ERROR(_http_connect(http_client), exit, TAG, "Failed to connect to HTTP server");
+    result->connect_us = esp_timer_get_time() - start_us;
+    while (!storage || !is_download_done(&download)) {
+        int64_t read_start_us = esp_timer_get_time();
+        int len = http_client_read_check_connection(http_client, buffer, read_size);
+        result->network_us += esp_timer_get_time() - read_start_us;
+        ESP_GOTO_ON_FALSE(len >= 0, ESP_FAIL, exit, TAG, "Failed to download");
+        result->network_bytes += len;
+        if (storage) {
+            ESP_GOTO_ON_ERROR(process_data(&download, download.stream_offset, buffer, len), exit, TAG,
+                              "Failed to process data");
+            download.stream_offset += len;
+        }
+        if (len == 0 || esp_http_client_is_complete_data_received(http_client)) {
+            break;
+        }
+    }
+    ESP_GOTO_ON_FALSE(!storage || is_download_done(&download), ESP_ERR_INVALID_SIZE, exit, TAG, "Image is truncated");
+    result->total_us = esp_timer_get_time() - start_us;
+    result->rcp_store_bytes = download.image_offset - download.br_fw_downloaded;
+    result->rcp_store_us = download.rcp_store_us;
+    result->host_write_bytes = download.br_fw_downloaded;
+    result->host_write_us = download.host_write_us;
+exit:
+    if (http_client) {
+        _http_cleanup(http_client);
+    }
+    if (storage) {
+        // Nothing is submitted, the written image is left in the inactive slot and partition.
+        esp_rcp_progress_end(&download.host_progress, ret == ESP_OK);
+        abort_download(&download);
+    }
+    free(buffer);
+    return ret;
+}
@@ -0,0 +1,66 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <esp_err.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief The stages of the Border Router startup, in the order they usually complete.
+ *
+ * The backbone stages run in parallel with the OpenThread stages, so their order may differ from boot to boot.
+ */
+typedef enum {
+    ESP_OT_BOOT_STAGE_APP_START = 0,   /*!< app_main() is entered */
+    ESP_OT_BOOT_STAGE_NVS_READY,       /*!< NVS is initialized */
+    ESP_OT_BOOT_STAGE_NETIF_READY,     /*!< esp_netif, the default event loop and mDNS are initialized */
+    ESP_OT_BOOT_STAGE_OT_INIT,         /*!< The OpenThread stack is initialized and the RCP is attached */
+    ESP_OT_BOOT_STAGE_RCP_CHECKED,     /*!< The RCP firmware is checked against the stored RCP image */
+    ESP_OT_BOOT_STAGE_CLI_READY,       /*!< The OpenThread CLI is started */
+    ESP_OT_BOOT_STAGE_BACKBONE_UP,     /*!< The Wi-Fi or Ethernet backbone is connected */
+    ESP_OT_BOOT_STAGE_BR_INIT,         /*!< The border routing features are initialized */
+    ESP_OT_BOOT_STAGE_THREAD_ATTACHED, /*!< The device is attached to a Thread network */
+    ESP_OT_BOOT_STAGE_THREAD_ROUTING,  /*!< The device is a Thread router or leader */
+    ESP_OT_BOOT_STAGE_MAX,
+} esp_ot_boot_stage_t;
+
+/**
+ * @brief Record the completion of a boot stage.
+ *
+ * The time since the chip started is recorded on the first call for each stage, the later calls are ignored.
+ *
+ * @param[in] stage  The completed stage.
+ */
+void esp_ot_boot_timeline_mark(esp_ot_boot_stage_t stage);
+
+/**
+ * @brief Get the time at which a boot stage completed.
+ *
+ * @param[in]  stage    The boot stage.
+ * @param[out] time_us  The time since the chip started in microseconds.
+ *
+ * @return
+ *      -   ESP_OK                  : On success
+ *      -   ESP_ERR_INVALID_ARG     : Invalid stage
+ *      -   ESP_ERR_NOT_FOUND       : The stage has not completed
+ */
+esp_err_t esp_ot_boot_timeline_get(esp_ot_boot_stage_t stage, int64_t *time_us);
+
+/**
+ * @brief Get the name of a boot stage.
+ *
+ * @return The name of the stage, "unknown" for an invalid stage.
+ */
+const char *esp_ot_boot_stage_to_str(esp_ot_boot_stage_t stage);
+
+#ifdef __cplusplus
+}
+#endif
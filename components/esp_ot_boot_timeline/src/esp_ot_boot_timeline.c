@@ -0,0 +1,53 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "esp_ot_boot_timeline.h"
+#include "esp_check.h"
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+#define BOOT_STAGE_PENDING (-1)
+
+#define TAG "BOOT_TIMELINE"
+
+static const char *const s_stage_names[ESP_OT_BOOT_STAGE_MAX] = {
+    "app_start",   "nvs_ready",   "netif_ready", "ot_init",         "rcp_checked",
+    "cli_ready",   "backbone_up", "br_init",     "thread_attached", "thread_routing",
+};
+
+static int64_t s_stage_times[ESP_OT_BOOT_STAGE_MAX] = {
+    [0 ... ESP_OT_BOOT_STAGE_MAX - 1] = BOOT_STAGE_PENDING,
+};
+static portMUX_TYPE s_timeline_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void esp_ot_boot_timeline_mark(esp_ot_boot_stage_t stage)
+{
+    if (stage < 0 || stage >= ESP_OT_BOOT_STAGE_MAX) {
+        return;
+    }
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&s_timeline_lock);
+    if (s_stage_times[stage] == BOOT_STAGE_PENDING) {
+        s_stage_times[stage] = now;
+    }
+    portEXIT_CRITICAL(&s_timeline_lock);
+}
+
+esp_err_t esp_ot_boot_timeline_get(esp_ot_boot_stage_t stage, int64_t *time_us)
+{
+    ESP_RETURN_ON_FALSE(stage >= 0 && stage < ESP_OT_BOOT_STAGE_MAX && time_us, ESP_ERR_INVALID_ARG, TAG,
+                        "Invalid boot stage");
+    portENTER_CRITICAL(&s_timeline_lock);
+    *time_us = s_stage_times[stage];
+    portEXIT_CRITICAL(&s_timeline_lock);
+    return *time_us == BOOT_STAGE_PENDING ? ESP_ERR_NOT_FOUND : ESP_OK;
+}
+
+const char *esp_ot_boot_stage_to_str(esp_ot_boot_stage_t stage)
+{
+    return stage >= 0 && stage < ESP_OT_BOOT_STAGE_MAX ? s_stage_names[stage] : "unknown";
+}
@@ -0,0 +1,275 @@
+#!/usr/bin/env python3
+#
+# SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+"""
+Generate the REST API route table and the struct-direct JSON codecs from openapi.yaml.
+
+The spec is annotated with the following vendor extensions:
+
+  Operations:
+    x-esp-handler     The C handler of the operation.
+    x-esp-scratch     The handler uses the scratch buffer of the server for the request or response body.
+
+  Schemas:
+    x-esp-c-type      The C struct which is encoded to and decoded from the schema.
+    x-esp-c-codec     The schema is a string which is converted by a codec of esp_br_web_json.h.
+
+  Properties of a schema with x-esp-c-type:
+    x-esp-c-field     The member of the C struct, "." means the struct itself.
+    x-esp-c-codec     The codec of a string property: hex, ip6-prefix or string (default).
+    x-esp-c-present   The flag which is checked before encoding and set after decoding.
+
+For every schema with x-esp-c-type, esp_br_web_encode_<Schema>() and esp_br_web_decode_<Schema>() are generated.
+They write and parse JSON straight from and to the C struct without building a cJSON tree. The decoder skips the
+unknown members and fails on a known member of another JSON type.
+"""
+
+import argparse
+import os
+import sys
+
+import yaml
+
+HTTP_METHODS = ('get', 'put', 'post', 'delete', 'patch')
+
+UINT_MAX = {
+    'uint8': 'UINT8_MAX',
+    'uint16': 'UINT16_MAX',
+    'uint32': 'UINT32_MAX',
+    'uint64': 'UINT64_MAX',
+}
+
+STRING_CODECS = {
+    'string': ('esp_br_web_json_write_string(writer, "{key}", {field});',
+               'esp_br_web_json_read_string(reader, {field}, sizeof({field}))'),
+    'hex': ('esp_br_web_json_write_hex(writer, "{key}", {field}, sizeof({field}));',
+            'esp_br_web_json_read_hex(reader, {field}, sizeof({field}))'),
+    'ip6-prefix': ('esp_br_web_json_write_ip6_prefix(writer, "{key}", {field});',
+                   'esp_br_web_json_read_ip6_prefix(reader, {field})'),
+    'dataset-tlvs': (None, 'esp_br_web_json_read_dataset_tlvs(reader, {field})'),
+}
+
+GENERATED_NOTICE = '/* Generated by gen_web_api.py from openapi.yaml, do not edit. */\n'
+
+
+class SpecError(Exception):
+    pass
+
+
+def schema_name(ref):
+    prefix = '#/components/schemas/'
+    if not ref.startswith(prefix):
+        raise SpecError('Unsupported reference {}'.format(ref))
+    return ref[len(prefix):]
+
+
+def wrap_macro(lines):
+    width = max(len(line) for line in lines) + 1
+    return '\n'.join(line.ljust(width) + '\\' for line in lines[:-1]) + '\n' + lines[-1] + '\n'
+
+
+def generate_routes(spec):
+    lines = ['#define ESP_BR_WEB_REST_API_ROUTES(X)']
+    for path, operations in spec['paths'].items():
+        for method in HTTP_METHODS:
+            if method not in operations:
+                continue
+            operation = operations[method]
+            if 'x-esp-handler' not in operation:
+                raise SpecError('{} {} has no x-esp-handler'.format(method.upper(), path))
+            scratch = 'true' if operation.get('x-esp-scratch', False) else 'false'
+            lines.append('    X("{}", HTTP_{}, {}, {})'.format(path, method.upper(), operation['x-esp-handler'],
+                                                               scratch))
+    return ('#pragma once\n\n' + GENERATED_NOTICE + '\n#include "esp_http_server.h"\n#include <stdbool.h>\n\n'
+            '/* X(uri, method, handler, scratch) */\n' + wrap_macro(lines))
+
+
+class CodecGenerator:
+
+    def __init__(self, spec):
+        self.schemas = spec['components']['schemas']
+        self.includes = spec.get('x-esp-c-includes', [])
+
+    def c_schemas(self):
+        return [(name, schema) for name, schema in self.schemas.items()
+                if 'x-esp-c-type' in schema and 'x-esp-c-codec' not in schema]
+
+    def field_expr(self, prop):
+        field = prop['x-esp-c-field']
+        return 'value' if field == '.' else 'value->{}'.format(field)
+
+    def field_ptr(self, prop):
+        field = prop['x-esp-c-field']
+        return 'value' if field == '.' else '&value->{}'.format(field)
+
+    def alternatives(self, name, key, prop):
+        if '$ref' in prop:
+            return [schema_name(prop['$ref'])]
+        if 'oneOf' in prop:
+            return [schema_name(alt['$ref']) for alt in prop['oneOf']]
+        raise SpecError('{}.{} has no schema reference'.format(name, key))
+
+    def encode_property(self, name, key, prop):
+        if '$ref' in prop or 'oneOf' in prop:
+            encodable = [alt for alt in self.alternatives(name, key, prop) if 'x-esp-c-codec' not in self.schemas[alt]]
+            return ['esp_br_web_encode_{}(writer, "{}", {});'.format(encodable[0], key, self.field_ptr(prop))]
+        kind = prop.get('type')
+        if kind in ('integer', 'number'):
+            return ['esp_br_web_json_write_uint(writer, "{}", {});'.format(key, self.field_expr(prop))]
+        if kind == 'boolean':
+            return ['esp_br_web_json_write_bool(writer, "{}", {});'.format(key, self.field_expr(prop))]
+        if kind == 'string':
+            codec = STRING_CODECS[prop.get('x-esp-c-codec', 'string')][0]
+            return [codec.format(key=key, field=self.field_expr(prop))]
+        raise SpecError('{}.{} has unsupported type {}'.format(name, key, kind))
+
+    def decode_property(self, name, key, prop):
+        """Return a list of (json type, statements) branches of the property."""
+        branches = []
+        if '$ref' in prop or 'oneOf' in prop:
+            for alt in self.alternatives(name, key, prop):
+                codec = self.schemas[alt].get('x-esp-c-codec')
+                if codec:
+                    call = STRING_CODECS[codec][1].format(field=self.field_ptr(prop))
+                    branches.append(('ESP_BR_WEB_JSON_STRING', [call]))
+                else:
+                    call = 'esp_br_web_decode_{}(reader, {})'.format(alt, self.field_ptr(prop))
+                    branches.append(('ESP_BR_WEB_JSON_OBJECT', [call]))
+            return branches
+        kind = prop.get('type')
+        if kind in ('integer', 'number'):
+            fmt = prop.get('format', 'uint32')
+            if fmt not in UINT_MAX:
+                raise SpecError('{}.{} has unsupported format {}'.format(name, key, fmt))
+            maximum = prop.get('maximum', UINT_MAX[fmt])
+            call = 'esp_br_web_json_read_uint(reader, {}, {}, &number)'.format(prop.get('minimum', 0), maximum)
+            return [('ESP_BR_WEB_JSON_NUMBER', [call, '{} = number;'.format(self.field_expr(prop))])]
+        if kind == 'boolean':
+            call = 'esp_br_web_json_read_bool(reader, &flag)'
+            return [('ESP_BR_WEB_JSON_BOOL', [call, '{} = flag;'.format(self.field_expr(prop))])]
+        if kind == 'string':
+            call = STRING_CODECS[prop.get('x-esp-c-codec', 'string')][1].format(field=self.field_expr(prop))
+            return [('ESP_BR_WEB_JSON_STRING', [call])]
+        raise SpecError('{}.{} has unsupported type {}'.format(name, key, kind))
+
+    def encoder(self, name, schema):
+        ctype = schema['x-esp-c-type']
+        out = ['esp_err_t esp_br_web_encode_{}(esp_br_web_json_writer_t *writer, const char *key, const {} *value)'
+               .format(name, ctype), '{', '    esp_br_web_json_write_object_start(writer, key);']
+        for key, prop in schema['properties'].items():
+            if 'x-esp-c-field' not in prop:
+                raise SpecError('{}.{} has no x-esp-c-field'.format(name, key))
+            statements = self.encode_property(name, key, prop)
+            if 'x-esp-c-present' in prop:
+                out.append('    if (value->{}) {{'.format(prop['x-esp-c-present']))
+                out += ['        ' + s for s in statements]
+                out.append('    }')
+            else:
+                out += ['    ' + s for s in statements]
+        out += ['    esp_br_web_json_write_object_end(writer);', '    return writer->err;', '}', '']
+        return out
+
+    def decoder(self, name, schema):
+        ctype = schema['x-esp-c-type']
+        body = []
+        uses_number = uses_flag = False
+        keyword = 'if'
+        for key, prop in schema['properties'].items():
+            body.append('        {} (strcmp(key, "{}") == 0) {{'.format(keyword, key))
+            type_keyword = 'if'
+            for json_type, statements in self.decode_property(name, key, prop):
+                uses_number |= any('&number' in s for s in statements)
+                uses_flag |= any('&flag' in s for s in statements)
+                body.append('            {} (type == {}) {{'.format(type_keyword, json_type))
+                body.append('                ESP_RETURN_ON_ERROR({}, SCHEMA_TAG, "Invalid {}");'.format(
+                    statements[0], key))
+                body += ['                ' + s for s in statements[1:]]
+                if 'x-esp-c-present' in prop:
+                    body.append('                value->{} = true;'.format(prop['x-esp-c-present']))
+                type_keyword = '} else if'
+            # A known member of another JSON type is an error, it is not skipped like an unknown member.
+            body += ['            } else {',
+                     '                ESP_RETURN_ON_ERROR(ESP_ERR_INVALID_ARG, SCHEMA_TAG, "Invalid type of {}");'
+                     .format(key),
+                     '            }']
+            keyword = '} else if'
+        body += ['        } else {',
+                 '            ESP_RETURN_ON_ERROR(esp_br_web_json_skip_value(reader), SCHEMA_TAG, "Invalid %s", key);',
+                 '        }']
+
+        out = ['esp_err_t esp_br_web_decode_{}(esp_br_web_json_reader_t *reader, {} *value)'.format(name, ctype), '{',
+               '    esp_err_t ret = ESP_OK;', '    char key[ESP_BR_WEB_JSON_KEY_MAX_SIZE];']
+        if uses_number:
+            out.append('    uint64_t number = 0;')
+        if uses_flag:
+            out.append('    bool flag = false;')
+        out += ['',
+                '    ESP_RETURN_ON_ERROR(esp_br_web_json_read_object_start(reader), SCHEMA_TAG, "Invalid {}");'
+                .format(name),
+                '    while ((ret = esp_br_web_json_read_member(reader, key, sizeof(key))) == ESP_OK) {',
+                '        esp_br_web_json_type_t type = esp_br_web_json_peek(reader);']
+        out += body
+        out += ['    }', '    return ret == ESP_ERR_NOT_FOUND ? ESP_OK : ret;', '}', '']
+        return out
+
+    def header(self):
+        out = ['#pragma once', '', GENERATED_NOTICE.rstrip(), '', '#ifdef __cplusplus', 'extern "C" {', '#endif', '',
+               '#include "esp_br_web_json.h"', '#include "esp_err.h"']
+        out += ['#include "{}"'.format(include) for include in self.includes]
+        out.append('')
+        for name, schema in self.c_schemas():
+            ctype = schema['x-esp-c-type']
+            out += ['/**',
+                    ' * @brief Write @param value as the {} schema, @param key shall be NULL for the root object.'
+                    .format(name), ' */',
+                    'esp_err_t esp_br_web_encode_{}(esp_br_web_json_writer_t *writer, const char *key, const {} *value);'
+                    .format(name, ctype), '',
+                    '/**',
+                    ' * @brief Parse the {} schema into @param value, the members not present in JSON are kept.'
+                    .format(name), ' */',
+                    'esp_err_t esp_br_web_decode_{}(esp_br_web_json_reader_t *reader, {} *value);'.format(name, ctype),
+                    '']
+        out += ['#ifdef __cplusplus', '}', '#endif', '']
+        return '\n'.join(out)
+
+    def source(self):
+        out = [GENERATED_NOTICE.rstrip(), '', '#include "esp_br_web_schemas.h"', '#include "esp_br_web_json.h"',
+               '#include "esp_check.h"', '#include "esp_err.h"', '#include <stdbool.h>', '#include <stdint.h>',
+               '#include <string.h>', '', '#define SCHEMA_TAG "web_schemas"', '']
+        for name, schema in self.c_schemas():
+            out += self.encoder(name, schema)
+            out += self.decoder(name, schema)
+        return '\n'.join(out)
+
+
+def write_file(path, content):
+    with open(path, 'w') as fout:
+        fout.write(content)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--spec', type=str, required=True, help='The path of openapi.yaml')
+    parser.add_argument('--output-dir', type=str, required=True, help='The directory of the generated files')
+    args = parser.parse_args()
+
+    with open(args.spec, 'r') as fin:
+        spec = yaml.safe_load(fin)
+
+    try:
+        routes = generate_routes(spec)
+        codecs = CodecGenerator(spec)
+        header = codecs.header()
+        source = codecs.source()
+    except (SpecError, KeyError) as e:
+        sys.exit('{}: {}'.format(args.spec, e))
+
+    os.makedirs(args.output_dir, exist_ok=True)
+    write_file(os.path.join(args.output_dir, 'esp_br_web_routes.h'), routes)
+    write_file(os.path.join(args.output_dir, 'esp_br_web_schemas.h'), header)
+    write_file(os.path.join(args.output_dir, 'esp_br_web_schemas.c'), source)
+
+
+if __name__ == '__main__':
+    main()
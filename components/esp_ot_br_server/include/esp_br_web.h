@@ -10,6 +10,17 @@
 extern "C" {
 #endif
 
+/**
+ * @brief Set the certificate and private key of the HTTPS web server.
+ *
+ * @note It shall be called before the web server starts when CONFIG_OPENTHREAD_BR_WEB_HTTPS is enabled, the
+ *       buffers shall stay valid while the server is running.
+ *
+ * @param[in] cert  The server certificate in PEM format, NUL terminated.
+ * @param[in] key   The private key of the server certificate in PEM format, NUL terminated.
+ */
+void esp_br_web_set_server_cert(const char *cert, const char *key);
+
 /**
  * @brief Start border router web server, which provides REST APIs and GUI
  *
@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+#
+# SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+#
+# Pack the Web GUI files into the flat image served from the memory-mapped "web_storage" partition.
+# The layout shall be kept in sync with esp_br_web_assets.c.
+
+import argparse
+import os
+import struct
+import sys
+
+WEB_ASSETS_MAGIC = 0x4157544f  # 'OTWA'
+WEB_ASSETS_VERSION = 1
+WEB_ASSETS_PATH_SIZE = 56
+WEB_ASSETS_ALIGN = 4
+
+HEADER_FORMAT = '<IHHI'
+ENTRY_FORMAT = '<{}sII'.format(WEB_ASSETS_PATH_SIZE)
+
+
+def align(size):
+    return (size + WEB_ASSETS_ALIGN - 1) & ~(WEB_ASSETS_ALIGN - 1)
+
+
+def collect_assets(input_dir):
+    assets = []
+    for root, dirs, files in os.walk(input_dir):
+        dirs.sort()
+        for name in sorted(files):
+            file_path = os.path.join(root, name)
+            url_path = '/' + os.path.relpath(file_path, input_dir).replace(os.sep, '/')
+            if len(url_path.encode()) >= WEB_ASSETS_PATH_SIZE:
+                raise ValueError('The path {} is too long'.format(url_path))
+            with open(file_path, 'rb') as f:
+                assets.append((url_path, f.read()))
+    return assets
+
+
+def pack_assets(assets):
+    offset = align(struct.calcsize(HEADER_FORMAT) + struct.calcsize(ENTRY_FORMAT) * len(assets))
+    entries = b''
+    data = b''
+    for url_path, content in assets:
+        entries += struct.pack(ENTRY_FORMAT, url_path.encode(), offset + len(data), len(content))
+        data += content + b'\xff' * (align(len(content)) - len(content))
+    image_size = offset + len(data)
+    header = struct.pack(HEADER_FORMAT, WEB_ASSETS_MAGIC, WEB_ASSETS_VERSION, len(assets), image_size)
+    table = header + entries
+    return table + b'\xff' * (offset - len(table)) + data
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Pack the Web GUI files into a memory-mappable image')
+    parser.add_argument('--input-dir', required=True, help='The directory of the Web GUI files')
+    parser.add_argument('--output', required=True, help='The output image file')
+    parser.add_argument('--partition-size', type=lambda x: int(x, 0), help='The size of the target partition')
+    args = parser.parse_args()
+
+    image = pack_assets(collect_assets(args.input_dir))
+    if args.partition_size is not None and len(image) > args.partition_size:
+        sys.exit('The web assets image ({} bytes) exceeds the partition size ({} bytes)'.format(
+            len(image), args.partition_size))
+    with open(args.output, 'wb') as f:
+        f.write(image)
+
+
+if __name__ == '__main__':
+    main()
@@ -14,28 +14,22 @@ extern "C" {
 #include "esp_br_web_base.h"
 #include "esp_http_server.h"
 #include "openthread/error.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 /*---------------------------------------------------------------------
             ESP Thread Border Router Wer Server REST API
 ----------------------------------------------------------------------*/
+/* The Thread REST API paths are generated from openapi.yaml, see esp_br_web_routes.h */
 /* HTTP GET */
-#define ESP_OT_REST_API_DIAGNOSTICS_PATH "/diagnostics"
-#define ESP_OT_REST_API_NODE_PATH "/node"
-#define ESP_OT_REST_API_NODE_RLOC_PATH "/node/rloc"
-#define ESP_OT_REST_API_NODE_RLOC16_PATH "/node/rloc16"
-#define ESP_OT_REST_API_NODE_STATE_PATH "/node/state"
-#define ESP_OT_REST_API_NODE_EXTADDRESS_PATH "/node/ext-address"
-#define ESP_OT_REST_API_NODE_NETWORKNAME_PATH "/node/network-name"
-#define ESP_OT_REST_API_NODE_LEADERDATA_PATH "/node/leader-data"
-#define ESP_OT_REST_API_NODE_NUMBEROFROUTER_PATH "/node/num-of-router"
-#define ESP_OT_REST_API_NODE_EXTPANID_PATH "/node/ext-panid"
-#define ESP_OT_REST_API_NODE_BORDERAGENTID_PATH "/node/ba-id"
-#define ESP_OT_REST_API_NODE_DATASET_ACTIVE_PATH "/node/dataset/active"
-#define ESP_OT_REST_API_NODE_DATASET_PENDING_PATH "/node/dataset/pending"
 #define ESP_OT_REST_API_PROPERTIES_PATH "/get_properties"
 #define ESP_OT_REST_API_AVAILABLE_NETWORK_PATH "/available_network"
 #define ESP_OT_REST_API_NODE_INFORMATION_PATH "/node_information"
 #define ESP_OT_REST_API_TOPOLOGY_PATH "/topology"
+#define ESP_OT_REST_API_WEB_BENCH_PATH "/web_bench"
+#define ESP_OT_REST_API_OTA_PROGRESS_PATH "/ota/progress"
+#define ESP_OT_REST_API_BOOT_TIMELINE_PATH "/boot/timeline"
 /* HTTP POST */
 #define ESP_OT_REST_API_JOIN_NETWORK_PATH "/join_network"
 #define ESP_OT_REST_API_FORM_NETWORK_PATH "/form_network"
@@ -138,14 +132,16 @@ cJSON *handle_ot_resource_node_extpanid_request(void);
 cJSON *handle_ot_resource_node_baid_request(void);
 
 /**
- * @brief Handle the Thread dataset get @param request and provide @param log
+ * @brief Handle the Thread dataset get request, the dataset is written to @param buf without building a cJSON tree.
  *
- * @param [in] request  A cJSON format from http request for getting dataset.
- * @param [out] log     A cJSON String type to record the result of getting dataset.
+ * @param [in] dataset_type The type of dataset, ESP_OT_DATASET_TYPE_ACTIVE or ESP_OT_DATASET_TYPE_PENDING.
+ * @param [in] tlv_format   If true, the dataset is written as hex-encoded TLVs, otherwise as JSON.
+ * @param [out] buf         The buffer of the response body.
+ * @param [in] size         The size of @param buf.
  *
- * @return              The cJSON object of Thread dataset
+ * @return                  The http status code of the response.
  */
-cJSON *handle_ot_resource_node_get_dataset_request(const cJSON *request, cJSON *log);
+uint16_t handle_ot_resource_node_get_dataset_request(const char *dataset_type, bool tlv_format, char *buf, size_t size);
 
 /**
  * @brief Handle the Thread state configuration @param request
@@ -160,13 +156,17 @@ cJSON *handle_ot_resource_node_get_dataset_request(const cJSON *request, cJSON *
 otError handle_ot_resource_node_state_put_request(cJSON *request);
 
 /**
- * @brief Handle the Thread dataset set @param request and provide @param log
+ * @brief Handle the Thread dataset set request, the JSON @param body is parsed into the dataset directly.
  *
- * @param [in] request  A cJSON format from http request for setting dataset.
- * @param [out] log     A cJSON String type to record the result of setting dataset.
+ * @param [in] dataset_type The type of dataset, ESP_OT_DATASET_TYPE_ACTIVE or ESP_OT_DATASET_TYPE_PENDING.
+ * @param [in] tlv_format   If true, @param body is the dataset in hex-encoded TLVs, otherwise in JSON.
+ * @param [in] body         The null-terminated request body.
+ * @param [in] len          The length of @param body.
  *
+ * @return                  The http status code of the response.
  */
-void handle_ot_resource_node_set_dataset_request(const cJSON *request, cJSON *log);
+uint16_t handle_ot_resource_node_set_dataset_request(const char *dataset_type, bool tlv_format, char *body,
+                                                     size_t len);
 
 /**
  * @brief Handle the Thread network formation @param request and provide @param log
@@ -0,0 +1,49 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_err.h"
+#include <stddef.h>
+
+/**
+ * @brief Memory-map the web assets image stored in the partition of @param label.
+ *
+ * The whole partition is mapped once and kept mapped, the image is generated by pack_web_assets.py.
+ * Calling it again after a successful initialization does nothing.
+ *
+ * @param[in] label The label of the partition.
+ *
+ * @return
+ *      -   ESP_OK                  : On success
+ *      -   ESP_ERR_NOT_FOUND       : The partition is not found
+ *      -   ESP_ERR_INVALID_VERSION : The partition does not hold a web assets image of a supported version
+ *      -   ESP_ERR_INVALID_SIZE    : The asset table is out of the bounds of the partition
+ *      -   Others                  : Failed to map the partition
+ */
+esp_err_t esp_br_web_assets_init(const char *label);
+
+/**
+ * @brief Find the asset of @param path in the mapped image.
+ *
+ * @param[in]  path The request path of the asset, e.g. "/index.html".
+ * @param[out] data The asset content in the mapped flash, valid as long as the program runs.
+ * @param[out] size The size of the asset content.
+ *
+ * @return
+ *      -   ESP_OK                  : On success
+ *      -   ESP_ERR_INVALID_STATE   : The image is not mapped
+ *      -   ESP_ERR_NOT_FOUND       : No asset of @param path
+ */
+esp_err_t esp_br_web_assets_find(const char *path, const char **data, size_t *size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -46,6 +46,7 @@ extern "C" {
 #define ESP_OT_DATASET_TYPE_PENDING "pending"
 
 #define HTTPD_201 "201 Created"
+#define HTTPD_202 "202 Accepted"
 #define HTTPD_409 "409 Conflict"
 
 /**
@@ -213,17 +214,6 @@ cJSON *dailnosticTlv_set_convert2_json(const thread_diagnosticTlv_set_t *set);
 void thread_node_information_reset(thread_node_informaiton_t *node);
 cJSON *thread_node_struct_convert2_json(thread_node_informaiton_t *node);
 
-cJSON *Timestamp2Json(const otTimestamp aTimestamp);
-cJSON *SecurityPolicy2Json(const otSecurityPolicy aSecurityPolicy);
-cJSON *ActiveDataset2Json(const otOperationalDataset aActiveDataset);
-cJSON *PendingDataset2Json(const otOperationalDataset aPendingDataset);
-
-esp_err_t Json2Timestamp(const cJSON *jsonTimestamp, otTimestamp *aTimestamp);
-esp_err_t Json2SecurityPolicy(const cJSON *jsonTimestamp, otSecurityPolicy *aSecurityPolicy);
-esp_err_t Json2ActiveDataset(const cJSON *jsonActiveDataset, otOperationalDataset *aActiveDataset);
-esp_err_t JsonString2ActiveDataset(const cJSON *JsonStringActiveDataset, otOperationalDataset *aActiveDataset);
-esp_err_t Json2PendingDataset(const cJSON *jsonPendingDataset, otOperationalDataset *aPendingDataset);
-
 void ot_br_web_response_code_get(uint16_t errcode, char *status_buf);
 esp_err_t convert_ot_err_to_response_code(otError errcode, char *status_buf);
 
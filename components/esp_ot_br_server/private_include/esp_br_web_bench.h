@@ -0,0 +1,51 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "cJSON.h"
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Start the micro-benchmark of the generated dataset codecs and the diagnostic and properties JSON converters
+ *        in a task.
+ *
+ * Every converter is run @param iterations times against synthetic fixtures (a full operational dataset and
+ * diagnostic sets of 50, 150 and 300 nodes, up to CONFIG_OPENTHREAD_BR_WEB_BENCH_MAX_DIAG_NODES). The time, the
+ * number of heap allocations and the allocated bytes are reported per operation, together with the stored baseline
+ * of each converter. Every heap allocation of the benchmark task is counted, not only the cJSON ones. The
+ * struct-direct dataset codecs generated from openapi.yaml are measured next to the cJSON converters. The
+ * benchmark runs below the priority of the web server, so it does not block the requests.
+ *
+ * @param[in] iterations    The number of iterations of every converter.
+ * @param[in] save_baseline If true, the results are stored in NVS as the new baseline.
+ *
+ * @return
+ *      -   ESP_OK                  : The benchmark is started
+ *      -   ESP_ERR_INVALID_ARG     : Invalid iterations
+ *      -   ESP_ERR_INVALID_STATE   : The benchmark is running
+ *      -   ESP_ERR_NO_MEM          : Failed to create the task
+ */
+esp_err_t esp_br_web_bench_start(uint16_t iterations, bool save_baseline);
+
+/**
+ * @brief Get the state of the benchmark and the results of the last completed run.
+ *
+ * It shall be called from the task calling esp_br_web_bench_start(), i.e. the web server.
+ *
+ * @return The cJSON object of the state and the results, NULL on failure.
+ */
+cJSON *esp_br_web_bench_get_report(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,197 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "openthread/dataset.h"
+
+#define ESP_BR_WEB_JSON_KEY_MAX_SIZE 32
+#define ESP_BR_WEB_JSON_MAX_DEPTH 8
+
+/**
+ * @brief The streaming JSON writer used by the generated schema encoders.
+ *
+ * The writer appends to a caller-provided buffer. The first failure is kept in @param err and all the later
+ * writes are ignored, so a sequence of writes only needs to be checked once at the end.
+ */
+typedef struct esp_br_web_json_writer {
+    char *buf;                                 /* the output buffer */
+    size_t size;                               /* the size of the output buffer */
+    size_t len;                                /* the length of the written JSON text */
+    uint8_t depth;                             /* the nesting depth of the current object */
+    bool comma[ESP_BR_WEB_JSON_MAX_DEPTH + 1]; /* whether a member has been written at each depth */
+    esp_err_t err;                             /* the first error */
+} esp_br_web_json_writer_t;
+
+/**
+ * @brief The pull JSON reader used by the generated schema decoders.
+ *
+ * The reader parses the JSON text in place, no tree is built and no memory is allocated.
+ */
+typedef struct esp_br_web_json_reader {
+    const char *cur;                           /* the current position */
+    const char *end;                           /* the end of the JSON text */
+    uint8_t depth;                             /* the nesting depth of the current object */
+    bool comma[ESP_BR_WEB_JSON_MAX_DEPTH + 1]; /* whether a member has been read at each depth */
+} esp_br_web_json_reader_t;
+
+typedef enum {
+    ESP_BR_WEB_JSON_INVALID = 0,
+    ESP_BR_WEB_JSON_NULL,
+    ESP_BR_WEB_JSON_BOOL,
+    ESP_BR_WEB_JSON_NUMBER,
+    ESP_BR_WEB_JSON_STRING,
+    ESP_BR_WEB_JSON_ARRAY,
+    ESP_BR_WEB_JSON_OBJECT,
+} esp_br_web_json_type_t;
+
+/**
+ * @brief Initialize @param writer to write JSON text into @param buf.
+ *
+ * @param[out] writer   The JSON writer.
+ * @param[in]  buf      The output buffer, the JSON text is always null-terminated.
+ * @param[in]  size     The size of @param buf.
+ */
+void esp_br_web_json_writer_init(esp_br_web_json_writer_t *writer, char *buf, size_t size);
+
+/**
+ * @brief Write the start of an object, @param key shall be NULL for the root object.
+ */
+void esp_br_web_json_write_object_start(esp_br_web_json_writer_t *writer, const char *key);
+
+/**
+ * @brief Write the end of the current object.
+ */
+void esp_br_web_json_write_object_end(esp_br_web_json_writer_t *writer);
+
+/**
+ * @brief Write an unsigned integer member.
+ */
+void esp_br_web_json_write_uint(esp_br_web_json_writer_t *writer, const char *key, uint64_t value);
+
+/**
+ * @brief Write a boolean member.
+ */
+void esp_br_web_json_write_bool(esp_br_web_json_writer_t *writer, const char *key, bool value);
+
+/**
+ * @brief Write a string member, @param value is escaped.
+ */
+void esp_br_web_json_write_string(esp_br_web_json_writer_t *writer, const char *key, const char *value);
+
+/**
+ * @brief Write @param size bytes of @param value as a hex string member.
+ */
+void esp_br_web_json_write_hex(esp_br_web_json_writer_t *writer, const char *key, const uint8_t *value,
+                               size_t size);
+
+/**
+ * @brief Write an IPv6 prefix of OT_IP6_PREFIX_SIZE bytes as a "prefix/64" string member.
+ */
+void esp_br_web_json_write_ip6_prefix(esp_br_web_json_writer_t *writer, const char *key, const uint8_t *value);
+
+/**
+ * @brief Check the result of the writes.
+ *
+ * @param[in] writer    The JSON writer.
+ *
+ * @return
+ *      -   ESP_OK                  : On success, the buffer holds a complete JSON text
+ *      -   ESP_ERR_NO_MEM          : The output buffer is too small
+ *      -   ESP_ERR_INVALID_STATE   : The objects are not balanced
+ */
+esp_err_t esp_br_web_json_writer_finish(const esp_br_web_json_writer_t *writer);
+
+/**
+ * @brief Initialize @param reader to parse the JSON text of @param len bytes in @param buf.
+ */
+void esp_br_web_json_reader_init(esp_br_web_json_reader_t *reader, const char *buf, size_t len);
+
+/**
+ * @brief Get the type of the next value without consuming it.
+ */
+esp_br_web_json_type_t esp_br_web_json_peek(esp_br_web_json_reader_t *reader);
+
+/**
+ * @brief Consume the start of an object.
+ *
+ * @return
+ *      -   ESP_OK                  : On success
+ *      -   ESP_ERR_INVALID_ARG     : The next value is not an object or it is nested too deeply
+ */
+esp_err_t esp_br_web_json_read_object_start(esp_br_web_json_reader_t *reader);
+
+/**
+ * @brief Read the key of the next member of the current object, the reader is left at the value of the member.
+ *
+ * A key which does not fit in @param key is read as an empty key, so that the member is skipped as an unknown one.
+ *
+ * @param[in]  reader   The JSON reader.
+ * @param[out] key      The buffer of the key.
+ * @param[in]  size     The size of @param key.
+ *
+ * @return
+ *      -   ESP_OK                  : A member is found
+ *      -   ESP_ERR_NOT_FOUND       : The end of the current object is consumed
+ *      -   ESP_ERR_INVALID_ARG     : Malformed JSON text
+ */
+esp_err_t esp_br_web_json_read_member(esp_br_web_json_reader_t *reader, char *key, size_t size);
+
+/**
+ * @brief Read an unsigned integer in the range [@param min, @param max].
+ */
+esp_err_t esp_br_web_json_read_uint(esp_br_web_json_reader_t *reader, uint64_t min, uint64_t max, uint64_t *value);
+
+/**
+ * @brief Read a boolean.
+ */
+esp_err_t esp_br_web_json_read_bool(esp_br_web_json_reader_t *reader, bool *value);
+
+/**
+ * @brief Read a string into @param buf, ESP_ERR_INVALID_SIZE is returned if it does not fit into @param size bytes
+ *        including the null terminator.
+ */
+esp_err_t esp_br_web_json_read_string(esp_br_web_json_reader_t *reader, char *buf, size_t size);
+
+/**
+ * @brief Read a hex string of exactly @param size bytes into @param buf.
+ */
+esp_err_t esp_br_web_json_read_hex(esp_br_web_json_reader_t *reader, uint8_t *buf, size_t size);
+
+/**
+ * @brief Read an IPv6 prefix string into @param buf of OT_IP6_PREFIX_SIZE bytes.
+ */
+esp_err_t esp_br_web_json_read_ip6_prefix(esp_br_web_json_reader_t *reader, uint8_t *buf);
+
+/**
+ * @brief Read a dataset in hex-encoded TLVs format into @param dataset.
+ *
+ * The components parsed from the TLVs are set, the other components already present in @param dataset are kept,
+ * so that the order of the members decoded into @param dataset does not matter.
+ */
+esp_err_t esp_br_web_json_read_dataset_tlvs(esp_br_web_json_reader_t *reader, otOperationalDataset *dataset);
+
+/**
+ * @brief Skip the next value, including nested objects and arrays.
+ */
+esp_err_t esp_br_web_json_skip_value(esp_br_web_json_reader_t *reader);
+
+/**
+ * @brief Check that nothing but whitespace follows the parsed JSON text.
+ */
+esp_err_t esp_br_web_json_reader_finish(esp_br_web_json_reader_t *reader);
+
+#ifdef __cplusplus
+}
+#endif
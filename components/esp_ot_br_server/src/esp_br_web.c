@@ -7,15 +7,23 @@
 #include "esp_br_web.h"
 #include "cJSON.h"
 #include "esp_br_web_api.h"
+#include "esp_br_web_assets.h"
 #include "esp_br_web_base.h"
+#include "esp_br_web_bench.h"
+#include "esp_br_web_routes.h"
 #include "esp_check.h"
 #include "esp_err.h"
 #include "esp_event.h"
 #include "esp_heap_caps.h"
 #include "esp_http_server.h"
+#include "esp_https_server.h"
 #include "esp_log.h"
 #include "esp_openthread.h"
 #include "esp_openthread_border_router.h"
+#include "esp_ot_boot_timeline.h"
+#if CONFIG_AUTO_UPDATE_RCP || CONFIG_OPENTHREAD_CLI_OTA
+#include "esp_rcp_progress.h"
+#endif
 #include "esp_spiffs.h"
 #include "esp_vfs.h"
 #include "http_parser.h"
@@ -24,6 +32,7 @@
 #include <limits.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "openthread/dataset.h"
 #include "openthread/error.h"
@@ -39,6 +48,8 @@
 #define SERVER_IPV4_LEN 16
 #define FILE_CHUNK_SIZE 1024
 #define WEB_TAG "obtr_web"
+#define WEB_BENCH_DEFAULT_ITERATIONS 100
+#define WEB_QUERY_MAX_SIZE 64
 
 /*-----------------------------------------------------
  Note：Http Server
@@ -63,6 +74,9 @@ typedef struct http_server {
 
 static http_server_t s_server = {NULL, {"", ""}, "", 80}; /* the instance of server */
 
+static const char *s_server_cert = NULL;
+static const char *s_server_key = NULL;
+
 /**
  * @brief The basic parameter definition for parsing url
  */
@@ -79,127 +93,20 @@ typedef struct request_url {
 /*-----------------------------------------------------
  Note：Http Server Thread REST API
 -----------------------------------------------------*/
-static esp_err_t esp_otbr_network_diagnostics_get_handler(httpd_req_t *req);
-static esp_err_t esp_otbr_network_node_get_handler(httpd_req_t *req);
-static esp_err_t esp_otbr_network_node_delete_handler(httpd_req_t *req);
-static esp_err_t esp_otbr_network_node_rloc_get_handler(httpd_req_t *req);
-static esp_err_t esp_otbr_network_node_rloc16_get_handler(httpd_req_t *req);
-static esp_err_t esp_otbr_network_node_state_get_handler(httpd_req_t *req);
-static esp_err_t esp_otbr_network_node_state_put_handler(httpd_req_t *req);
-static esp_err_t esp_otbr_network_node_extaddress_get_handler(httpd_req_t *req);
-static esp_err_t esp_otbr_network_node_network_name_get_handler(httpd_req_t *req);
-static esp_err_t esp_otbr_network_node_leader_data_get_handler(httpd_req_t *req);
-static esp_err_t esp_otbr_network_node_number_of_router_get_handler(httpd_req_t *req);
-static esp_err_t esp_otbr_network_node_extpanid_get_handler(httpd_req_t *req);
-static esp_err_t esp_otbr_network_node_baid_get_handler(httpd_req_t *req);
-static esp_err_t esp_otbr_network_node_dataset_active_handler(httpd_req_t *req);
-static esp_err_t esp_otbr_network_node_dataset_pending_handler(httpd_req_t *req);
+/* The route table of the Thread REST API is generated from openapi.yaml by gen_web_api.py */
+#define ESP_OT_REST_API_HANDLER_DECLARE(_uri, _method, _handler, _scratch) static esp_err_t _handler(httpd_req_t *req);
+#define ESP_OT_REST_API_HANDLER_ENTRY(_uri, _method, _handler, _scratch) \
+    {                                                                   \
+        .uri = _uri,                                                    \
+        .method = _method,                                              \
+        .handler = _handler,                                            \
+        .user_ctx = (_scratch) ? &s_server.data : NULL,                 \
+    },
+
+ESP_BR_WEB_REST_API_ROUTES(ESP_OT_REST_API_HANDLER_DECLARE)
 static esp_err_t esp_otbr_network_node_dataset_handler(httpd_req_t *req, const char *dataset_type);
 
-static httpd_uri_t s_resource_handlers[] = {
-    {
-        .uri = ESP_OT_REST_API_DIAGNOSTICS_PATH,
-        .method = HTTP_GET,
-        .handler = esp_otbr_network_diagnostics_get_handler,
-        .user_ctx = NULL,
-    },
-    {
-        .uri = ESP_OT_REST_API_NODE_PATH,
-        .method = HTTP_GET,
-        .handler = esp_otbr_network_node_get_handler,
-        .user_ctx = NULL,
-    },
-    {
-        .uri = ESP_OT_REST_API_NODE_PATH,
-        .method = HTTP_DELETE,
-        .handler = esp_otbr_network_node_delete_handler,
-        .user_ctx = NULL,
-    },
-    {
-        .uri = ESP_OT_REST_API_NODE_RLOC_PATH,
-        .method = HTTP_GET,
-        .handler = esp_otbr_network_node_rloc_get_handler,
-        .user_ctx = NULL,
-    },
-    {
-        .uri = ESP_OT_REST_API_NODE_RLOC16_PATH,
-        .method = HTTP_GET,
-        .handler = esp_otbr_network_node_rloc16_get_handler,
-        .user_ctx = NULL,
-    },
-    {
-        .uri = ESP_OT_REST_API_NODE_STATE_PATH,
-        .method = HTTP_GET,
-        .handler = esp_otbr_network_node_state_get_handler,
-        .user_ctx = NULL,
-    },
-    {
-        .uri = ESP_OT_REST_API_NODE_STATE_PATH,
-        .method = HTTP_PUT,
-        .handler = esp_otbr_network_node_state_put_handler,
-        .user_ctx = &s_server.data,
-    },
-    {
-        .uri = ESP_OT_REST_API_NODE_EXTADDRESS_PATH,
-        .method = HTTP_GET,
-        .handler = esp_otbr_network_node_extaddress_get_handler,
-        .user_ctx = NULL,
-    },
-    {
-        .uri = ESP_OT_REST_API_NODE_NETWORKNAME_PATH,
-        .method = HTTP_GET,
-        .handler = esp_otbr_network_node_network_name_get_handler,
-        .user_ctx = NULL,
-    },
-    {
-        .uri = ESP_OT_REST_API_NODE_LEADERDATA_PATH,
-        .method = HTTP_GET,
-        .handler = esp_otbr_network_node_leader_data_get_handler,
-        .user_ctx = NULL,
-    },
-    {
-        .uri = ESP_OT_REST_API_NODE_NUMBEROFROUTER_PATH,
-        .method = HTTP_GET,
-        .handler = esp_otbr_network_node_number_of_router_get_handler,
-        .user_ctx = NULL,
-    },
-    {
-        .uri = ESP_OT_REST_API_NODE_EXTPANID_PATH,
-        .method = HTTP_GET,
-        .handler = esp_otbr_network_node_extpanid_get_handler,
-        .user_ctx = NULL,
-    },
-    {
-        .uri = ESP_OT_REST_API_NODE_BORDERAGENTID_PATH,
-        .method = HTTP_GET,
-        .handler = esp_otbr_network_node_baid_get_handler,
-        .user_ctx = NULL,
-    },
-    {
-        .uri = ESP_OT_REST_API_NODE_DATASET_ACTIVE_PATH,
-        .method = HTTP_GET,
-        .handler = esp_otbr_network_node_dataset_active_handler,
-        .user_ctx = NULL,
-    },
-    {
-        .uri = ESP_OT_REST_API_NODE_DATASET_ACTIVE_PATH,
-        .method = HTTP_PUT,
-        .handler = esp_otbr_network_node_dataset_active_handler,
-        .user_ctx = &s_server.data,
-    },
-    {
-        .uri = ESP_OT_REST_API_NODE_DATASET_PENDING_PATH,
-        .method = HTTP_GET,
-        .handler = esp_otbr_network_node_dataset_pending_handler,
-        .user_ctx = NULL,
-    },
-    {
-        .uri = ESP_OT_REST_API_NODE_DATASET_PENDING_PATH,
-        .method = HTTP_PUT,
-        .handler = esp_otbr_network_node_dataset_pending_handler,
-        .user_ctx = &s_server.data,
-    },
-};
+static httpd_uri_t s_resource_handlers[] = {ESP_BR_WEB_REST_API_ROUTES(ESP_OT_REST_API_HANDLER_ENTRY)};
 
 /*-----------------------------------------------------
  Note：Http Server WEB-GUI API
@@ -213,6 +120,13 @@ static esp_err_t esp_otbr_delete_network_prefix_post_handler(httpd_req_t *req);
 static esp_err_t esp_otbr_network_commission_post_handler(httpd_req_t *req);
 static esp_err_t esp_otbr_network_topology_get_handler(httpd_req_t *req);
 static esp_err_t esp_otbr_current_node_get_handler(httpd_req_t *req);
+#if CONFIG_AUTO_UPDATE_RCP || CONFIG_OPENTHREAD_CLI_OTA
+static esp_err_t esp_otbr_ota_progress_get_handler(httpd_req_t *req);
+#endif
+static esp_err_t esp_otbr_boot_timeline_get_handler(httpd_req_t *req);
+#if CONFIG_OPENTHREAD_BR_WEB_BENCH
+static esp_err_t esp_otbr_web_bench_get_handler(httpd_req_t *req);
+#endif
 
 static httpd_uri_t s_web_gui_handlers[] = {
     {
@@ -269,6 +183,28 @@ static httpd_uri_t s_web_gui_handlers[] = {
         .handler = esp_otbr_current_node_get_handler,
         .user_ctx = NULL,
     },
+#if CONFIG_AUTO_UPDATE_RCP || CONFIG_OPENTHREAD_CLI_OTA
+    {
+        .uri = ESP_OT_REST_API_OTA_PROGRESS_PATH,
+        .method = HTTP_GET,
+        .handler = esp_otbr_ota_progress_get_handler,
+        .user_ctx = NULL,
+    },
+#endif
+    {
+        .uri = ESP_OT_REST_API_BOOT_TIMELINE_PATH,
+        .method = HTTP_GET,
+        .handler = esp_otbr_boot_timeline_get_handler,
+        .user_ctx = NULL,
+    },
+#if CONFIG_OPENTHREAD_BR_WEB_BENCH
+    {
+        .uri = ESP_OT_REST_API_WEB_BENCH_PATH,
+        .method = HTTP_GET,
+        .handler = esp_otbr_web_bench_get_handler,
+        .user_ctx = NULL,
+    },
+#endif
 };
 
 /*-----------------------------------------------------
@@ -314,6 +250,20 @@ static esp_err_t httpd_server_register_http_uri(const http_server_t *server, htt
     return ESP_OK;
 }
 
+static esp_err_t httpd_request_read_body(httpd_req_t *req, char *buf, size_t size, size_t *len)
+{
+    size_t cur_len = 0;
+    ESP_RETURN_ON_FALSE(req->content_len < size, ESP_ERR_INVALID_SIZE, WEB_TAG, "The content of packet is too long");
+    while (cur_len < req->content_len) {
+        int received = httpd_req_recv(req, buf + cur_len, req->content_len - cur_len);
+        ESP_RETURN_ON_FALSE(received > 0, ESP_FAIL, WEB_TAG, "Failed to receive the content of packet");
+        cur_len += received;
+    }
+    buf[cur_len] = '\0';
+    *len = cur_len;
+    return ESP_OK;
+}
+
 static cJSON *httpd_request_convert2_json(httpd_req_t *req, int type)
 {
     char *buf = ((http_server_data_t *)(req->user_ctx))->scratch;
@@ -364,18 +314,6 @@ exit:
     return ret;
 }
 
-static esp_err_t httpd_send_plain_text(httpd_req_t *req, char *str)
-{
-    esp_err_t ret = ESP_OK;
-    ESP_RETURN_ON_FALSE(str, ESP_FAIL, WEB_TAG, "Invalid plain text");
-    ESP_LOGD(WEB_TAG, "Properties: %s\r\n", str);
-    ESP_GOTO_ON_ERROR(httpd_resp_set_type(req, ESP_OT_REST_CONTENT_TYPE_PLAIN), exit, WEB_TAG,
-                      "Failed to set http type");
-    ESP_GOTO_ON_ERROR(httpd_resp_sendstr(req, str), exit, WEB_TAG, "Failed to send http respond");
-exit:
-    return ret;
-}
-
 /*-----------------------------------------------------
  Note：Openthread resource API implement
 -----------------------------------------------------*/
@@ -559,73 +497,41 @@ static esp_err_t esp_otbr_network_node_dataset_pending_handler(httpd_req_t *req)
 static esp_err_t esp_otbr_network_node_dataset_handler(httpd_req_t *req, const char *dataset_type)
 {
     esp_err_t ret = ESP_OK;
-    cJSON *request = cJSON_CreateObject();
-    cJSON *response = NULL;
-    cJSON *log = cJSON_CreateObject();
-    cJSON_AddItemToObject(request, ESP_OT_REST_DATASET_TYPE, cJSON_CreateString(dataset_type));
+    char *body = ((http_server_data_t *)(req->user_ctx))->scratch;
     char format[256];
-    uint16_t errcode = 0;
+    char http_return_status[64];
+    uint16_t errcode = 400;
+    bool tlv_format = false;
 
     if (req->method == HTTP_GET) {
-        if (httpd_req_get_hdr_value_str(req, ESP_OT_REST_ACCEPT_HEADER, format, sizeof(format)) == ESP_OK &&
-            strcmp(format, ESP_OT_REST_CONTENT_TYPE_PLAIN) == 0) {
-            cJSON_AddItemToObject(request, ESP_OT_REST_ACCEPT_HEADER,
-                                  cJSON_CreateString(ESP_OT_REST_CONTENT_TYPE_PLAIN));
-        } else {
-            cJSON_AddItemToObject(request, ESP_OT_REST_ACCEPT_HEADER,
-                                  cJSON_CreateString(ESP_OT_REST_CONTENT_TYPE_JSON));
-        }
-        response = handle_ot_resource_node_get_dataset_request(request, log);
+        tlv_format = httpd_req_get_hdr_value_str(req, ESP_OT_REST_ACCEPT_HEADER, format, sizeof(format)) == ESP_OK &&
+                     strcmp(format, ESP_OT_REST_CONTENT_TYPE_PLAIN) == 0;
+        errcode = handle_ot_resource_node_get_dataset_request(dataset_type, tlv_format, body, SCRATCH_BUFSIZE);
     } else if (req->method == HTTP_PUT) {
-        cJSON *value = NULL;
-        if (httpd_req_get_hdr_value_str(req, ESP_OT_REST_CONTENT_TYPE_HEADER, format, sizeof(format)) == ESP_OK &&
-            strcmp(format, ESP_OT_REST_CONTENT_TYPE_PLAIN) == 0) {
-            cJSON_AddItemToObject(request, ESP_OT_REST_CONTENT_TYPE_HEADER,
-                                  cJSON_CreateString(ESP_OT_REST_CONTENT_TYPE_PLAIN));
-            value = httpd_request_convert2_json(req, cJSON_String);
-            if (!cJSON_IsString(value)) {
-                errcode = 400;
-            }
+        size_t len = 0;
+        tlv_format =
+            httpd_req_get_hdr_value_str(req, ESP_OT_REST_CONTENT_TYPE_HEADER, format, sizeof(format)) == ESP_OK &&
+            strcmp(format, ESP_OT_REST_CONTENT_TYPE_PLAIN) == 0;
+        if (httpd_request_read_body(req, body, SCRATCH_BUFSIZE, &len) == ESP_OK) {
+            errcode = handle_ot_resource_node_set_dataset_request(dataset_type, tlv_format, body, len);
         } else {
-            cJSON_AddItemToObject(request, ESP_OT_REST_CONTENT_TYPE_HEADER,
-                                  cJSON_CreateString(ESP_OT_REST_CONTENT_TYPE_JSON));
-            value = httpd_request_convert2_json(req, cJSON_Object);
-            if (!cJSON_IsObject(value)) {
-                errcode = 400;
-            }
-        }
-
-        if (errcode == 0) {
-            cJSON_AddItemToObject(request, "DatasetData", value);
-            handle_ot_resource_node_set_dataset_request(request, log);
-        } else if (errcode == 400) {
             ESP_LOGE(WEB_TAG, "Invalid args");
         }
     }
 
-    cJSON *value = cJSON_GetObjectItemCaseSensitive(log, "ErrorCode");
-    if (cJSON_IsNumber(value)) {
-        errcode = (uint16_t)cJSON_GetNumberValue(value);
-    }
-
-    char http_return_status[64];
     ot_br_web_response_code_get(errcode, http_return_status);
     httpd_resp_set_status(req, http_return_status);
-    if (response) {
-        if (cJSON_IsString(response)) {
-            ESP_GOTO_ON_ERROR(httpd_send_plain_text(req, cJSON_GetStringValue(response)), exit, WEB_TAG,
-                              "Failed to response %s", req->uri);
-        } else {
-            ESP_GOTO_ON_ERROR(httpd_send_packet(req, response), exit, WEB_TAG, "Failed to response %s", req->uri);
-        }
+    if (req->method == HTTP_GET && errcode == 200) {
+        ESP_LOGD(WEB_TAG, "Dataset: %s\r\n", body);
+        ESP_GOTO_ON_ERROR(httpd_resp_set_type(req, tlv_format ? ESP_OT_REST_CONTENT_TYPE_PLAIN
+                                                              : ESP_OT_REST_CONTENT_TYPE_JSON),
+                          exit, WEB_TAG, "Failed to set http type");
+        ESP_GOTO_ON_ERROR(httpd_resp_sendstr(req, body), exit, WEB_TAG, "Failed to response %s", req->uri);
     } else {
         ESP_GOTO_ON_ERROR(httpd_resp_send(req, NULL, 0), exit, WEB_TAG, "Failed to response %s", req->uri);
     }
 
 exit:
-    cJSON_Delete(request);
-    cJSON_Delete(response);
-    cJSON_Delete(log);
     return ret;
 }
 
@@ -904,6 +810,136 @@ exit:
     return ret;
 }
 
+#if CONFIG_AUTO_UPDATE_RCP || CONFIG_OPENTHREAD_CLI_OTA
+/**
+ * @brief Provide the progress of the latest update phase of the Border Router or the RCP.
+ *
+ * @param[in] req The request from http_client.
+ * @return
+ *      -   ESP_OK                      : On success
+ *      -   ESP_ERR_HTTPD_RESP_HDR      : Essential headers are too large for internal buffer
+ *      -   ESP_ERR_HTTPD_RESP_SEND     : Error in raw send
+ *      -   ESP_ERR_HTTPD_INVALID_REQ   : Invalid request
+ *      -   ESP_FAIL                    : Failed to pack the progress
+ */
+static esp_err_t esp_otbr_ota_progress_get_handler(httpd_req_t *req)
+{
+    esp_err_t ret = ESP_OK;
+    esp_rcp_progress_t progress;
+    cJSON *response = cJSON_CreateObject();
+
+    ESP_RETURN_ON_FALSE(response, ESP_FAIL, WEB_TAG, "Failed to pack the update progress");
+    esp_rcp_progress_get_latest(&progress);
+    cJSON_AddItemToObject(response, "Phase", cJSON_CreateString(esp_rcp_progress_phase_to_str(progress.phase)));
+    cJSON_AddItemToObject(response, "State", cJSON_CreateString(esp_rcp_progress_state_to_str(progress.state)));
+    cJSON_AddItemToObject(response, "BytesDone", cJSON_CreateNumber(progress.bytes_done));
+    cJSON_AddItemToObject(response, "BytesTotal", cJSON_CreateNumber(progress.bytes_total));
+    cJSON_AddItemToObject(response, "BytesPerSecond", cJSON_CreateNumber(progress.bytes_per_sec));
+    cJSON_AddItemToObject(response, "ElapsedMs", cJSON_CreateNumber(progress.elapsed_ms));
+    if (progress.eta_ms == ESP_RCP_PROGRESS_ETA_UNKNOWN) {
+        cJSON_AddItemToObject(response, "EtaMs", cJSON_CreateNull());
+    } else {
+        cJSON_AddItemToObject(response, "EtaMs", cJSON_CreateNumber(progress.eta_ms));
+    }
+    ESP_GOTO_ON_ERROR(httpd_send_packet(req, response), exit, WEB_TAG, "Failed to response %s", req->uri);
+exit:
+    cJSON_Delete(response);
+    return ret;
+}
+#endif
+
+/**
+ * @brief Provide the time since power-on at which each boot stage completed, null for the pending stages.
+ *
+ * @param[in] req The request from http_client.
+ * @return
+ *      -   ESP_OK                      : On success
+ *      -   ESP_ERR_HTTPD_RESP_HDR      : Essential headers are too large for internal buffer
+ *      -   ESP_ERR_HTTPD_RESP_SEND     : Error in raw send
+ *      -   ESP_ERR_HTTPD_INVALID_REQ   : Invalid request
+ *      -   ESP_FAIL                    : Failed to pack the boot timeline
+ */
+static esp_err_t esp_otbr_boot_timeline_get_handler(httpd_req_t *req)
+{
+    esp_err_t ret = ESP_OK;
+    cJSON *response = cJSON_CreateArray();
+
+    ESP_RETURN_ON_FALSE(response, ESP_FAIL, WEB_TAG, "Failed to pack the boot timeline");
+    for (int stage = 0; stage < ESP_OT_BOOT_STAGE_MAX; stage++) {
+        int64_t time_us;
+        cJSON *item = cJSON_CreateObject();
+        ESP_GOTO_ON_FALSE(item, ESP_FAIL, exit, WEB_TAG, "Failed to pack the boot timeline");
+        cJSON_AddItemToObject(item, "Stage", cJSON_CreateString(esp_ot_boot_stage_to_str(stage)));
+        if (esp_ot_boot_timeline_get(stage, &time_us) == ESP_OK) {
+            cJSON_AddItemToObject(item, "TimeMs", cJSON_CreateNumber(time_us / 1000));
+        } else {
+            cJSON_AddItemToObject(item, "TimeMs", cJSON_CreateNull());
+        }
+        cJSON_AddItemToArray(response, item);
+    }
+    ESP_GOTO_ON_ERROR(httpd_send_packet(req, response), exit, WEB_TAG, "Failed to response %s", req->uri);
+exit:
+    cJSON_Delete(response);
+    return ret;
+}
+
+#if CONFIG_OPENTHREAD_BR_WEB_BENCH
+/**
+ * @brief Start the micro-benchmark of the JSON converters or provide its state and results.
+ *
+ * The query "run=1" starts a run in the background and responds 202, "iterations=<n>" sets the number of
+ * iterations of every converter and "baseline=save" stores the results as the baseline which the following runs
+ * will be compared against. Without "run=1", the state and the results of the last completed run are provided.
+ *
+ * @param[in] req The request from http_client.
+ * @return
+ *      -   ESP_OK                      : On success
+ *      -   ESP_ERR_HTTPD_RESP_HDR      : Essential headers are too large for internal buffer
+ *      -   ESP_ERR_HTTPD_RESP_SEND     : Error in raw send
+ *      -   ESP_ERR_HTTPD_INVALID_REQ   : Invalid request
+ *      -   ESP_FAIL                    : Failed to pack the results
+ */
+static esp_err_t esp_otbr_web_bench_get_handler(httpd_req_t *req)
+{
+    esp_err_t ret = ESP_OK;
+    char query[WEB_QUERY_MAX_SIZE];
+    char value[16];
+    int iterations = WEB_BENCH_DEFAULT_ITERATIONS;
+    bool save_baseline = false;
+    bool run = false;
+
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        if (httpd_query_key_value(query, "run", value, sizeof(value)) == ESP_OK) {
+            run = (strcmp(value, "1") == 0);
+        }
+        if (httpd_query_key_value(query, "iterations", value, sizeof(value)) == ESP_OK) {
+            iterations = atoi(value);
+        }
+        if (httpd_query_key_value(query, "baseline", value, sizeof(value)) == ESP_OK) {
+            save_baseline = (strcmp(value, "save") == 0);
+        }
+    }
+    if (run) {
+        if (iterations <= 0 || iterations > UINT16_MAX) {
+            return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid iterations");
+        }
+        esp_err_t err = esp_br_web_bench_start((uint16_t)iterations, save_baseline);
+        if (err == ESP_ERR_INVALID_STATE) {
+            httpd_resp_set_status(req, HTTPD_409);
+            return httpd_resp_send(req, NULL, 0);
+        }
+        ESP_RETURN_ON_ERROR(err, WEB_TAG, "Failed to start the converter benchmark");
+        httpd_resp_set_status(req, HTTPD_202);
+    }
+    cJSON *response = esp_br_web_bench_get_report();
+    ESP_RETURN_ON_FALSE(response, ESP_FAIL, WEB_TAG, "Failed to pack the converter benchmark results");
+    ESP_GOTO_ON_ERROR(httpd_send_packet(req, response), exit, WEB_TAG, "Failed to response %s", req->uri);
+exit:
+    cJSON_Delete(response);
+    return ret;
+}
+#endif
+
 /*-----------------------------------------------------
  Note：Handling for Client request
 -----------------------------------------------------*/
@@ -963,39 +999,67 @@ static esp_err_t favicon_get_handler(httpd_req_t *req)
     return ESP_OK;
 }
 
+#if CONFIG_OPENTHREAD_BR_WEB_ASSETS_MMAP
 /**
- * @brief Provide a method to send message to @param req client accord to @param path.
+ * @brief Send the asset of @param info from the memory-mapped web assets image.
+ *
+ * The asset is sent straight from the mapped flash with its exact length, no copy is made.
  *
  * @param[in] req  The request from the client
- * @param[in] path The path of file which will be sent.
+ * @param[in] info The parsed request url.
  * @return
- *      -   ESP_OK: on success
- *      -   ESP_FAIL: on failure
+ *      -   ESP_OK: on success, a 404 response is sent if the asset does not exist
+ *      -   Others: on failure
  */
-static esp_err_t httpd_resp_send_spiffs_file(httpd_req_t *req, char *path)
+static esp_err_t httpd_resp_send_web_file(httpd_req_t *req, const reqeust_url_t *info)
 {
-    ESP_LOGI(WEB_TAG, "-------------------------------------------");
-    ESP_LOGI(WEB_TAG, "Reading %s", path);
+    const char *data = NULL;
+    size_t size = 0;
 
-    FILE *fp = fopen(path, "r"); // Open and read file
+    if (esp_br_web_assets_find(info->file_name, &data, &size) != ESP_OK) {
+        ESP_LOGE(WEB_TAG, "Failed to find web asset : %s", info->file_name);
+        return NOT_FOUND_handler(req);
+    }
+    return httpd_resp_send(req, data, size);
+}
+#else
+/**
+ * @brief Send the file of @param info from the SPIFFS mounted at the base path in chunks.
+ *
+ * @param[in] req  The request from the client
+ * @param[in] info The parsed request url.
+ * @return
+ *      -   ESP_OK: on success, a 404 response is sent if the file cannot be opened
+ *      -   ESP_FAIL: on failure
+ */
+static esp_err_t httpd_resp_send_web_file(httpd_req_t *req, const reqeust_url_t *info)
+{
+    esp_err_t ret = ESP_OK;
+    char buf[FILE_CHUNK_SIZE];
+    size_t len = 0;
+    FILE *fp = fopen(info->file_path, "rb");
 
-    ESP_RETURN_ON_FALSE(fp, ESP_FAIL, WEB_TAG, "Failed to open %s file", path);
+    if (!fp) {
+        ESP_LOGE(WEB_TAG, "Failed to open %s file", info->file_path);
+        return NOT_FOUND_handler(req);
+    }
+    while ((len = fread(buf, 1, sizeof(buf), fp)) > 0) {
+        ESP_GOTO_ON_ERROR(httpd_resp_send_chunk(req, buf, len), exit, WEB_TAG, "Failed to send http chunk");
+    }
+    ESP_GOTO_ON_FALSE(!ferror(fp), ESP_FAIL, exit, WEB_TAG, "Failed to read %s file", info->file_path);
+    ESP_GOTO_ON_ERROR(httpd_resp_send_chunk(req, NULL, 0), exit, WEB_TAG, "Failed to send http chunk");
 
-    char buf[FILE_CHUNK_SIZE]; // the size of chunk
-    while (!feof(fp) && !ferror(fp)) {
-        fread(buf, FILE_CHUNK_SIZE - 1, 1, fp);
-        buf[FILE_CHUNK_SIZE - 1] = '\0';
-        httpd_resp_sendstr_chunk(req, buf);
-        memset(buf, 0, sizeof(buf));
-    };
-    return fclose(fp) == 0 ? ESP_OK : ESP_FAIL;
+exit:
+    fclose(fp);
+    return ret;
 }
+#endif
 
 /**
  * @brief Provide the index.html for GUI,when the client login the web.
  *
  * @param[in] req is the request from client's browser.
- * @param[in] path points to the index.hrml path.
+ * @param[in] info is the parsed url of the index.html.
  * @return
  *      -   ESP_OK : On success
  *      -   ESP_ERR_INVALID_ARG : Null request pointer
@@ -1003,29 +1067,26 @@ static esp_err_t httpd_resp_send_spiffs_file(httpd_req_t *req, char *path)
  *      -   ESP_ERR_HTTPD_RESP_SEND   : Error in raw send
  *      -   ESP_ERR_HTTPD_INVALID_REQ : Invalid request
  */
-static esp_err_t index_html_get_handler(httpd_req_t *req, char *path)
+static esp_err_t index_html_get_handler(httpd_req_t *req, const reqeust_url_t *info)
 {
-    ESP_RETURN_ON_ERROR(httpd_resp_send_spiffs_file(req, path), WEB_TAG, "Failed to send index html file");
-    ESP_RETURN_ON_ERROR(httpd_resp_sendstr_chunk(req, NULL), WEB_TAG, "Failed to send http string chunk");
+    ESP_RETURN_ON_ERROR(httpd_resp_send_web_file(req, info), WEB_TAG, "Failed to send index html file");
     return ESP_OK;
 }
 
-static esp_err_t style_css_get_handler(httpd_req_t *req, char *path)
+static esp_err_t style_css_get_handler(httpd_req_t *req, const reqeust_url_t *info)
 {
     // send content-type："text/css" in http-header
     ESP_RETURN_ON_ERROR(httpd_resp_set_type(req, "text/css"), WEB_TAG, "Failed to set http text/css type");
-    ESP_RETURN_ON_ERROR(httpd_resp_send_spiffs_file(req, path), WEB_TAG, "Failed to send css file");
-    ESP_RETURN_ON_ERROR(httpd_resp_sendstr_chunk(req, NULL), WEB_TAG, "Failed to send http string chunk");
+    ESP_RETURN_ON_ERROR(httpd_resp_send_web_file(req, info), WEB_TAG, "Failed to send css file");
     return ESP_OK;
 }
 
-static esp_err_t script_js_get_handler(httpd_req_t *req, char *path)
+static esp_err_t script_js_get_handler(httpd_req_t *req, const reqeust_url_t *info)
 {
     // send content-type："application/javascript" in http-header
     ESP_RETURN_ON_ERROR(httpd_resp_set_type(req, "application/javascript"), WEB_TAG,
                         "Failed to set http application/javascript type");
-    ESP_RETURN_ON_ERROR(httpd_resp_send_spiffs_file(req, path), WEB_TAG, "Failed to send js file");
-    ESP_RETURN_ON_ERROR(httpd_resp_sendstr_chunk(req, NULL), WEB_TAG, "Failed to send http string chunk");
+    ESP_RETURN_ON_ERROR(httpd_resp_send_web_file(req, info), WEB_TAG, "Failed to send js file");
     return ESP_OK;
 }
 
@@ -1089,13 +1150,13 @@ static esp_err_t default_urls_get_handler(httpd_req_t *req)
     if (strcmp(info.file_name, "/") == 0) {
         return blank_html_get_handler(req);
     } else if (strcmp(info.file_name, "/index.html") == 0) {
-        return index_html_get_handler(req, info.file_path);
+        return index_html_get_handler(req, &info);
     } else if (strcmp(info.file_name, "/static/style.css") == 0) {
-        return style_css_get_handler(req, info.file_path);
+        return style_css_get_handler(req, &info);
     } else if (strcmp(info.file_name, "/static/restful.js") == 0) {
-        return script_js_get_handler(req, info.file_path);
+        return script_js_get_handler(req, &info);
     } else if (strcmp(info.file_name, "/static/bootstrap.min.css") == 0) {
-        return script_js_get_handler(req, info.file_path);
+        return script_js_get_handler(req, &info);
     } else if (strcmp(info.file_name, "/favicon.ico") == 0) {
         return favicon_get_handler(req);
     } else {
@@ -1120,6 +1181,27 @@ static void ot_web_json_free(void *ptr)
 /*-----------------------------------------------------
  Note：Server Start
 -----------------------------------------------------*/
+#if !CONFIG_OPENTHREAD_BR_WEB_ASSETS_MMAP
+/**
+ * @brief Mount the "web_storage" partition at @param base_path unless the application has mounted it.
+ *
+ * The partition is only mounted once the server starts, so mounting it does not delay the boot.
+ */
+static esp_err_t mount_web_storage(const char *base_path)
+{
+    if (esp_spiffs_mounted("web_storage")) {
+        return ESP_OK;
+    }
+    esp_vfs_spiffs_conf_t conf = {
+        .base_path = base_path,
+        .partition_label = "web_storage",
+        .max_files = 10,
+        .format_if_mount_failed = false,
+    };
+    return esp_vfs_spiffs_register(&conf);
+}
+#endif
+
 /**
  * @brief Create an HTTP server and register an accessible URI
  *
@@ -1142,29 +1224,80 @@ static httpd_handle_t *start_esp_br_http_server(const char *base_path, const cha
 
     strcpy(s_server.ip, host_ip);
     strlcpy(s_server.data.base_path, base_path, ESP_VFS_PATH_MAX + 1);
+    // The REST API does not need the Web GUI files, the server is started without them and the files get a 404,
+    // e.g. when the partition still holds the image of the other format after an OTA update.
+#if CONFIG_OPENTHREAD_BR_WEB_ASSETS_MMAP
+    if (esp_br_web_assets_init("web_storage") != ESP_OK) {
+        ESP_LOGW(WEB_TAG, "Failed to map web assets, the Web GUI is not served");
+    }
+#else
+    if (mount_web_storage(base_path) != ESP_OK) {
+        ESP_LOGW(WEB_TAG, "Failed to mount web assets, the Web GUI is not served");
+    }
+#endif
 
-    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
-    config.max_uri_handlers = (sizeof(s_resource_handlers) + sizeof(s_web_gui_handlers)) / sizeof(httpd_uri_t) + 2;
-    config.max_resp_headers = (sizeof(s_resource_handlers) + sizeof(s_web_gui_handlers)) / sizeof(httpd_uri_t) + 2;
-    config.uri_match_fn = httpd_uri_match_wildcard;
-    config.stack_size = 8 * 1024;
-    s_server.port = config.server_port;
+#if CONFIG_OPENTHREAD_BR_WEB_HTTPS
+    ESP_RETURN_ON_FALSE(s_server_cert && s_server_key, NULL, WEB_TAG, "The server certificate is not set");
+    httpd_ssl_config_t ssl_config = HTTPD_SSL_CONFIG_DEFAULT();
+    ssl_config.servercert = (const uint8_t *)s_server_cert;
+    ssl_config.servercert_len = strlen(s_server_cert) + 1;
+    ssl_config.prvtkey_pem = (const uint8_t *)s_server_key;
+    ssl_config.prvtkey_len = strlen(s_server_key) + 1;
+    ssl_config.port_secure = CONFIG_OPENTHREAD_BR_WEB_HTTPS_PORT;
+    // Stateless tickets only, esp_https_server cannot install a session ID cache on the TLS configuration.
+    ssl_config.session_tickets = true;
+    httpd_config_t *config = &ssl_config.httpd;
+#else
+    httpd_config_t http_config = HTTPD_DEFAULT_CONFIG();
+    httpd_config_t *config = &http_config;
+#endif
+    config->max_uri_handlers = (sizeof(s_resource_handlers) + sizeof(s_web_gui_handlers)) / sizeof(httpd_uri_t) + 2;
+    config->max_resp_headers = (sizeof(s_resource_handlers) + sizeof(s_web_gui_handlers)) / sizeof(httpd_uri_t) + 2;
+    config->uri_match_fn = httpd_uri_match_wildcard;
+    config->stack_size = 8 * 1024;
+#if CONFIG_OPENTHREAD_BR_WEB_HTTPS
+    // Keep idle TLS sessions open for reuse, and recycle the least recently used one when the limit is reached.
+    config->max_open_sockets = CONFIG_OPENTHREAD_BR_WEB_MAX_SESSIONS;
+    config->lru_purge_enable = true;
+    config->keep_alive_enable = true;
+#endif
 
     // start http_server
-    ESP_RETURN_ON_FALSE(!httpd_start(&s_server.handle, &config), NULL, WEB_TAG, "Failed to start web server");
+#if CONFIG_OPENTHREAD_BR_WEB_HTTPS
+    s_server.port = ssl_config.port_secure;
+    ESP_RETURN_ON_FALSE(!httpd_ssl_start(&s_server.handle, &ssl_config), NULL, WEB_TAG, "Failed to start web server");
+#else
+    s_server.port = config->server_port;
+    ESP_RETURN_ON_FALSE(!httpd_start(&s_server.handle, config), NULL, WEB_TAG, "Failed to start web server");
+#endif
 
     httpd_uri_t default_uris_get = {.uri = "/*", // Match all URIs of type /path/to/file
                                     .method = HTTP_GET,
                                     .handler = default_urls_get_handler,
                                     .user_ctx = &s_server.data};
 
-    httpd_server_register_http_uri(&s_server, s_resource_handlers, sizeof(s_resource_handlers) / sizeof(httpd_uri_t));
-    httpd_server_register_http_uri(&s_server, s_web_gui_handlers, sizeof(s_web_gui_handlers) / sizeof(httpd_uri_t));
-    httpd_register_uri_handler(s_server.handle, &default_uris_get);
+    // Do not serve with a part of the routes missing, a request to a missing route would get the file handler.
+    if (httpd_server_register_http_uri(&s_server, s_resource_handlers,
+                                       sizeof(s_resource_handlers) / sizeof(httpd_uri_t)) != ESP_OK ||
+        httpd_server_register_http_uri(&s_server, s_web_gui_handlers,
+                                       sizeof(s_web_gui_handlers) / sizeof(httpd_uri_t)) != ESP_OK ||
+        httpd_server_register_http_uri(&s_server, &default_uris_get, 1) != ESP_OK) {
+#if CONFIG_OPENTHREAD_BR_WEB_HTTPS
+        httpd_ssl_stop(s_server.handle);
+#else
+        httpd_stop(s_server.handle);
+#endif
+        s_server.handle = NULL;
+        return NULL;
+    }
 
     // Show the login address in the console
     ESP_LOGI(WEB_TAG, "%s\r\n", "<=======================server start========================>");
+#if CONFIG_OPENTHREAD_BR_WEB_HTTPS
+    ESP_LOGI(WEB_TAG, "https://%s:%d/index.html\r\n", s_server.ip, s_server.port);
+#else
     ESP_LOGI(WEB_TAG, "http://%s:%d/index.html\r\n", s_server.ip, s_server.port);
+#endif
     ESP_LOGI(WEB_TAG, "%s\r\n", "<===========================================================>");
 
     return s_server.handle;
@@ -1183,7 +1316,11 @@ void connect_handler(void *arg, esp_event_base_t event_base, int32_t event_id, v
 -----------------------------------------------------*/
 void stop_httpserver(httpd_handle_t server)
 {
+#if CONFIG_OPENTHREAD_BR_WEB_HTTPS
+    httpd_ssl_stop(server); // Stop the https server
+#else
     httpd_stop(server); // Stop the httpd server
+#endif
 }
 
 void disconnect_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data)
@@ -1217,6 +1354,12 @@ static void handler_got_ip_event(void *arg, esp_event_base_t event_base, int32_t
     }
 }
 
+void esp_br_web_set_server_cert(const char *cert, const char *key)
+{
+    s_server_cert = cert;
+    s_server_key = key;
+}
+
 void esp_br_web_start(char *base_path)
 {
     ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &handler_got_ip_event, base_path));
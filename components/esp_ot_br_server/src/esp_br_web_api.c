@@ -7,6 +7,8 @@
 #include "esp_br_web_api.h"
 #include "cJSON.h"
 #include "esp_br_web_base.h"
+#include "esp_br_web_json.h"
+#include "esp_br_web_schemas.h"
 #include "esp_check.h"
 #include "esp_err.h"
 #include "esp_log.h"
@@ -204,78 +206,66 @@ cJSON *handle_ot_resource_node_baid_request()
     return cJSON_CreateString(format);
 }
 
-cJSON *handle_ot_resource_node_get_dataset_request(const cJSON *request, cJSON *log)
+uint16_t handle_ot_resource_node_get_dataset_request(const char *dataset_type, bool tlv_format, char *buf, size_t size)
 {
     uint16_t errcode = 200;
-    cJSON *response = NULL;
-    char format[255] = "";
     otOperationalDataset dataset;
     otOperationalDatasetTlvs datasetTlvs;
     otError ret = OT_ERROR_NONE;
-    const char *accept_format =
-        cJSON_GetStringValue(cJSON_GetObjectItemCaseSensitive(request, ESP_OT_REST_ACCEPT_HEADER));
-    const char *dataset_type =
-        cJSON_GetStringValue(cJSON_GetObjectItemCaseSensitive(request, ESP_OT_REST_DATASET_TYPE));
+    bool active = (strcmp(dataset_type, ESP_OT_DATASET_TYPE_ACTIVE) == 0);
 
     esp_openthread_lock_acquire(portMAX_DELAY);
     otInstance *ins = esp_openthread_get_instance();
-    if (strcmp(accept_format, ESP_OT_REST_CONTENT_TYPE_PLAIN) == 0) {
-        if (strcmp(dataset_type, ESP_OT_DATASET_TYPE_ACTIVE) == 0) {
-            ERROR_EXIT(otDatasetGetActiveTlvs(ins, &datasetTlvs), exit, API_TAG,
-                       "Failed to get Thread active dataset tlv");
-        } else if (strcmp(dataset_type, ESP_OT_DATASET_TYPE_PENDING) == 0) {
-            ERROR_EXIT(otDatasetGetPendingTlvs(ins, &datasetTlvs), exit, API_TAG,
-                       "Failed to get Thread pending dataset tlv");
-        } else {
-            ESP_GOTO_ON_FALSE(false, OT_ERROR_FAILED, exit, API_TAG, "Invalid DatasetTlv Type");
-        }
-        ESP_GOTO_ON_FALSE(sizeof(format) >= (datasetTlvs.mLength * 2), OT_ERROR_FAILED, exit, API_TAG, "Invalid Size");
-        ESP_GOTO_ON_FALSE(hex_to_string(datasetTlvs.mTlvs, format, datasetTlvs.mLength) == ESP_OK, OT_ERROR_FAILED,
-                          exit, API_TAG, "Failed to convert Thread dataset tlv");
-        response = cJSON_CreateString(format);
+    if (tlv_format) {
+        ERROR_EXIT(active ? otDatasetGetActiveTlvs(ins, &datasetTlvs) : otDatasetGetPendingTlvs(ins, &datasetTlvs),
+                   exit, API_TAG, "Failed to get Thread %s dataset tlv", dataset_type);
     } else {
-        if (strcmp(dataset_type, ESP_OT_DATASET_TYPE_ACTIVE) == 0) {
-            ERROR_EXIT(otDatasetGetActive(ins, &dataset), exit, API_TAG, "Failed to get Thread active dataset");
-            response = ActiveDataset2Json(dataset);
-        } else if (strcmp(dataset_type, ESP_OT_DATASET_TYPE_PENDING) == 0) {
-            ERROR_EXIT(otDatasetGetPending(ins, &dataset), exit, API_TAG, "Failed to get Thread pending dataset");
-            response = PendingDataset2Json(dataset);
-        } else {
-            ESP_GOTO_ON_FALSE(false, OT_ERROR_FAILED, exit, API_TAG, "Invalid Dataset Type");
-        }
+        ERROR_EXIT(active ? otDatasetGetActive(ins, &dataset) : otDatasetGetPending(ins, &dataset), exit, API_TAG,
+                   "Failed to get Thread %s dataset", dataset_type);
     }
 exit:
     esp_openthread_lock_release();
     if (ret != OT_ERROR_NONE) {
-        errcode = 204;
+        return 204;
+    }
+
+    if (tlv_format) {
+        ESP_RETURN_ON_FALSE(size > datasetTlvs.mLength * 2, 500, API_TAG, "Invalid Size");
+        ESP_RETURN_ON_FALSE(hex_to_string(datasetTlvs.mTlvs, buf, datasetTlvs.mLength) == ESP_OK, 500, API_TAG,
+                            "Failed to convert Thread dataset tlv");
+    } else {
+        esp_br_web_json_writer_t writer;
+        esp_br_web_json_writer_init(&writer, buf, size);
+        if (active) {
+            esp_br_web_encode_ActiveDataset(&writer, NULL, &dataset);
+        } else {
+            esp_br_web_encode_PendingDataset(&writer, NULL, &dataset);
+        }
+        ESP_RETURN_ON_FALSE(esp_br_web_json_writer_finish(&writer) == ESP_OK, 500, API_TAG,
+                            "Failed to encode Thread dataset");
     }
-    cJSON_AddItemToObject(log, "ErrorCode", cJSON_CreateNumber(errcode));
-    return response;
+    return errcode;
 }
 
-void handle_ot_resource_node_set_dataset_request(const cJSON *request, cJSON *log)
+uint16_t handle_ot_resource_node_set_dataset_request(const char *dataset_type, bool tlv_format, char *body,
+                                                     size_t len)
 {
     uint16_t errcode = 200;
     otOperationalDataset dataset;
     otOperationalDatasetTlvs datasetTlvs;
     otOperationalDatasetTlvs datasetUpdateTlvs;
     otError ret = OT_ERROR_NONE;
-    const char *content_format =
-        cJSON_GetStringValue(cJSON_GetObjectItemCaseSensitive(request, ESP_OT_REST_CONTENT_TYPE_HEADER));
-    const char *dataset_type =
-        cJSON_GetStringValue(cJSON_GetObjectItemCaseSensitive(request, ESP_OT_REST_DATASET_TYPE));
+    bool active = (strcmp(dataset_type, ESP_OT_DATASET_TYPE_ACTIVE) == 0);
 
     esp_openthread_lock_acquire(portMAX_DELAY);
     otInstance *ins = esp_openthread_get_instance();
 
-    if (strcmp(dataset_type, ESP_OT_DATASET_TYPE_ACTIVE) == 0) {
+    if (active) {
         ESP_GOTO_ON_FALSE(otThreadGetDeviceRole(ins) == OT_DEVICE_ROLE_DISABLED, OT_ERROR_INVALID_STATE, exit, API_TAG,
                           "Invalid State");
         ret = otDatasetGetActiveTlvs(ins, &datasetTlvs);
-    } else if (strcmp(dataset_type, ESP_OT_DATASET_TYPE_PENDING) == 0) {
-        ret = otDatasetGetPendingTlvs(ins, &datasetTlvs);
     } else {
-        ESP_GOTO_ON_FALSE(false, OT_ERROR_FAILED, exit, API_TAG, "Invalid Dataset Type");
+        ret = otDatasetGetPendingTlvs(ins, &datasetTlvs);
     }
 
     if (ret == OT_ERROR_NOT_FOUND) {
@@ -286,37 +276,28 @@ void handle_ot_resource_node_set_dataset_request(const cJSON *request, cJSON *lo
         ret = OT_ERROR_NONE;
     }
 
-    bool isTlv = (strcmp(content_format, ESP_OT_REST_CONTENT_TYPE_PLAIN) == 0);
-
-    if (isTlv) {
-        char *datasetTlvsStr = cJSON_GetStringValue(cJSON_GetObjectItemCaseSensitive(request, "DatasetData"));
-        ESP_GOTO_ON_FALSE(datasetTlvsStr && strlen(datasetTlvsStr) <= OT_OPERATIONAL_DATASET_MAX_LENGTH * 2,
-                          OT_ERROR_INVALID_ARGS, exit, API_TAG, "Invalid DatasetTlvs");
-        ESP_GOTO_ON_FALSE(string_to_hex(datasetTlvsStr, datasetUpdateTlvs.mTlvs, strlen(datasetTlvsStr) / 2) == ESP_OK,
-                          OT_ERROR_INVALID_ARGS, exit, API_TAG, "Invalid DatasetTlvs");
-        datasetUpdateTlvs.mLength = strlen(datasetTlvsStr) / 2;
+    if (tlv_format) {
+        ESP_GOTO_ON_FALSE(len <= OT_OPERATIONAL_DATASET_MAX_LENGTH * 2 && len % 2 == 0, OT_ERROR_INVALID_ARGS, exit,
+                          API_TAG, "Invalid DatasetTlvs");
+        ESP_GOTO_ON_FALSE(string_to_hex(body, datasetUpdateTlvs.mTlvs, len / 2) == ESP_OK, OT_ERROR_INVALID_ARGS, exit,
+                          API_TAG, "Invalid DatasetTlvs");
+        datasetUpdateTlvs.mLength = len / 2;
         ERROR_EXIT(otDatasetParseTlvs(&datasetUpdateTlvs, &dataset), exit, API_TAG, "Invalid DatasetTlvs");
-        ERROR_EXIT(otDatasetUpdateTlvs(&dataset, &datasetTlvs), exit, API_TAG, "Cannot update DatasetTlvs");
     } else {
-        cJSON *datasetJson = cJSON_GetObjectItemCaseSensitive(request, "DatasetData");
-        if (strcmp(dataset_type, ESP_OT_DATASET_TYPE_ACTIVE) == 0) {
-            ESP_GOTO_ON_FALSE(Json2ActiveDataset(datasetJson, &dataset) == ESP_OK, OT_ERROR_INVALID_ARGS, exit, API_TAG,
-                              "Invalid Active Dataset");
-        } else if (strcmp(dataset_type, ESP_OT_DATASET_TYPE_PENDING) == 0) {
-            ESP_GOTO_ON_FALSE(Json2PendingDataset(datasetJson, &dataset) == ESP_OK, OT_ERROR_INVALID_ARGS, exit,
-                              API_TAG, "Invalid Pending Dataset");
-        } else {
-            ESP_GOTO_ON_FALSE(false, OT_ERROR_FAILED, exit, API_TAG, "Invalid Dataset Type");
-        }
-        ERROR_EXIT(otDatasetUpdateTlvs(&dataset, &datasetTlvs), exit, API_TAG, "Cannot update DatasetTlvs");
+        esp_br_web_json_reader_t reader;
+        memset(&dataset, 0, sizeof(dataset));
+        esp_br_web_json_reader_init(&reader, body, len);
+        ESP_GOTO_ON_FALSE((active ? esp_br_web_decode_ActiveDataset(&reader, &dataset)
+                                  : esp_br_web_decode_PendingDataset(&reader, &dataset)) == ESP_OK &&
+                              esp_br_web_json_reader_finish(&reader) == ESP_OK,
+                          OT_ERROR_INVALID_ARGS, exit, API_TAG, "Invalid %s dataset", dataset_type);
     }
+    ERROR_EXIT(otDatasetUpdateTlvs(&dataset, &datasetTlvs), exit, API_TAG, "Cannot update DatasetTlvs");
 
-    if (strcmp(dataset_type, ESP_OT_DATASET_TYPE_ACTIVE) == 0) {
+    if (active) {
         ERROR_EXIT(otDatasetSetActiveTlvs(ins, &datasetTlvs), exit, API_TAG, "Cannot set Active DatasetTlvs");
-    } else if (strcmp(dataset_type, ESP_OT_DATASET_TYPE_PENDING) == 0) {
-        ERROR_EXIT(otDatasetSetPendingTlvs(ins, &datasetTlvs), exit, API_TAG, "Cannot set Pending DatasetTlvs");
     } else {
-        ESP_GOTO_ON_FALSE(false, OT_ERROR_FAILED, exit, API_TAG, "Invalid Dataset Type");
+        ERROR_EXIT(otDatasetSetPendingTlvs(ins, &datasetTlvs), exit, API_TAG, "Cannot set Pending DatasetTlvs");
     }
 
 exit:
@@ -335,7 +316,7 @@ exit:
             break;
         }
     }
-    cJSON_AddItemToObject(log, "ErrorCode", cJSON_CreateNumber(errcode));
+    return errcode;
 }
 
 /*----------------------------------------------------------------------
@@ -0,0 +1,94 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "esp_br_web_assets.h"
+#include "esp_check.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include <inttypes.h>
+#include <stdint.h>
+#include <string.h>
+
+#define ASSETS_TAG "web_assets"
+#define WEB_ASSETS_MAGIC 0x4157544f /* 'OTWA' */
+#define WEB_ASSETS_VERSION 1
+#define WEB_ASSETS_PATH_SIZE 56
+
+/* The layout shall be kept in sync with pack_web_assets.py */
+typedef struct web_assets_header {
+    uint32_t magic;       /* WEB_ASSETS_MAGIC */
+    uint16_t version;     /* WEB_ASSETS_VERSION */
+    uint16_t asset_count; /* the number of entries following the header */
+    uint32_t image_size;  /* the size of the whole image */
+} __attribute__((packed)) web_assets_header_t;
+
+typedef struct web_assets_entry {
+    char path[WEB_ASSETS_PATH_SIZE]; /* the null-terminated request path */
+    uint32_t offset;                 /* the offset of the content from the start of the image */
+    uint32_t size;                   /* the size of the content */
+} __attribute__((packed)) web_assets_entry_t;
+
+static const char *s_image = NULL;
+
+esp_err_t esp_br_web_assets_init(const char *label)
+{
+    esp_err_t ret = ESP_OK;
+    const void *image = NULL;
+    esp_partition_mmap_handle_t handle;
+
+    ESP_RETURN_ON_FALSE(label, ESP_ERR_INVALID_ARG, ASSETS_TAG, "Invalid partition label");
+    if (s_image) {
+        return ESP_OK;
+    }
+    const esp_partition_t *partition =
+        esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    ESP_RETURN_ON_FALSE(partition, ESP_ERR_NOT_FOUND, ASSETS_TAG, "Failed to find partition %s", label);
+    ESP_RETURN_ON_ERROR(esp_partition_mmap(partition, 0, partition->size, ESP_PARTITION_MMAP_DATA, &image, &handle),
+                        ASSETS_TAG, "Failed to map partition %s", label);
+
+    const web_assets_header_t *header = (const web_assets_header_t *)image;
+    ESP_GOTO_ON_FALSE(partition->size >= sizeof(web_assets_header_t) && header->magic == WEB_ASSETS_MAGIC &&
+                          header->version == WEB_ASSETS_VERSION,
+                      ESP_ERR_INVALID_VERSION, exit, ASSETS_TAG, "No web assets image in partition %s", label);
+    ESP_GOTO_ON_FALSE(header->image_size <= partition->size &&
+                          sizeof(web_assets_header_t) + header->asset_count * sizeof(web_assets_entry_t) <=
+                              header->image_size,
+                      ESP_ERR_INVALID_SIZE, exit, ASSETS_TAG, "Invalid web assets image size");
+
+    const web_assets_entry_t *entries = (const web_assets_entry_t *)(header + 1);
+    for (uint16_t i = 0; i < header->asset_count; i++) {
+        ESP_GOTO_ON_FALSE(memchr(entries[i].path, '\0', WEB_ASSETS_PATH_SIZE) &&
+                              entries[i].offset <= header->image_size &&
+                              entries[i].size <= header->image_size - entries[i].offset,
+                          ESP_ERR_INVALID_SIZE, exit, ASSETS_TAG, "Invalid web asset entry %u", i);
+    }
+    s_image = (const char *)image;
+    ESP_LOGI(ASSETS_TAG, "Mapped %u web assets of %" PRIu32 " bytes", header->asset_count, header->image_size);
+
+exit:
+    if (ret != ESP_OK) {
+        esp_partition_munmap(handle);
+    }
+    return ret;
+}
+
+esp_err_t esp_br_web_assets_find(const char *path, const char **data, size_t *size)
+{
+    ESP_RETURN_ON_FALSE(path && data && size, ESP_ERR_INVALID_ARG, ASSETS_TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(s_image, ESP_ERR_INVALID_STATE, ASSETS_TAG, "The web assets are not mapped");
+
+    const web_assets_header_t *header = (const web_assets_header_t *)s_image;
+    const web_assets_entry_t *entries = (const web_assets_entry_t *)(header + 1);
+    for (uint16_t i = 0; i < header->asset_count; i++) {
+        if (strcmp(entries[i].path, path) == 0) {
+            *data = s_image + entries[i].offset;
+            *size = entries[i].size;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
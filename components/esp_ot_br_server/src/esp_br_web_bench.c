@@ -0,0 +1,527 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "esp_br_web_bench.h"
+#include "esp_br_web_base.h"
+#include "esp_br_web_json.h"
+#include "esp_br_web_schemas.h"
+#include "esp_attr.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "nvs.h"
+#include "sdkconfig.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "openthread/dataset.h"
+#include "openthread/netdiag.h"
+#include "openthread/thread.h"
+
+#if CONFIG_OPENTHREAD_BR_WEB_BENCH
+
+#define BENCH_TAG "web_bench"
+#define BENCH_NVS_NAMESPACE "web_bench"
+#define BENCH_ROUTE_NUM 16
+#define BENCH_IP6_ADDRESS_NUM 6
+#define BENCH_CHILD_NUM 10
+#define BENCH_JSON_TEXT_SIZE 1024
+#define BENCH_DIAG_SET_NUM 3
+#define BENCH_TASK_STACK_SIZE 6144
+#define BENCH_TASK_PRIORITY 1 /* below the web server, so a run does not delay the requests */
+
+typedef struct web_bench_result {
+    uint32_t ns_per_op;
+    uint32_t allocs_per_op;
+    uint32_t bytes_per_op;
+} web_bench_result_t;
+
+typedef enum web_bench_state {
+    WEB_BENCH_STATE_IDLE,
+    WEB_BENCH_STATE_RUNNING,
+    WEB_BENCH_STATE_DONE,
+    WEB_BENCH_STATE_FAILED,
+} web_bench_state_t;
+
+typedef struct web_bench_request {
+    uint16_t iterations;
+    bool save_baseline;
+} web_bench_request_t;
+
+/* The converter output is returned through @param output, it is released by the runner. */
+typedef esp_err_t (*web_bench_convert_fn_t)(void *ctx, cJSON **output);
+
+static const uint16_t s_diag_set_node_num[BENCH_DIAG_SET_NUM] = {50, 150, 300};
+static char s_encoded_text[BENCH_JSON_TEXT_SIZE];
+static char s_dataset_text[BENCH_JSON_TEXT_SIZE];
+static char s_pending_dataset_text[BENCH_JSON_TEXT_SIZE];
+static web_bench_request_t s_request;
+/* The state and the results are published by the benchmark task under the lock, the results are only released by
+ * esp_br_web_bench_start() which refuses to start while a run is in progress. */
+static web_bench_state_t s_state = WEB_BENCH_STATE_IDLE;
+static cJSON *s_results = NULL;
+static portMUX_TYPE s_state_lock = portMUX_INITIALIZER_UNLOCKED;
+/* The allocations of the counted task, they are only updated by the allocation hook in the context of that task. */
+static TaskHandle_t s_counted_task = NULL;
+static uint32_t s_alloc_count = 0;
+static uint64_t s_alloc_bytes = 0;
+
+typedef struct web_bench_case {
+    const char *name;
+    const char *key; /* NVS key of the baseline */
+    web_bench_convert_fn_t convert;
+    void *ctx;
+} web_bench_case_t;
+
+/*-----------------------------------------------------
+ Note：Allocation counting
+-----------------------------------------------------*/
+/**
+ * @brief The allocation hook of the heap, called for every allocation of every task.
+ *
+ * Only the allocations of the benchmark task are counted, so the requests served meanwhile are not.
+ */
+void IRAM_ATTR esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t caps)
+{
+    if (ptr && s_counted_task && xTaskGetCurrentTaskHandle() == s_counted_task) {
+        s_alloc_count++;
+        s_alloc_bytes += size;
+    }
+}
+
+static void bench_count_allocs_begin(void)
+{
+    s_alloc_count = 0;
+    s_alloc_bytes = 0;
+    s_counted_task = xTaskGetCurrentTaskHandle();
+}
+
+static void bench_count_allocs_end(void)
+{
+    s_counted_task = NULL;
+}
+
+/*-----------------------------------------------------
+ Note：Fixtures
+-----------------------------------------------------*/
+static void bench_dataset_fixture(otOperationalDataset *dataset)
+{
+    memset(dataset, 0, sizeof(otOperationalDataset));
+    dataset->mActiveTimestamp.mSeconds = 1700000000;
+    dataset->mActiveTimestamp.mTicks = 1234;
+    dataset->mActiveTimestamp.mAuthoritative = true;
+    dataset->mPendingTimestamp.mSeconds = 1700000100;
+    for (uint8_t i = 0; i < OT_NETWORK_KEY_SIZE; i++) {
+        dataset->mNetworkKey.m8[i] = 0xa0 + i;
+    }
+    strlcpy(dataset->mNetworkName.m8, "OpenThread-bench", sizeof(dataset->mNetworkName.m8));
+    for (uint8_t i = 0; i < OT_EXT_PAN_ID_SIZE; i++) {
+        dataset->mExtendedPanId.m8[i] = 0xd0 + i;
+    }
+    dataset->mMeshLocalPrefix.m8[0] = 0xfd;
+    dataset->mMeshLocalPrefix.m8[1] = 0xde;
+    dataset->mMeshLocalPrefix.m8[2] = 0xad;
+    dataset->mDelay = 30000;
+    dataset->mPanId = 0x1234;
+    dataset->mChannel = 15;
+    for (uint8_t i = 0; i < OT_PSKC_MAX_SIZE; i++) {
+        dataset->mPskc.m8[i] = 0x10 + i;
+    }
+    dataset->mSecurityPolicy.mRotationTime = 672;
+    dataset->mSecurityPolicy.mObtainNetworkKeyEnabled = true;
+    dataset->mSecurityPolicy.mNativeCommissioningEnabled = true;
+    dataset->mSecurityPolicy.mRoutersEnabled = true;
+    dataset->mSecurityPolicy.mExternalCommissioningEnabled = true;
+    dataset->mChannelMask = 0x07fff800;
+
+    dataset->mComponents.mIsActiveTimestampPresent = true;
+    dataset->mComponents.mIsPendingTimestampPresent = true;
+    dataset->mComponents.mIsNetworkKeyPresent = true;
+    dataset->mComponents.mIsNetworkNamePresent = true;
+    dataset->mComponents.mIsExtendedPanIdPresent = true;
+    dataset->mComponents.mIsMeshLocalPrefixPresent = true;
+    dataset->mComponents.mIsDelayPresent = true;
+    dataset->mComponents.mIsPanIdPresent = true;
+    dataset->mComponents.mIsChannelPresent = true;
+    dataset->mComponents.mIsPskcPresent = true;
+    dataset->mComponents.mIsSecurityPolicyPresent = true;
+    dataset->mComponents.mIsChannelMaskPresent = true;
+}
+
+static void bench_properties_fixture(openthread_properties_t *properties)
+{
+    otbr_properties_reset(properties);
+    properties->ipv6.link_local_address.mFields.m8[0] = 0xfe;
+    properties->ipv6.link_local_address.mFields.m8[1] = 0x80;
+    properties->ipv6.mesh_local_address.mFields.m8[0] = 0xfd;
+    properties->ipv6.mesh_local_prefix.mLength = 64;
+    strlcpy(properties->network.name.m8, "OpenThread-bench", sizeof(properties->network.name.m8));
+    properties->network.panid = 0x1234;
+    properties->network.partition_id = 0x5a5a5a5a;
+    properties->information.version = "OPENTHREAD/bench";
+    properties->information.version_api = 400;
+    properties->information.role = OT_DEVICE_ROLE_LEADER;
+    properties->rcp.channel = 15;
+    properties->rcp.txpower = 20;
+    properties->rcp.version = "openthread-esp32/bench";
+    strlcpy(properties->wpan.service, "associated", sizeof(properties->wpan.service));
+}
+
+static thread_diagnosticTlv_list_t *bench_diag_list_append(thread_diagnosticTlv_list_t **tail, uint8_t type)
+{
+    thread_diagnosticTlv_list_t *node = (thread_diagnosticTlv_list_t *)calloc(1, sizeof(thread_diagnosticTlv_list_t));
+    ESP_RETURN_ON_FALSE(node, NULL, BENCH_TAG, "Failed to allocate diagnostic list node");
+    node->diagTlv = (otNetworkDiagTlv *)calloc(1, sizeof(otNetworkDiagTlv));
+    if (!node->diagTlv) {
+        free(node);
+        return NULL;
+    }
+    node->diagTlv->mType = type;
+    if (*tail) {
+        (*tail)->next = node;
+    }
+    *tail = node;
+    return node;
+}
+
+static void bench_diag_list_destroy(thread_diagnosticTlv_list_t *list)
+{
+    while (list) {
+        thread_diagnosticTlv_list_t *next = list->next;
+        free(list->diagTlv);
+        free(list);
+        list = next;
+    }
+}
+
+/**
+ * @brief Build the diagnostic TLVs of a typical router: addresses, mode, connectivity, a route table of
+ * BENCH_ROUTE_NUM routers, leader data, an IPv6 address list, MAC counters and a child table.
+ */
+static thread_diagnosticTlv_list_t *bench_diag_list_fixture(void)
+{
+    esp_err_t ret = ESP_OK;
+    thread_diagnosticTlv_list_t *head = NULL;
+    thread_diagnosticTlv_list_t *tail = NULL;
+    thread_diagnosticTlv_list_t *node = NULL;
+
+    head = bench_diag_list_append(&tail, OT_NETWORK_DIAGNOSTIC_TLV_EXT_ADDRESS);
+    ESP_GOTO_ON_FALSE(head, ESP_ERR_NO_MEM, exit, BENCH_TAG, "No memory");
+    memset(head->diagTlv->mData.mExtAddress.m8, 0x5a, OT_EXT_ADDRESS_SIZE);
+    node = bench_diag_list_append(&tail, OT_NETWORK_DIAGNOSTIC_TLV_SHORT_ADDRESS);
+    ESP_GOTO_ON_FALSE(node, ESP_ERR_NO_MEM, exit, BENCH_TAG, "No memory");
+    node->diagTlv->mData.mAddr16 = 0x3800;
+    node = bench_diag_list_append(&tail, OT_NETWORK_DIAGNOSTIC_TLV_MODE);
+    ESP_GOTO_ON_FALSE(node, ESP_ERR_NO_MEM, exit, BENCH_TAG, "No memory");
+    node->diagTlv->mData.mMode.mRxOnWhenIdle = true;
+    node->diagTlv->mData.mMode.mDeviceType = true;
+    node->diagTlv->mData.mMode.mNetworkData = true;
+    node = bench_diag_list_append(&tail, OT_NETWORK_DIAGNOSTIC_TLV_CONNECTIVITY);
+    ESP_GOTO_ON_FALSE(node, ESP_ERR_NO_MEM, exit, BENCH_TAG, "No memory");
+    node->diagTlv->mData.mConnectivity.mLinkQuality3 = 4;
+    node->diagTlv->mData.mConnectivity.mActiveRouters = BENCH_ROUTE_NUM;
+    node = bench_diag_list_append(&tail, OT_NETWORK_DIAGNOSTIC_TLV_ROUTE);
+    ESP_GOTO_ON_FALSE(node, ESP_ERR_NO_MEM, exit, BENCH_TAG, "No memory");
+    node->diagTlv->mData.mRoute.mIdSequence = 42;
+    node->diagTlv->mData.mRoute.mRouteCount = BENCH_ROUTE_NUM;
+    for (uint8_t i = 0; i < BENCH_ROUTE_NUM; i++) {
+        node->diagTlv->mData.mRoute.mRouteData[i].mRouterId = i;
+        node->diagTlv->mData.mRoute.mRouteData[i].mLinkQualityIn = 3;
+        node->diagTlv->mData.mRoute.mRouteData[i].mLinkQualityOut = 3;
+        node->diagTlv->mData.mRoute.mRouteData[i].mRouteCost = i % 4;
+    }
+    node = bench_diag_list_append(&tail, OT_NETWORK_DIAGNOSTIC_TLV_LEADER_DATA);
+    ESP_GOTO_ON_FALSE(node, ESP_ERR_NO_MEM, exit, BENCH_TAG, "No memory");
+    node->diagTlv->mData.mLeaderData.mPartitionId = 0x5a5a5a5a;
+    node->diagTlv->mData.mLeaderData.mWeighting = 64;
+    node = bench_diag_list_append(&tail, OT_NETWORK_DIAGNOSTIC_TLV_IP6_ADDR_LIST);
+    ESP_GOTO_ON_FALSE(node, ESP_ERR_NO_MEM, exit, BENCH_TAG, "No memory");
+    node->diagTlv->mData.mIp6AddrList.mCount = BENCH_IP6_ADDRESS_NUM;
+    for (uint8_t i = 0; i < BENCH_IP6_ADDRESS_NUM; i++) {
+        node->diagTlv->mData.mIp6AddrList.mList[i].mFields.m8[0] = 0xfd;
+        node->diagTlv->mData.mIp6AddrList.mList[i].mFields.m8[15] = i;
+    }
+    node = bench_diag_list_append(&tail, OT_NETWORK_DIAGNOSTIC_TLV_MAC_COUNTERS);
+    ESP_GOTO_ON_FALSE(node, ESP_ERR_NO_MEM, exit, BENCH_TAG, "No memory");
+    node->diagTlv->mData.mMacCounters.mIfInUcastPkts = 123456;
+    node->diagTlv->mData.mMacCounters.mIfOutUcastPkts = 654321;
+    node = bench_diag_list_append(&tail, OT_NETWORK_DIAGNOSTIC_TLV_CHILD_TABLE);
+    ESP_GOTO_ON_FALSE(node, ESP_ERR_NO_MEM, exit, BENCH_TAG, "No memory");
+    node->diagTlv->mData.mChildTable.mCount = BENCH_CHILD_NUM;
+    for (uint8_t i = 0; i < BENCH_CHILD_NUM; i++) {
+        node->diagTlv->mData.mChildTable.mTable[i].mChildId = i + 1;
+        node->diagTlv->mData.mChildTable.mTable[i].mTimeout = 240;
+    }
+    return head;
+
+exit:
+    bench_diag_list_destroy(head);
+    return NULL;
+}
+
+/**
+ * @brief Build a diagnostic set of @param node_num nodes, all nodes share the TLV list @param list.
+ */
+static thread_diagnosticTlv_set_t *bench_diag_set_fixture(uint16_t node_num, thread_diagnosticTlv_list_t *list)
+{
+    thread_diagnosticTlv_set_t *set =
+        (thread_diagnosticTlv_set_t *)calloc(node_num + 1, sizeof(thread_diagnosticTlv_set_t));
+    ESP_RETURN_ON_FALSE(set, NULL, BENCH_TAG, "Failed to allocate diagnostic set of %u nodes", node_num);
+    for (uint16_t i = 1; i <= node_num; i++) {
+        snprintf(set[i].rloc16, sizeof(set[i].rloc16), "0x%04x", i);
+        set[i].diagTlv_next = list;
+        set[i - 1].next = &set[i];
+    }
+    return set;
+}
+
+/*-----------------------------------------------------
+ Note：Converters
+-----------------------------------------------------*/
+static esp_err_t bench_encode_active_dataset(void *ctx, cJSON **output)
+{
+    esp_br_web_json_writer_t writer;
+    esp_br_web_json_writer_init(&writer, s_encoded_text, sizeof(s_encoded_text));
+    return esp_br_web_encode_ActiveDataset(&writer, NULL, (const otOperationalDataset *)ctx);
+}
+
+static esp_err_t bench_decode_active_dataset(void *ctx, cJSON **output)
+{
+    otOperationalDataset dataset;
+    esp_br_web_json_reader_t reader;
+
+    memset(&dataset, 0, sizeof(dataset));
+    esp_br_web_json_reader_init(&reader, (const char *)ctx, strlen((const char *)ctx));
+    return esp_br_web_decode_ActiveDataset(&reader, &dataset);
+}
+
+static esp_err_t bench_encode_pending_dataset(void *ctx, cJSON **output)
+{
+    esp_br_web_json_writer_t writer;
+    esp_br_web_json_writer_init(&writer, s_encoded_text, sizeof(s_encoded_text));
+    return esp_br_web_encode_PendingDataset(&writer, NULL, (const otOperationalDataset *)ctx);
+}
+
+static esp_err_t bench_decode_pending_dataset(void *ctx, cJSON **output)
+{
+    otOperationalDataset dataset;
+    esp_br_web_json_reader_t reader;
+
+    memset(&dataset, 0, sizeof(dataset));
+    esp_br_web_json_reader_init(&reader, (const char *)ctx, strlen((const char *)ctx));
+    return esp_br_web_decode_PendingDataset(&reader, &dataset);
+}
+
+static esp_err_t bench_diag_set2json(void *ctx, cJSON **output)
+{
+    *output = dailnosticTlv_set_convert2_json((const thread_diagnosticTlv_set_t *)ctx);
+    return *output ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+static esp_err_t bench_properties2json(void *ctx, cJSON **output)
+{
+    *output = otbr_properties_struct_convert2_json((openthread_properties_t *)ctx);
+    return *output ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+/*-----------------------------------------------------
+ Note：Runner
+-----------------------------------------------------*/
+static esp_err_t bench_run_case(const web_bench_case_t *bench, uint16_t iterations, web_bench_result_t *result)
+{
+    esp_err_t ret = ESP_OK;
+    uint64_t total_time_us = 0;
+
+    bench_count_allocs_begin();
+    for (uint16_t i = 0; i < iterations && ret == ESP_OK; i++) {
+        cJSON *output = NULL;
+        int64_t start = esp_timer_get_time();
+        ret = bench->convert(bench->ctx, &output);
+        total_time_us += esp_timer_get_time() - start;
+        // Exclude the release from the time, the allocation counters only count allocations.
+        cJSON_Delete(output);
+    }
+    bench_count_allocs_end();
+    ESP_RETURN_ON_ERROR(ret, BENCH_TAG, "%s failed: %s", bench->name, esp_err_to_name(ret));
+
+    result->ns_per_op = (uint32_t)(total_time_us * 1000 / iterations);
+    result->allocs_per_op = s_alloc_count / iterations;
+    result->bytes_per_op = (uint32_t)(s_alloc_bytes / iterations);
+    return ESP_OK;
+}
+
+static cJSON *bench_result_convert2_json(const web_bench_result_t *result)
+{
+    cJSON *root = cJSON_CreateObject();
+    cJSON_AddItemToObject(root, "NsPerOp", cJSON_CreateNumber(result->ns_per_op));
+    cJSON_AddItemToObject(root, "AllocsPerOp", cJSON_CreateNumber(result->allocs_per_op));
+    cJSON_AddItemToObject(root, "BytesPerOp", cJSON_CreateNumber(result->bytes_per_op));
+    return root;
+}
+
+static cJSON *bench_run_converters(uint16_t iterations, bool save_baseline)
+{
+    esp_err_t ret = ESP_OK;
+    cJSON *root = NULL;
+    nvs_handle_t nvs_handle = 0;
+    otOperationalDataset dataset;
+    openthread_properties_t properties;
+    thread_diagnosticTlv_list_t *diag_list = NULL;
+    thread_diagnosticTlv_set_t *diag_sets[BENCH_DIAG_SET_NUM] = {NULL, NULL, NULL};
+
+    bench_dataset_fixture(&dataset);
+    bench_properties_fixture(&properties);
+    esp_br_web_json_writer_t writer;
+    esp_br_web_json_writer_init(&writer, s_dataset_text, sizeof(s_dataset_text));
+    esp_br_web_encode_ActiveDataset(&writer, NULL, &dataset);
+    ESP_GOTO_ON_ERROR(esp_br_web_json_writer_finish(&writer), exit, BENCH_TAG, "Failed to encode the dataset fixture");
+    esp_br_web_json_writer_init(&writer, s_pending_dataset_text, sizeof(s_pending_dataset_text));
+    esp_br_web_encode_PendingDataset(&writer, NULL, &dataset);
+    ESP_GOTO_ON_ERROR(esp_br_web_json_writer_finish(&writer), exit, BENCH_TAG,
+                      "Failed to encode the pending dataset fixture");
+    ESP_GOTO_ON_FALSE((diag_list = bench_diag_list_fixture()), ESP_ERR_NO_MEM, exit, BENCH_TAG,
+                      "Failed to create the diagnostic fixture");
+    for (uint8_t i = 0; i < BENCH_DIAG_SET_NUM; i++) {
+        // The output of a large set needs megabytes of heap, the sets above the configured size are skipped.
+        if (s_diag_set_node_num[i] <= CONFIG_OPENTHREAD_BR_WEB_BENCH_MAX_DIAG_NODES) {
+            diag_sets[i] = bench_diag_set_fixture(s_diag_set_node_num[i], diag_list);
+            ESP_GOTO_ON_FALSE(diag_sets[i], ESP_ERR_NO_MEM, exit, BENCH_TAG, "No memory");
+        }
+    }
+
+    const web_bench_case_t cases[] = {
+        {"EncodeActiveDataset", "encode_active", bench_encode_active_dataset, &dataset},
+        {"DecodeActiveDataset", "decode_active", bench_decode_active_dataset, s_dataset_text},
+        {"EncodePendingDataset", "encode_pending", bench_encode_pending_dataset, &dataset},
+        {"DecodePendingDataset", "decode_pending", bench_decode_pending_dataset, s_pending_dataset_text},
+        {"DiagnosticSet50", "diag50", bench_diag_set2json, diag_sets[0]},
+        {"DiagnosticSet150", "diag150", bench_diag_set2json, diag_sets[1]},
+        {"DiagnosticSet300", "diag300", bench_diag_set2json, diag_sets[2]},
+        {"Properties2Json", "properties", bench_properties2json, &properties},
+    };
+
+    if (nvs_open(BENCH_NVS_NAMESPACE, save_baseline ? NVS_READWRITE : NVS_READONLY, &nvs_handle) != ESP_OK) {
+        ESP_LOGW(BENCH_TAG, "No baseline storage, results will not be compared");
+        nvs_handle = 0;
+    }
+    ESP_GOTO_ON_FALSE((root = cJSON_CreateArray()), ESP_ERR_NO_MEM, exit, BENCH_TAG, "No memory");
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        web_bench_result_t result;
+        web_bench_result_t baseline;
+        size_t baseline_size = sizeof(baseline);
+        cJSON *item = NULL;
+
+        if (!cases[i].ctx) {
+            ESP_GOTO_ON_FALSE((item = cJSON_CreateObject()), ESP_ERR_NO_MEM, exit, BENCH_TAG, "No memory");
+            cJSON_AddItemToObject(item, "Name", cJSON_CreateString(cases[i].name));
+            cJSON_AddItemToObject(item, "Skipped", cJSON_CreateTrue());
+            cJSON_AddItemToArray(root, item);
+            continue;
+        }
+        esp_err_t err = bench_run_case(&cases[i], iterations, &result);
+        if (err != ESP_OK) {
+            // Report the failure, e.g. an allocation failure, instead of a time of a partial run.
+            ESP_GOTO_ON_FALSE((item = cJSON_CreateObject()), ESP_ERR_NO_MEM, exit, BENCH_TAG, "No memory");
+            cJSON_AddItemToObject(item, "Name", cJSON_CreateString(cases[i].name));
+            cJSON_AddItemToObject(item, "Error", cJSON_CreateString(esp_err_to_name(err)));
+            cJSON_AddItemToArray(root, item);
+            continue;
+        }
+        ESP_GOTO_ON_FALSE((item = bench_result_convert2_json(&result)), ESP_ERR_NO_MEM, exit, BENCH_TAG, "No memory");
+        cJSON_AddItemToObject(item, "Name", cJSON_CreateString(cases[i].name));
+        cJSON_AddItemToObject(item, "Iterations", cJSON_CreateNumber(iterations));
+        if (nvs_handle && nvs_get_blob(nvs_handle, cases[i].key, &baseline, &baseline_size) == ESP_OK &&
+            baseline_size == sizeof(baseline)) {
+            cJSON_AddItemToObject(item, "Baseline", bench_result_convert2_json(&baseline));
+            if (baseline.ns_per_op) {
+                cJSON_AddItemToObject(
+                    item, "TimeDeltaPercent",
+                    cJSON_CreateNumber(((double)result.ns_per_op - baseline.ns_per_op) * 100 / baseline.ns_per_op));
+            }
+        }
+        cJSON_AddItemToArray(root, item);
+        if (nvs_handle && save_baseline) {
+            ESP_GOTO_ON_ERROR(nvs_set_blob(nvs_handle, cases[i].key, &result, sizeof(result)), exit, BENCH_TAG,
+                              "Failed to save the baseline of %s", cases[i].name);
+        }
+        ESP_LOGI(BENCH_TAG, "%s: %lu ns/op, %lu allocs/op, %lu bytes/op", cases[i].name, result.ns_per_op,
+                 result.allocs_per_op, result.bytes_per_op);
+    }
+    if (nvs_handle && save_baseline) {
+        ESP_GOTO_ON_ERROR(nvs_commit(nvs_handle), exit, BENCH_TAG, "Failed to commit the baseline");
+    }
+
+exit:
+    if (nvs_handle) {
+        nvs_close(nvs_handle);
+    }
+    if (ret != ESP_OK) {
+        cJSON_Delete(root);
+        root = NULL;
+    }
+    for (uint8_t i = 0; i < BENCH_DIAG_SET_NUM; i++) {
+        free(diag_sets[i]);
+    }
+    bench_diag_list_destroy(diag_list);
+    return root;
+}
+
+static void bench_task(void *ctx)
+{
+    cJSON *results = bench_run_converters(s_request.iterations, s_request.save_baseline);
+
+    portENTER_CRITICAL(&s_state_lock);
+    s_results = results;
+    s_state = results ? WEB_BENCH_STATE_DONE : WEB_BENCH_STATE_FAILED;
+    portEXIT_CRITICAL(&s_state_lock);
+    vTaskDelete(NULL);
+}
+
+esp_err_t esp_br_web_bench_start(uint16_t iterations, bool save_baseline)
+{
+    ESP_RETURN_ON_FALSE(iterations > 0, ESP_ERR_INVALID_ARG, BENCH_TAG, "Invalid iterations");
+    portENTER_CRITICAL(&s_state_lock);
+    bool running = (s_state == WEB_BENCH_STATE_RUNNING);
+    if (!running) {
+        s_state = WEB_BENCH_STATE_RUNNING;
+    }
+    portEXIT_CRITICAL(&s_state_lock);
+    ESP_RETURN_ON_FALSE(!running, ESP_ERR_INVALID_STATE, BENCH_TAG, "The benchmark is running");
+
+    cJSON_Delete(s_results);
+    s_results = NULL;
+    s_request.iterations = iterations;
+    s_request.save_baseline = save_baseline;
+    if (xTaskCreate(bench_task, "web_bench", BENCH_TASK_STACK_SIZE, NULL, BENCH_TASK_PRIORITY, NULL) != pdPASS) {
+        portENTER_CRITICAL(&s_state_lock);
+        s_state = WEB_BENCH_STATE_FAILED;
+        portEXIT_CRITICAL(&s_state_lock);
+        ESP_LOGE(BENCH_TAG, "Failed to create the benchmark task");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+cJSON *esp_br_web_bench_get_report(void)
+{
+    static const char *const state_str[] = {"Idle", "Running", "Done", "Failed"};
+    cJSON *report = cJSON_CreateObject();
+    ESP_RETURN_ON_FALSE(report, NULL, BENCH_TAG, "No memory");
+
+    portENTER_CRITICAL(&s_state_lock);
+    web_bench_state_t state = s_state;
+    portEXIT_CRITICAL(&s_state_lock);
+    cJSON_AddItemToObject(report, "State", cJSON_CreateString(state_str[state]));
+    if (state == WEB_BENCH_STATE_DONE) {
+        cJSON_AddItemToObject(report, "Results", cJSON_Duplicate(s_results, true));
+    }
+    return report;
+}
+
+#endif // CONFIG_OPENTHREAD_BR_WEB_BENCH
@@ -0,0 +1,574 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "esp_br_web_json.h"
+#include "esp_check.h"
+#include "esp_err.h"
+#include <stdio.h>
+#include <string.h>
+#include "openthread/dataset.h"
+#include "openthread/error.h"
+#include "openthread/ip6.h"
+
+#define JSON_TAG "web_json"
+#define JSON_HEX_MAX_SIZE 32
+
+static const char s_hex_digits[] = "0123456789abcdef";
+
+/*-----------------------------------------------------
+ Note：JSON writer
+-----------------------------------------------------*/
+static void json_append(esp_br_web_json_writer_t *writer, const char *str, size_t len)
+{
+    if (writer->err != ESP_OK) {
+        return;
+    }
+    if (writer->len + len >= writer->size) {
+        writer->err = ESP_ERR_NO_MEM;
+        return;
+    }
+    memcpy(writer->buf + writer->len, str, len);
+    writer->len += len;
+    writer->buf[writer->len] = '\0';
+}
+
+static void json_append_char(esp_br_web_json_writer_t *writer, char c)
+{
+    json_append(writer, &c, 1);
+}
+
+static void json_append_string(esp_br_web_json_writer_t *writer, const char *str)
+{
+    json_append_char(writer, '"');
+    for (const char *p = str; *p; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c == '"' || c == '\\') {
+            json_append_char(writer, '\\');
+            json_append_char(writer, (char)c);
+        } else if (c < 0x20) {
+            char escaped[7];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            json_append(writer, escaped, 6);
+        } else {
+            json_append_char(writer, (char)c);
+        }
+    }
+    json_append_char(writer, '"');
+}
+
+static void json_write_key(esp_br_web_json_writer_t *writer, const char *key)
+{
+    if (writer->depth == 0) {
+        return;
+    }
+    if (writer->comma[writer->depth]) {
+        json_append_char(writer, ',');
+    }
+    writer->comma[writer->depth] = true;
+    if (key) {
+        json_append_string(writer, key);
+        json_append_char(writer, ':');
+    }
+}
+
+void esp_br_web_json_writer_init(esp_br_web_json_writer_t *writer, char *buf, size_t size)
+{
+    memset(writer, 0, sizeof(esp_br_web_json_writer_t));
+    writer->buf = buf;
+    writer->size = size;
+    writer->err = (buf && size) ? ESP_OK : ESP_ERR_INVALID_ARG;
+    if (writer->err == ESP_OK) {
+        buf[0] = '\0';
+    }
+}
+
+void esp_br_web_json_write_object_start(esp_br_web_json_writer_t *writer, const char *key)
+{
+    json_write_key(writer, key);
+    json_append_char(writer, '{');
+    if (writer->depth >= ESP_BR_WEB_JSON_MAX_DEPTH) {
+        writer->err = writer->err == ESP_OK ? ESP_ERR_INVALID_STATE : writer->err;
+        return;
+    }
+    writer->comma[++writer->depth] = false;
+}
+
+void esp_br_web_json_write_object_end(esp_br_web_json_writer_t *writer)
+{
+    if (writer->depth == 0) {
+        writer->err = writer->err == ESP_OK ? ESP_ERR_INVALID_STATE : writer->err;
+        return;
+    }
+    writer->depth--;
+    json_append_char(writer, '}');
+}
+
+void esp_br_web_json_write_uint(esp_br_web_json_writer_t *writer, const char *key, uint64_t value)
+{
+    // Format by hand, 64-bit conversions are not supported by the nano formatting of newlib.
+    char number[20];
+    size_t pos = sizeof(number);
+    do {
+        number[--pos] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+    json_write_key(writer, key);
+    json_append(writer, number + pos, sizeof(number) - pos);
+}
+
+void esp_br_web_json_write_bool(esp_br_web_json_writer_t *writer, const char *key, bool value)
+{
+    json_write_key(writer, key);
+    json_append(writer, value ? "true" : "false", value ? 4 : 5);
+}
+
+void esp_br_web_json_write_string(esp_br_web_json_writer_t *writer, const char *key, const char *value)
+{
+    json_write_key(writer, key);
+    json_append_string(writer, value ? value : "");
+}
+
+void esp_br_web_json_write_hex(esp_br_web_json_writer_t *writer, const char *key, const uint8_t *value,
+                               size_t size)
+{
+    json_write_key(writer, key);
+    json_append_char(writer, '"');
+    for (size_t i = 0; i < size; i++) {
+        char hex[2] = {s_hex_digits[value[i] >> 4], s_hex_digits[value[i] & 0x0f]};
+        json_append(writer, hex, sizeof(hex));
+    }
+    json_append_char(writer, '"');
+}
+
+void esp_br_web_json_write_ip6_prefix(esp_br_web_json_writer_t *writer, const char *key, const uint8_t *value)
+{
+    otIp6Prefix prefix;
+    char str[OT_IP6_PREFIX_STRING_SIZE];
+
+    memset(&prefix, 0, sizeof(prefix));
+    memcpy(prefix.mPrefix.mFields.m8, value, OT_IP6_PREFIX_SIZE);
+    prefix.mLength = OT_IP6_PREFIX_SIZE * 8;
+    otIp6PrefixToString(&prefix, str, sizeof(str));
+    esp_br_web_json_write_string(writer, key, str);
+}
+
+esp_err_t esp_br_web_json_writer_finish(const esp_br_web_json_writer_t *writer)
+{
+    ESP_RETURN_ON_ERROR(writer->err, JSON_TAG, "Failed to write JSON");
+    ESP_RETURN_ON_FALSE(writer->depth == 0, ESP_ERR_INVALID_STATE, JSON_TAG, "Unbalanced JSON objects");
+    return ESP_OK;
+}
+
+/*-----------------------------------------------------
+ Note：JSON reader
+-----------------------------------------------------*/
+static void json_skip_whitespace(esp_br_web_json_reader_t *reader)
+{
+    while (reader->cur < reader->end &&
+           (*reader->cur == ' ' || *reader->cur == '\t' || *reader->cur == '\r' || *reader->cur == '\n')) {
+        reader->cur++;
+    }
+}
+
+static bool json_consume(esp_br_web_json_reader_t *reader, char c)
+{
+    json_skip_whitespace(reader);
+    if (reader->cur < reader->end && *reader->cur == c) {
+        reader->cur++;
+        return true;
+    }
+    return false;
+}
+
+static bool json_consume_literal(esp_br_web_json_reader_t *reader, const char *literal)
+{
+    size_t len = strlen(literal);
+    if ((size_t)(reader->end - reader->cur) >= len && memcmp(reader->cur, literal, len) == 0) {
+        reader->cur += len;
+        return true;
+    }
+    return false;
+}
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+static size_t utf8_encode(uint32_t code, char out[4])
+{
+    if (code < 0x80) {
+        out[0] = (char)code;
+        return 1;
+    } else if (code < 0x800) {
+        out[0] = (char)(0xc0 | (code >> 6));
+        out[1] = (char)(0x80 | (code & 0x3f));
+        return 2;
+    } else if (code < 0x10000) {
+        out[0] = (char)(0xe0 | (code >> 12));
+        out[1] = (char)(0x80 | ((code >> 6) & 0x3f));
+        out[2] = (char)(0x80 | (code & 0x3f));
+        return 3;
+    }
+    out[0] = (char)(0xf0 | (code >> 18));
+    out[1] = (char)(0x80 | ((code >> 12) & 0x3f));
+    out[2] = (char)(0x80 | ((code >> 6) & 0x3f));
+    out[3] = (char)(0x80 | (code & 0x3f));
+    return 4;
+}
+
+static esp_err_t json_read_unicode_escape(esp_br_web_json_reader_t *reader, uint32_t *code)
+{
+    ESP_RETURN_ON_FALSE(reader->end - reader->cur >= 4, ESP_ERR_INVALID_ARG, JSON_TAG, "Invalid unicode escape");
+    *code = 0;
+    for (int i = 0; i < 4; i++) {
+        int digit = hex_value(*reader->cur++);
+        ESP_RETURN_ON_FALSE(digit >= 0, ESP_ERR_INVALID_ARG, JSON_TAG, "Invalid unicode escape");
+        *code = (*code << 4) | (uint32_t)digit;
+    }
+    return ESP_OK;
+}
+
+/* Parse a string value, the unescaped string is written to @param buf if it is not NULL. */
+static esp_err_t json_parse_string(esp_br_web_json_reader_t *reader, char *buf, size_t size, size_t *out_len)
+{
+    size_t len = 0;
+    ESP_RETURN_ON_FALSE(json_consume(reader, '"'), ESP_ERR_INVALID_ARG, JSON_TAG, "A string is expected");
+    while (reader->cur < reader->end && *reader->cur != '"') {
+        char decoded[4];
+        size_t decoded_len = 1;
+        char c = *reader->cur++;
+        ESP_RETURN_ON_FALSE((unsigned char)c >= 0x20, ESP_ERR_INVALID_ARG, JSON_TAG, "Invalid character in string");
+        if (c == '\\') {
+            ESP_RETURN_ON_FALSE(reader->cur < reader->end, ESP_ERR_INVALID_ARG, JSON_TAG, "Unterminated string");
+            c = *reader->cur++;
+            switch (c) {
+            case '"':
+            case '\\':
+            case '/':
+                decoded[0] = c;
+                break;
+            case 'b':
+                decoded[0] = '\b';
+                break;
+            case 'f':
+                decoded[0] = '\f';
+                break;
+            case 'n':
+                decoded[0] = '\n';
+                break;
+            case 'r':
+                decoded[0] = '\r';
+                break;
+            case 't':
+                decoded[0] = '\t';
+                break;
+            case 'u': {
+                uint32_t code = 0;
+                ESP_RETURN_ON_ERROR(json_read_unicode_escape(reader, &code), JSON_TAG, "Invalid string");
+                if (code >= 0xd800 && code <= 0xdbff) {
+                    uint32_t low = 0;
+                    ESP_RETURN_ON_FALSE(json_consume_literal(reader, "\\u"), ESP_ERR_INVALID_ARG, JSON_TAG,
+                                        "Unpaired surrogate");
+                    ESP_RETURN_ON_ERROR(json_read_unicode_escape(reader, &low), JSON_TAG, "Invalid string");
+                    ESP_RETURN_ON_FALSE(low >= 0xdc00 && low <= 0xdfff, ESP_ERR_INVALID_ARG, JSON_TAG,
+                                        "Unpaired surrogate");
+                    code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                }
+                decoded_len = utf8_encode(code, decoded);
+                break;
+            }
+            default:
+                ESP_RETURN_ON_FALSE(false, ESP_ERR_INVALID_ARG, JSON_TAG, "Invalid escape in string");
+            }
+        } else {
+            decoded[0] = c;
+        }
+        if (buf) {
+            ESP_RETURN_ON_FALSE(len + decoded_len < size, ESP_ERR_INVALID_SIZE, JSON_TAG, "The string is too long");
+            memcpy(buf + len, decoded, decoded_len);
+        }
+        len += decoded_len;
+    }
+    ESP_RETURN_ON_FALSE(reader->cur < reader->end, ESP_ERR_INVALID_ARG, JSON_TAG, "Unterminated string");
+    reader->cur++;
+    if (buf) {
+        buf[len] = '\0';
+    }
+    if (out_len) {
+        *out_len = len;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t json_hex_decode(const char *str, size_t len, uint8_t *buf, size_t size)
+{
+    ESP_RETURN_ON_FALSE(len == size * 2, ESP_ERR_INVALID_SIZE, JSON_TAG, "Invalid length of hex string");
+    for (size_t i = 0; i < size; i++) {
+        int high = hex_value(str[2 * i]);
+        int low = hex_value(str[2 * i + 1]);
+        ESP_RETURN_ON_FALSE(high >= 0 && low >= 0, ESP_ERR_INVALID_ARG, JSON_TAG, "Invalid hex string");
+        buf[i] = (uint8_t)((high << 4) | low);
+    }
+    return ESP_OK;
+}
+
+void esp_br_web_json_reader_init(esp_br_web_json_reader_t *reader, const char *buf, size_t len)
+{
+    memset(reader, 0, sizeof(esp_br_web_json_reader_t));
+    reader->cur = buf;
+    reader->end = buf + len;
+}
+
+esp_br_web_json_type_t esp_br_web_json_peek(esp_br_web_json_reader_t *reader)
+{
+    json_skip_whitespace(reader);
+    if (reader->cur >= reader->end) {
+        return ESP_BR_WEB_JSON_INVALID;
+    }
+    switch (*reader->cur) {
+    case '{':
+        return ESP_BR_WEB_JSON_OBJECT;
+    case '[':
+        return ESP_BR_WEB_JSON_ARRAY;
+    case '"':
+        return ESP_BR_WEB_JSON_STRING;
+    case 't':
+    case 'f':
+        return ESP_BR_WEB_JSON_BOOL;
+    case 'n':
+        return ESP_BR_WEB_JSON_NULL;
+    case '-':
+        return ESP_BR_WEB_JSON_NUMBER;
+    default:
+        return (*reader->cur >= '0' && *reader->cur <= '9') ? ESP_BR_WEB_JSON_NUMBER : ESP_BR_WEB_JSON_INVALID;
+    }
+}
+
+esp_err_t esp_br_web_json_read_object_start(esp_br_web_json_reader_t *reader)
+{
+    ESP_RETURN_ON_FALSE(reader->depth < ESP_BR_WEB_JSON_MAX_DEPTH, ESP_ERR_INVALID_ARG, JSON_TAG,
+                        "JSON objects are nested too deeply");
+    ESP_RETURN_ON_FALSE(json_consume(reader, '{'), ESP_ERR_INVALID_ARG, JSON_TAG, "An object is expected");
+    reader->comma[++reader->depth] = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_br_web_json_read_member(esp_br_web_json_reader_t *reader, char *key, size_t size)
+{
+    ESP_RETURN_ON_FALSE(reader->depth > 0, ESP_ERR_INVALID_STATE, JSON_TAG, "Not in an object");
+    if (json_consume(reader, '}')) {
+        reader->depth--;
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (reader->comma[reader->depth]) {
+        ESP_RETURN_ON_FALSE(json_consume(reader, ','), ESP_ERR_INVALID_ARG, JSON_TAG, "A comma is expected");
+    }
+    reader->comma[reader->depth] = true;
+    const char *start = reader->cur;
+    size_t len = 0;
+    ESP_RETURN_ON_ERROR(json_parse_string(reader, NULL, 0, &len), JSON_TAG, "Invalid key");
+    if (len < size) {
+        reader->cur = start;
+        ESP_RETURN_ON_ERROR(json_parse_string(reader, key, size, NULL), JSON_TAG, "Invalid key");
+    } else if (size) {
+        // No known key is that long, an empty key lets the caller skip the member.
+        key[0] = '\0';
+    }
+    ESP_RETURN_ON_FALSE(json_consume(reader, ':'), ESP_ERR_INVALID_ARG, JSON_TAG, "A colon is expected");
+    json_skip_whitespace(reader);
+    return ESP_OK;
+}
+
+esp_err_t esp_br_web_json_read_uint(esp_br_web_json_reader_t *reader, uint64_t min, uint64_t max, uint64_t *value)
+{
+    uint64_t number = 0;
+    const char *start = NULL;
+
+    json_skip_whitespace(reader);
+    start = reader->cur;
+    while (reader->cur < reader->end && *reader->cur >= '0' && *reader->cur <= '9') {
+        uint8_t digit = (uint8_t)(*reader->cur++ - '0');
+        ESP_RETURN_ON_FALSE(number <= (UINT64_MAX - digit) / 10, ESP_ERR_INVALID_ARG, JSON_TAG, "Integer overflow");
+        number = number * 10 + digit;
+    }
+    ESP_RETURN_ON_FALSE(reader->cur > start, ESP_ERR_INVALID_ARG, JSON_TAG, "An unsigned integer is expected");
+    ESP_RETURN_ON_FALSE(reader->cur == reader->end ||
+                            (*reader->cur != '.' && *reader->cur != 'e' && *reader->cur != 'E'),
+                        ESP_ERR_INVALID_ARG, JSON_TAG, "An integer is expected");
+    ESP_RETURN_ON_FALSE(number >= min && number <= max, ESP_ERR_INVALID_ARG, JSON_TAG, "Integer out of range");
+    *value = number;
+    return ESP_OK;
+}
+
+esp_err_t esp_br_web_json_read_bool(esp_br_web_json_reader_t *reader, bool *value)
+{
+    json_skip_whitespace(reader);
+    if (json_consume_literal(reader, "true")) {
+        *value = true;
+    } else if (json_consume_literal(reader, "false")) {
+        *value = false;
+    } else {
+        ESP_RETURN_ON_FALSE(false, ESP_ERR_INVALID_ARG, JSON_TAG, "A boolean is expected");
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_br_web_json_read_string(esp_br_web_json_reader_t *reader, char *buf, size_t size)
+{
+    ESP_RETURN_ON_FALSE(buf && size, ESP_ERR_INVALID_ARG, JSON_TAG, "Invalid buffer");
+    return json_parse_string(reader, buf, size, NULL);
+}
+
+esp_err_t esp_br_web_json_read_hex(esp_br_web_json_reader_t *reader, uint8_t *buf, size_t size)
+{
+    char str[2 * JSON_HEX_MAX_SIZE + 1];
+    size_t len = 0;
+
+    ESP_RETURN_ON_FALSE(size <= JSON_HEX_MAX_SIZE, ESP_ERR_INVALID_SIZE, JSON_TAG, "The hex value is too long");
+    ESP_RETURN_ON_ERROR(json_parse_string(reader, str, sizeof(str), &len), JSON_TAG, "Invalid hex string");
+    return json_hex_decode(str, len, buf, size);
+}
+
+esp_err_t esp_br_web_json_read_ip6_prefix(esp_br_web_json_reader_t *reader, uint8_t *buf)
+{
+    char str[OT_IP6_PREFIX_STRING_SIZE];
+    otIp6Prefix prefix;
+
+    ESP_RETURN_ON_ERROR(json_parse_string(reader, str, sizeof(str), NULL), JSON_TAG, "Invalid prefix string");
+    ESP_RETURN_ON_FALSE(otIp6PrefixFromString(str, &prefix) == OT_ERROR_NONE, ESP_ERR_INVALID_ARG, JSON_TAG,
+                        "Invalid prefix %s", str);
+    memcpy(buf, prefix.mPrefix.mFields.m8, OT_IP6_PREFIX_SIZE);
+    return ESP_OK;
+}
+
+/* Copy the components present in @param from to @param to. */
+static void json_dataset_copy_components(otOperationalDataset *to, const otOperationalDataset *from)
+{
+    if (from->mComponents.mIsActiveTimestampPresent) {
+        to->mActiveTimestamp = from->mActiveTimestamp;
+        to->mComponents.mIsActiveTimestampPresent = true;
+    }
+    if (from->mComponents.mIsPendingTimestampPresent) {
+        to->mPendingTimestamp = from->mPendingTimestamp;
+        to->mComponents.mIsPendingTimestampPresent = true;
+    }
+    if (from->mComponents.mIsNetworkKeyPresent) {
+        to->mNetworkKey = from->mNetworkKey;
+        to->mComponents.mIsNetworkKeyPresent = true;
+    }
+    if (from->mComponents.mIsNetworkNamePresent) {
+        to->mNetworkName = from->mNetworkName;
+        to->mComponents.mIsNetworkNamePresent = true;
+    }
+    if (from->mComponents.mIsExtendedPanIdPresent) {
+        to->mExtendedPanId = from->mExtendedPanId;
+        to->mComponents.mIsExtendedPanIdPresent = true;
+    }
+    if (from->mComponents.mIsMeshLocalPrefixPresent) {
+        to->mMeshLocalPrefix = from->mMeshLocalPrefix;
+        to->mComponents.mIsMeshLocalPrefixPresent = true;
+    }
+    if (from->mComponents.mIsDelayPresent) {
+        to->mDelay = from->mDelay;
+        to->mComponents.mIsDelayPresent = true;
+    }
+    if (from->mComponents.mIsPanIdPresent) {
+        to->mPanId = from->mPanId;
+        to->mComponents.mIsPanIdPresent = true;
+    }
+    if (from->mComponents.mIsChannelPresent) {
+        to->mChannel = from->mChannel;
+        to->mComponents.mIsChannelPresent = true;
+    }
+    if (from->mComponents.mIsPskcPresent) {
+        to->mPskc = from->mPskc;
+        to->mComponents.mIsPskcPresent = true;
+    }
+    if (from->mComponents.mIsSecurityPolicyPresent) {
+        to->mSecurityPolicy = from->mSecurityPolicy;
+        to->mComponents.mIsSecurityPolicyPresent = true;
+    }
+    if (from->mComponents.mIsChannelMaskPresent) {
+        to->mChannelMask = from->mChannelMask;
+        to->mComponents.mIsChannelMaskPresent = true;
+    }
+}
+
+esp_err_t esp_br_web_json_read_dataset_tlvs(esp_br_web_json_reader_t *reader, otOperationalDataset *dataset)
+{
+    char str[OT_OPERATIONAL_DATASET_MAX_LENGTH * 2 + 1];
+    otOperationalDatasetTlvs tlvs;
+    otOperationalDataset parsed;
+    size_t len = 0;
+
+    ESP_RETURN_ON_ERROR(json_parse_string(reader, str, sizeof(str), &len), JSON_TAG, "Invalid DatasetTlvs");
+    ESP_RETURN_ON_FALSE(len % 2 == 0, ESP_ERR_INVALID_ARG, JSON_TAG, "Invalid DatasetTlvs");
+    ESP_RETURN_ON_ERROR(json_hex_decode(str, len, tlvs.mTlvs, len / 2), JSON_TAG, "Invalid DatasetTlvs");
+    tlvs.mLength = (uint8_t)(len / 2);
+    // otDatasetParseTlvs() clears the whole dataset, the members decoded before the TLVs are merged back.
+    ESP_RETURN_ON_FALSE(otDatasetParseTlvs(&tlvs, &parsed) == OT_ERROR_NONE, ESP_ERR_INVALID_ARG, JSON_TAG,
+                        "Cannot parse DatasetTlvs");
+    json_dataset_copy_components(&parsed, dataset);
+    *dataset = parsed;
+    return ESP_OK;
+}
+
+esp_err_t esp_br_web_json_skip_value(esp_br_web_json_reader_t *reader)
+{
+    char closers[ESP_BR_WEB_JSON_MAX_DEPTH * 4]; /* the expected end of every container being skipped */
+    uint8_t nesting = 0;
+
+    do {
+        switch (esp_br_web_json_peek(reader)) {
+        case ESP_BR_WEB_JSON_STRING:
+            ESP_RETURN_ON_ERROR(json_parse_string(reader, NULL, 0, NULL), JSON_TAG, "Invalid string");
+            break;
+        case ESP_BR_WEB_JSON_NUMBER:
+            while (reader->cur < reader->end && *reader->cur && strchr("+-.0123456789eE", *reader->cur)) {
+                reader->cur++;
+            }
+            break;
+        case ESP_BR_WEB_JSON_BOOL:
+        case ESP_BR_WEB_JSON_NULL:
+            ESP_RETURN_ON_FALSE(json_consume_literal(reader, "true") || json_consume_literal(reader, "false") ||
+                                    json_consume_literal(reader, "null"),
+                                ESP_ERR_INVALID_ARG, JSON_TAG, "Invalid literal");
+            break;
+        case ESP_BR_WEB_JSON_OBJECT:
+        case ESP_BR_WEB_JSON_ARRAY:
+            ESP_RETURN_ON_FALSE(nesting < sizeof(closers), ESP_ERR_INVALID_ARG, JSON_TAG,
+                                "JSON values are nested too deeply");
+            closers[nesting++] = (*reader->cur++ == '{') ? '}' : ']';
+            break;
+        default:
+            ESP_RETURN_ON_FALSE(false, ESP_ERR_INVALID_ARG, JSON_TAG, "Invalid JSON value");
+        }
+        /* Consume the ends and the separators of the containers which are being skipped, a mismatched end is left
+         * to be rejected as an invalid value. */
+        while (nesting > 0 && json_consume(reader, closers[nesting - 1])) {
+            nesting--;
+        }
+        if (nesting > 0 && !json_consume(reader, ',')) {
+            json_consume(reader, ':');
+        }
+    } while (nesting > 0);
+    return ESP_OK;
+}
+
+esp_err_t esp_br_web_json_reader_finish(esp_br_web_json_reader_t *reader)
+{
+    json_skip_whitespace(reader);
+    ESP_RETURN_ON_FALSE(reader->cur == reader->end, ESP_ERR_INVALID_ARG, JSON_TAG, "Unexpected trailing data");
+    return ESP_OK;
+}
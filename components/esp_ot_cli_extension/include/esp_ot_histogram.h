@@ -0,0 +1,62 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The sub-buckets of each power of two, a recorded value is reported within 1/16 of its size. */
+#define ESP_OT_HISTOGRAM_SUB_BUCKET_BITS 4
+#define ESP_OT_HISTOGRAM_SUB_BUCKET_NUM (1 << ESP_OT_HISTOGRAM_SUB_BUCKET_BITS)
+#define ESP_OT_HISTOGRAM_BUCKET_NUM ((32 - ESP_OT_HISTOGRAM_SUB_BUCKET_BITS + 1) * ESP_OT_HISTOGRAM_SUB_BUCKET_NUM)
+
+/**
+ * @brief A histogram of 32-bit values with log-linear buckets, in the manner of an HDR histogram.
+ *
+ * The values below 32 are counted exactly, the others in buckets growing with the value, so the percentiles of
+ * latencies ranging from microseconds to seconds are kept in a fixed size with a bounded relative error.
+ */
+typedef struct {
+    uint32_t counts[ESP_OT_HISTOGRAM_BUCKET_NUM];
+    uint32_t count; /* the number of values recorded */
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+} esp_ot_histogram_t;
+
+/**
+ * @brief Discard the values recorded in a histogram.
+ */
+void esp_ot_histogram_reset(esp_ot_histogram_t *histogram);
+
+/**
+ * @brief Record a value in a histogram.
+ */
+void esp_ot_histogram_record(esp_ot_histogram_t *histogram, uint32_t value);
+
+/**
+ * @brief Get a percentile of the values recorded in a histogram.
+ *
+ * @param[in] histogram     The histogram.
+ * @param[in] percentile    The percentile, from 0 to 100.
+ *
+ * @return The highest value of the bucket holding the percentile, bounded by the recorded maximum, 0 if no value is
+ *         recorded.
+ */
+uint32_t esp_ot_histogram_percentile(const esp_ot_histogram_t *histogram, uint32_t percentile);
+
+/**
+ * @brief Get the mean of the values recorded in a histogram, 0 if no value is recorded.
+ */
+uint32_t esp_ot_histogram_mean(const esp_ot_histogram_t *histogram);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,32 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <openthread/error.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief User command "otperf" process.
+ *
+ * The UDP throughput test runs on the UDP sockets of OpenThread, so that it measures the Thread stack and the radio
+ * without the lwIP sockets and the netif glue in the way of the iperf command.
+ *
+ */
+otError esp_ot_process_perf(void *aContext, uint8_t aArgsLength, char *aArgs[]);
+
+/**
+ * default port of the otperf server
+ */
+#define OT_PERF_DEFAULT_PORT 5002
+
+#ifdef __cplusplus
+}
+#endif
@@ -16,6 +16,7 @@ extern "C" {
 
 #define UDP_CLIENT_SEND_BIT BIT0
 #define UDP_CLIENT_CLOSE_BIT BIT1
+#define UDP_CLIENT_PING_BIT BIT2
 #define UDP_SERVER_BIND_BIT BIT0
 #define UDP_SERVER_SEND_BIT BIT1
 #define UDP_SERVER_CLOSE_BIT BIT2
@@ -44,6 +45,12 @@ typedef struct send_meaasge {
     char message[128];
 } SEND_MESSAGE;
 
+typedef struct udp_ping_config {
+    int count;       /* the number of probes */
+    int interval_ms; /* the time between two probes */
+    int size;        /* the UDP payload size of a probe */
+} UDP_PING_CONFIG;
+
 typedef struct udp_server {
     int exist;
     int sock;
@@ -51,6 +58,7 @@ typedef struct udp_server {
     char local_ipaddr[128];
     struct ifreq ifr;
     SEND_MESSAGE messagesend;
+    int echo; /* reflect the probes of "udpsockclient ping" to their sender */
 } UDP_SERVER;
 
 typedef struct udp_client {
@@ -60,6 +68,7 @@ typedef struct udp_client {
     char local_ipaddr[128];
     struct ifreq ifr;
     SEND_MESSAGE messagesend;
+    UDP_PING_CONFIG ping;
 } UDP_CLIENT;
 
 /**
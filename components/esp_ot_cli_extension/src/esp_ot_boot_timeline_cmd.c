@@ -0,0 +1,36 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "esp_ot_boot_timeline_cmd.h"
+#include "esp_err.h"
+#include "esp_ot_boot_timeline.h"
+#include "openthread/cli.h"
+
+otError esp_ot_process_boot_timeline(void *aContext, uint8_t aArgsLength, char *aArgs[])
+{
+    (void)(aContext);
+    (void)(aArgs);
+    int64_t previous_us = 0;
+
+    if (aArgsLength != 0) {
+        otCliOutputFormat("---boottime parameter---\n");
+        otCliOutputFormat("boottime                      :     print the time at which each boot stage completed\n");
+        return OT_ERROR_INVALID_ARGS;
+    }
+    otCliOutputFormat("%-16s %10s %10s\n", "stage", "time(ms)", "delta(ms)");
+    for (int stage = 0; stage < ESP_OT_BOOT_STAGE_MAX; stage++) {
+        int64_t time_us;
+        if (esp_ot_boot_timeline_get(stage, &time_us) != ESP_OK) {
+            otCliOutputFormat("%-16s %10s\n", esp_ot_boot_stage_to_str(stage), "pending");
+            continue;
+        }
+        // The backbone stages run in parallel, a stage may complete before the one listed above it.
+        otCliOutputFormat("%-16s %10d %+10d\n", esp_ot_boot_stage_to_str(stage), (int)(time_us / 1000),
+                          (int)((time_us - previous_us) / 1000));
+        previous_us = time_us;
+    }
+    return OT_ERROR_NONE;
+}
@@ -6,6 +6,7 @@
 
 #include "esp_ot_cli_extension.h"
 #include "esp_openthread.h"
+#include "esp_ot_boot_timeline_cmd.h"
 #include "esp_ot_br_lib_compati_check.h"
 #include "esp_ot_curl.h"
 #include "esp_ot_dns64.h"
@@ -15,6 +16,7 @@
 #include "esp_ot_loglevel.h"
 #include "esp_ot_nvs_diag.h"
 #include "esp_ot_ota_commands.h"
+#include "esp_ot_perf.h"
 #include "esp_ot_rcp_commands.h"
 #include "esp_ot_tcp_socket.h"
 #include "esp_ot_udp_socket.h"
@@ -25,6 +27,9 @@
 #include "openthread/cli.h"
 
 static const otCliCommand kCommands[] = {
+#if CONFIG_OPENTHREAD_CLI_BOOT_TIMELINE
+    {"boottime", esp_ot_process_boot_timeline},
+#endif // CONFIG_OPENTHREAD_CLI_BOOT_TIMELINE
     {"curl", esp_openthread_process_curl},
 #if CONFIG_OPENTHREAD_DNS64_CLIENT
     {"dns64server", esp_openthread_process_dns64_server},
@@ -40,6 +45,7 @@ static const otCliCommand kCommands[] = {
 #if CONFIG_OPENTHREAD_CLI_OTA
     {"ota", esp_openthread_process_ota_command},
 #endif // CONFIG_OPENTHREAD_CLI_OTA
+    {"otperf", esp_ot_process_perf},
 #if CONFIG_OPENTHREAD_RCP_COMMAND
     {"otrcp", esp_openthread_process_rcp_command},
 #endif // CONFIG_OPENTHREAD_RCP_COMMAND
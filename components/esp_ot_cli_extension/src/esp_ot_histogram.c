@@ -0,0 +1,79 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "esp_ot_histogram.h"
+
+#include <string.h>
+
+/*
+ * A value below 2 * ESP_OT_HISTOGRAM_SUB_BUCKET_NUM is its own bucket. A larger value with its highest bit at
+ * position msb is counted by its ESP_OT_HISTOGRAM_SUB_BUCKET_BITS bits below the highest one, in the buckets of the
+ * power of two msb.
+ */
+static uint32_t get_bucket_index(uint32_t value)
+{
+    if (value < 2 * ESP_OT_HISTOGRAM_SUB_BUCKET_NUM) {
+        return value;
+    }
+    uint32_t msb = 31 - __builtin_clz(value);
+    uint32_t shift = msb - ESP_OT_HISTOGRAM_SUB_BUCKET_BITS;
+    return (shift + 1) * ESP_OT_HISTOGRAM_SUB_BUCKET_NUM + ((value >> shift) & (ESP_OT_HISTOGRAM_SUB_BUCKET_NUM - 1));
+}
+
+static uint32_t get_bucket_highest_value(uint32_t index)
+{
+    if (index < 2 * ESP_OT_HISTOGRAM_SUB_BUCKET_NUM) {
+        return index;
+    }
+    uint32_t shift = index / ESP_OT_HISTOGRAM_SUB_BUCKET_NUM - 1;
+    uint64_t lowest = (uint64_t)(ESP_OT_HISTOGRAM_SUB_BUCKET_NUM + index % ESP_OT_HISTOGRAM_SUB_BUCKET_NUM) << shift;
+    uint64_t highest = lowest + ((uint64_t)1 << shift) - 1;
+    return highest > UINT32_MAX ? UINT32_MAX : (uint32_t)highest;
+}
+
+void esp_ot_histogram_reset(esp_ot_histogram_t *histogram)
+{
+    memset(histogram, 0, sizeof(*histogram));
+    histogram->min = UINT32_MAX;
+}
+
+void esp_ot_histogram_record(esp_ot_histogram_t *histogram, uint32_t value)
+{
+    histogram->counts[get_bucket_index(value)]++;
+    histogram->count++;
+    histogram->sum += value;
+    if (value < histogram->min) {
+        histogram->min = value;
+    }
+    if (value > histogram->max) {
+        histogram->max = value;
+    }
+}
+
+uint32_t esp_ot_histogram_percentile(const esp_ot_histogram_t *histogram, uint32_t percentile)
+{
+    if (histogram->count == 0) {
+        return 0;
+    }
+    // The rank of the percentile, rounded up so that p100 is the last value and p0 the first.
+    uint64_t rank = ((uint64_t)histogram->count * (percentile > 100 ? 100 : percentile) + 99) / 100;
+    uint64_t seen = 0;
+
+    rank = rank == 0 ? 1 : rank;
+    for (uint32_t index = 0; index < ESP_OT_HISTOGRAM_BUCKET_NUM; index++) {
+        seen += histogram->counts[index];
+        if (seen >= rank) {
+            uint32_t value = get_bucket_highest_value(index);
+            return value > histogram->max ? histogram->max : value;
+        }
+    }
+    return histogram->max;
+}
+
+uint32_t esp_ot_histogram_mean(const esp_ot_histogram_t *histogram)
+{
+    return histogram->count ? (uint32_t)(histogram->sum / histogram->count) : 0;
+}
@@ -6,6 +6,8 @@
 
 #include "esp_ot_ota_commands.h"
 
+#include <inttypes.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "esp_br_http_ota.h"
@@ -14,12 +16,28 @@
 #include "esp_ot_cli_extension.h"
 #include "freertos/idf_additions.h"
 #include "openthread/cli.h"
+#include "sdkconfig.h"
+
+#define OTA_BENCH_TASK_STACK_SIZE 4096
+// The download task runs the TLS session and flashes the RCP from the stored image if the streamed firmware fails.
+#define OTA_IMAGE_DOWNLOAD_TASK_STACK_SIZE 8192
+// The manifest task runs the TLS session of the manifest.
+#define OTA_MANIFEST_TASK_STACK_SIZE 8192
+
+typedef struct {
+    char *url;
+    esp_http_client_config_t http_config;
+    esp_br_http_ota_bench_config_t bench_config;
+} ota_bench_ctx_t;
 
 static const char *s_server_cert = NULL;
 
 static void print_help(void)
 {
     otCliOutputFormat("rcp download ${server_url}\n");
+    otCliOutputFormat("ota bench ${server_url} [null|storage confirm] [-r <read_size>] [-b <rx_buffer_size>] "
+                      "[-x <tx_buffer_size>] [-o <timeout_ms>] [-k <keep_alive_idle_s>]\n");
+    otCliOutputFormat("ota manifest ${manifest_url}\n");
 }
 
 static void ota_image_download_task(void *ctx)
@@ -43,6 +61,139 @@ static void ota_image_download_task(void *ctx)
     vTaskDelete(NULL);
 }
 
+static void ota_manifest_task(void *ctx)
+{
+    char *url = (char *)ctx;
+    esp_err_t err = ESP_OK;
+    bool updated = false;
+    esp_http_client_config_t config = {
+        .url = url,
+        .cert_pem = s_server_cert,
+        .event_handler = NULL,
+        .keep_alive_enable = true,
+    };
+    err = esp_br_http_ota_manifest(&config, &updated);
+    free(url);
+    if (err != ESP_OK) {
+        otCliOutputFormat("Failed to update from the manifest: %s\n", esp_err_to_name(err));
+    } else if (updated) {
+        // Both components are switched, restart.
+        esp_restart();
+    } else {
+        otCliOutputFormat("The RCP image and the Border Router firmware are up to date\n");
+    }
+    vTaskDelete(NULL);
+}
+
+static void print_bench_phase(const char *name, uint32_t bytes, int64_t time_us)
+{
+    uint32_t kbytes_per_sec = time_us > 0 ? (uint32_t)((uint64_t)bytes * 1000000 / time_us / 1024) : 0;
+
+    otCliOutputFormat("%-12s %10" PRIu32 " bytes %8" PRIu32 " ms %8" PRIu32 " KB/s\n", name, bytes,
+                      (uint32_t)(time_us / 1000), kbytes_per_sec);
+}
+
+static void ota_bench_task(void *ctx)
+{
+    ota_bench_ctx_t *bench = (ota_bench_ctx_t *)ctx;
+    esp_br_http_ota_bench_result_t result;
+
+    esp_err_t err = esp_br_http_ota_bench(&bench->http_config, &bench->bench_config, &result);
+    if (err != ESP_OK) {
+        otCliOutputFormat("Failed to benchmark the download: %s\n", esp_err_to_name(err));
+    } else {
+        otCliOutputFormat("read size %u, http rx buffer %d, tx buffer %d, tcp wnd %d, recvmbox %d\n",
+                          bench->bench_config.read_size ? bench->bench_config.read_size
+                                                        : CONFIG_BR_HTTP_OTA_READ_SIZE,
+                          bench->http_config.buffer_size, bench->http_config.buffer_size_tx,
+                          CONFIG_LWIP_TCP_WND_DEFAULT, CONFIG_LWIP_TCP_RECVMBOX_SIZE);
+        otCliOutputFormat("connect      %8" PRIu32 " ms\n", (uint32_t)(result.connect_us / 1000));
+        print_bench_phase("network", result.network_bytes, result.network_us);
+        if (bench->bench_config.sink == ESP_BR_HTTP_OTA_BENCH_SINK_STORAGE) {
+            print_bench_phase("rcp store", result.rcp_store_bytes, result.rcp_store_us);
+            print_bench_phase("host write", result.host_write_bytes, result.host_write_us);
+        }
+        print_bench_phase("total", result.network_bytes, result.total_us);
+    }
+    free(bench->url);
+    free(bench);
+    vTaskDelete(NULL);
+}
+
+static otError process_ota_bench(uint8_t aArgsLength, char *aArgs[])
+{
+    otError error = OT_ERROR_NONE;
+    ota_bench_ctx_t *bench = NULL;
+
+    if (aArgsLength < 2) {
+        print_help();
+        return OT_ERROR_INVALID_ARGS;
+    }
+    bench = calloc(1, sizeof(ota_bench_ctx_t));
+    if (!bench || !(bench->url = strdup(aArgs[1]))) {
+        free(bench);
+        return OT_ERROR_NO_BUFS;
+    }
+    bench->http_config.url = bench->url;
+    bench->http_config.cert_pem = s_server_cert;
+    bench->http_config.keep_alive_enable = true;
+    bench->bench_config.sink = ESP_BR_HTTP_OTA_BENCH_SINK_NULL;
+    for (int i = 2; i < aArgsLength; i++) {
+        if (strcmp(aArgs[i], "null") == 0) {
+            bench->bench_config.sink = ESP_BR_HTTP_OTA_BENCH_SINK_NULL;
+            continue;
+        } else if (strcmp(aArgs[i], "storage") == 0) {
+            bench->bench_config.sink = ESP_BR_HTTP_OTA_BENCH_SINK_STORAGE;
+            continue;
+        } else if (strcmp(aArgs[i], "confirm") == 0) {
+            bench->bench_config.confirm_overwrite = true;
+            continue;
+        }
+        // The other options take a positive value.
+        if (i + 1 >= aArgsLength || atoi(aArgs[i + 1]) <= 0) {
+            error = OT_ERROR_INVALID_ARGS;
+            goto exit;
+        }
+        int value = atoi(aArgs[i + 1]);
+        if (strcmp(aArgs[i], "-r") == 0) {
+            bench->bench_config.read_size = value;
+        } else if (strcmp(aArgs[i], "-b") == 0) {
+            bench->http_config.buffer_size = value;
+        } else if (strcmp(aArgs[i], "-x") == 0) {
+            bench->http_config.buffer_size_tx = value;
+        } else if (strcmp(aArgs[i], "-o") == 0) {
+            bench->http_config.timeout_ms = value;
+        } else if (strcmp(aArgs[i], "-k") == 0) {
+            bench->http_config.keep_alive_idle = value;
+        } else {
+            error = OT_ERROR_INVALID_ARGS;
+            goto exit;
+        }
+        i++;
+    }
+    if (bench->bench_config.sink == ESP_BR_HTTP_OTA_BENCH_SINK_STORAGE) {
+        if (!bench->bench_config.confirm_overwrite) {
+            otCliOutputFormat("storage overwrites the backup RCP image and the next OTA partition and erases the "
+                              "OTA checkpoint, add confirm to run it\n");
+            error = OT_ERROR_INVALID_ARGS;
+            goto exit;
+        }
+        otCliOutputFormat("Warning: overwriting the backup RCP image and the next OTA partition\n");
+    }
+    if (xTaskCreate(ota_bench_task, "ota_bench", OTA_BENCH_TASK_STACK_SIZE, bench, 5, NULL) != pdPASS) {
+        error = OT_ERROR_NO_BUFS;
+    }
+exit:
+    if (error != OT_ERROR_NONE) {
+        if (error == OT_ERROR_INVALID_ARGS) {
+            print_help();
+        }
+        free(bench->url);
+        free(bench);
+    }
+    return error;
+}
+
 otError esp_openthread_process_ota_command(void *aContext, uint8_t aArgsLength, char *aArgs[])
 {
     if (aArgsLength == 0) {
@@ -55,7 +206,26 @@ otError esp_openthread_process_ota_command(void *aContext, uint8_t aArgsLength,
             if (!url) {
                 return OT_ERROR_NO_BUFS;
             }
-            xTaskCreate(ota_image_download_task, "ota_image_download", 3072, url, 5, NULL);
+            if (xTaskCreate(ota_image_download_task, "ota_image_download", OTA_IMAGE_DOWNLOAD_TASK_STACK_SIZE, url,
+                            5, NULL) != pdPASS) {
+                free(url);
+                return OT_ERROR_NO_BUFS;
+            }
+        }
+    } else if (strcmp(aArgs[0], "bench") == 0) {
+        return process_ota_bench(aArgsLength, aArgs);
+    } else if (strcmp(aArgs[0], "manifest") == 0) {
+        if (aArgsLength != 2) {
+            print_help();
+        } else {
+            char *url = strdup(aArgs[1]);
+            if (!url) {
+                return OT_ERROR_NO_BUFS;
+            }
+            if (xTaskCreate(ota_manifest_task, "ota_manifest", OTA_MANIFEST_TASK_STACK_SIZE, url, 5, NULL) != pdPASS) {
+                free(url);
+                return OT_ERROR_NO_BUFS;
+            }
         }
     } else {
         print_help();
@@ -0,0 +1,516 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "esp_ot_perf.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_openthread.h"
+#include "esp_openthread_lock.h"
+#include "esp_ot_cli_extension.h"
+#include "esp_ot_histogram.h"
+#include "esp_ot_iperf.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "openthread/cli.h"
+#include "openthread/message.h"
+#include "openthread/udp.h"
+
+#define OT_PERF_MAGIC 0x4f545046 /* "OTPF" */
+#define OT_PERF_DEFAULT_TIME 10
+#define OT_PERF_DEFAULT_ECHO_INTERVAL 10
+#define OT_PERF_MAX_LEN 1232 /* the UDP payload of an IPv6 packet of the minimum MTU */
+#define OT_PERF_FIN_RETRY_NUM 8
+#define OT_PERF_FIN_INTERVAL_MS 250
+#define OT_PERF_CLIENT_TASK_STACK_SIZE 3072
+#define OT_PERF_CLIENT_TASK_PRIORITY 4
+
+typedef enum {
+    OT_PERF_PACKET_DATA = 0, /* a data packet from the client */
+    OT_PERF_PACKET_ECHO,     /* the header of a data packet reflected by the server */
+    OT_PERF_PACKET_FIN,      /* the end of the test, the server answers with its report */
+    OT_PERF_PACKET_REPORT,   /* the report of the server */
+} ot_perf_packet_type_t;
+
+#define OT_PERF_FLAG_ECHO_REQUEST (1 << 0)
+
+// The header of every otperf packet, in the byte order of the chip on both ends.
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint8_t type;
+    uint8_t flags;
+    uint16_t reserved;
+    uint32_t session;
+    uint32_t seq;
+    int64_t tx_time_us;
+} ot_perf_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t packets;
+    uint32_t bytes;
+    uint32_t duration_us; /* from the first to the last data packet received */
+    uint32_t lost;
+    uint32_t reordered;
+    uint32_t delay_us[4]; /* the p50, p90, p99 and max one-way delay above the lowest one */
+} ot_perf_report_t;
+
+typedef struct {
+    otUdpSocket socket;
+    bool is_server;
+    // client
+    otSockAddr peer;
+    uint16_t len;
+    uint32_t rate_kbps;
+    uint32_t time_s;
+    uint32_t echo_interval;
+    uint8_t *payload;
+    volatile bool stop;
+    uint32_t sent_packets;
+    uint32_t sent_bytes;
+    uint32_t no_bufs;
+    int64_t send_us;
+    esp_ot_histogram_t rtt;
+    bool report_received;
+    ot_perf_report_t report;
+    // server
+    uint32_t session;
+    uint32_t packets;
+    uint32_t bytes;
+    uint32_t highest_seq;
+    uint32_t reordered;
+    int64_t first_rx_us;
+    int64_t last_rx_us;
+    int64_t min_offset_us;
+    bool report_printed;
+    esp_ot_histogram_t delay;
+} ot_perf_t;
+
+static ot_perf_t *s_perf = NULL;
+
+static otError send_packet(ot_perf_t *perf, const otIp6Address *address, uint16_t port, const void *data,
+                           uint16_t len)
+{
+    otInstance *instance = esp_openthread_get_instance();
+    otMessageInfo message_info;
+    otError error = OT_ERROR_NONE;
+    otMessage *message = otUdpNewMessage(instance, NULL);
+
+    if (message == NULL) {
+        return OT_ERROR_NO_BUFS;
+    }
+    memset(&message_info, 0, sizeof(message_info));
+    message_info.mPeerAddr = *address;
+    message_info.mPeerPort = port;
+    error = otMessageAppend(message, data, len);
+    if (error == OT_ERROR_NONE) {
+        error = otUdpSend(instance, &perf->socket, message, &message_info);
+    }
+    if (error != OT_ERROR_NONE) {
+        otMessageFree(message);
+    }
+    return error;
+}
+
+static uint32_t get_rate_kbps(uint32_t bytes, int64_t time_us)
+{
+    return time_us > 0 ? (uint32_t)((uint64_t)bytes * 8000 / time_us) : 0;
+}
+
+static void print_report(const ot_perf_report_t *report)
+{
+    uint32_t expected = report->packets + report->lost;
+    uint32_t loss_bp = expected ? (uint32_t)((uint64_t)report->lost * 10000 / expected) : 0;
+
+    otCliOutputFormat("received %" PRIu32 " packets, %" PRIu32 " bytes in %" PRIu32 " ms, goodput %" PRIu32 " kbps\n",
+                      report->packets, report->bytes, report->duration_us / 1000,
+                      get_rate_kbps(report->bytes, report->duration_us));
+    otCliOutputFormat("lost %" PRIu32 " (%" PRIu32 ".%02" PRIu32 "%%), reordered %" PRIu32 "\n", report->lost,
+                      loss_bp / 100, loss_bp % 100, report->reordered);
+    otCliOutputFormat("one-way delay above the lowest (us): p50 %" PRIu32 " p90 %" PRIu32 " p99 %" PRIu32
+                      " max %" PRIu32 "\n",
+                      report->delay_us[0], report->delay_us[1], report->delay_us[2], report->delay_us[3]);
+}
+
+static void reset_server_session(ot_perf_t *perf, uint32_t session)
+{
+    perf->session = session;
+    perf->packets = 0;
+    perf->bytes = 0;
+    perf->highest_seq = 0;
+    perf->reordered = 0;
+    perf->report_printed = false;
+    esp_ot_histogram_reset(&perf->delay);
+}
+
+static void build_report(const ot_perf_t *perf, ot_perf_report_t *report)
+{
+    report->packets = perf->packets;
+    report->bytes = perf->bytes;
+    report->duration_us = perf->packets ? (uint32_t)(perf->last_rx_us - perf->first_rx_us) : 0;
+    report->lost = perf->packets && perf->highest_seq + 1 > perf->packets ? perf->highest_seq + 1 - perf->packets : 0;
+    report->reordered = perf->reordered;
+    report->delay_us[0] = esp_ot_histogram_percentile(&perf->delay, 50);
+    report->delay_us[1] = esp_ot_histogram_percentile(&perf->delay, 90);
+    report->delay_us[2] = esp_ot_histogram_percentile(&perf->delay, 99);
+    report->delay_us[3] = perf->delay.max;
+}
+
+static void handle_server_packet(ot_perf_t *perf, const ot_perf_header_t *header, uint16_t len,
+                                 const otMessageInfo *message_info, int64_t now)
+{
+    if (header->type == OT_PERF_PACKET_DATA) {
+        if (perf->packets == 0 || header->session != perf->session) {
+            char addr[OT_IP6_ADDRESS_STRING_SIZE];
+            otIp6AddressToString(&message_info->mPeerAddr, addr, sizeof(addr));
+            otCliOutputFormat("otperf: session %08" PRIx32 " from [%s]:%u\n", header->session, addr,
+                              message_info->mPeerPort);
+            reset_server_session(perf, header->session);
+            perf->first_rx_us = now;
+            perf->highest_seq = header->seq;
+            perf->min_offset_us = now - header->tx_time_us;
+        } else if (header->seq > perf->highest_seq) {
+            perf->highest_seq = header->seq;
+        } else {
+            perf->reordered++;
+        }
+        perf->packets++;
+        perf->bytes += len;
+        perf->last_rx_us = now;
+        // The clocks of both ends are not synchronized, only the delay above the lowest one seen is meaningful.
+        int64_t offset_us = now - header->tx_time_us;
+        if (offset_us < perf->min_offset_us) {
+            perf->min_offset_us = offset_us;
+        }
+        int64_t delay_us = offset_us - perf->min_offset_us;
+        esp_ot_histogram_record(&perf->delay, delay_us > UINT32_MAX ? UINT32_MAX : (uint32_t)delay_us);
+        if (header->flags & OT_PERF_FLAG_ECHO_REQUEST) {
+            ot_perf_header_t echo = *header;
+            echo.type = OT_PERF_PACKET_ECHO;
+            echo.flags = 0;
+            send_packet(perf, &message_info->mPeerAddr, message_info->mPeerPort, &echo, sizeof(echo));
+        }
+    } else if (header->type == OT_PERF_PACKET_FIN && header->session == perf->session) {
+        struct __attribute__((packed)) {
+            ot_perf_header_t header;
+            ot_perf_report_t report;
+        } packet;
+        packet.header = *header;
+        packet.header.type = OT_PERF_PACKET_REPORT;
+        build_report(perf, &packet.report);
+        // The client repeats the FIN until it gets the report, it is printed once.
+        if (!perf->report_printed) {
+            otCliOutputFormat("otperf: session %08" PRIx32 " ended\n", perf->session);
+            print_report(&packet.report);
+            perf->report_printed = true;
+        }
+        send_packet(perf, &message_info->mPeerAddr, message_info->mPeerPort, &packet, sizeof(packet));
+    }
+}
+
+static void handle_client_packet(ot_perf_t *perf, const otMessage *message, const ot_perf_header_t *header,
+                                 int64_t now)
+{
+    if (header->session != perf->session) {
+        return;
+    }
+    if (header->type == OT_PERF_PACKET_ECHO) {
+        int64_t rtt_us = now - header->tx_time_us;
+        esp_ot_histogram_record(&perf->rtt, rtt_us > UINT32_MAX ? UINT32_MAX : (uint32_t)rtt_us);
+    } else if (header->type == OT_PERF_PACKET_REPORT &&
+               otMessageRead(message, otMessageGetOffset(message) + sizeof(*header), &perf->report,
+                             sizeof(perf->report)) == sizeof(perf->report)) {
+        perf->report_received = true;
+    }
+}
+
+// Called by the OpenThread task, with the OpenThread lock held.
+static void handle_udp_receive(void *context, otMessage *message, const otMessageInfo *message_info)
+{
+    ot_perf_t *perf = (ot_perf_t *)context;
+    int64_t now = esp_timer_get_time();
+    uint16_t offset = otMessageGetOffset(message);
+    uint16_t len = otMessageGetLength(message) - offset;
+    ot_perf_header_t header;
+
+    if (otMessageRead(message, offset, &header, sizeof(header)) != sizeof(header) || header.magic != OT_PERF_MAGIC) {
+        return;
+    }
+    if (perf->is_server) {
+        handle_server_packet(perf, &header, len, message_info, now);
+    } else {
+        handle_client_packet(perf, message, &header, now);
+    }
+}
+
+static otError open_socket(ot_perf_t *perf, uint16_t port)
+{
+    otInstance *instance = esp_openthread_get_instance();
+    otSockAddr sock_addr;
+    otError error = OT_ERROR_NONE;
+
+    memset(&sock_addr, 0, sizeof(sock_addr));
+    sock_addr.mPort = port;
+    error = otUdpOpen(instance, &perf->socket, handle_udp_receive, perf);
+    if (error == OT_ERROR_NONE) {
+        error = otUdpBind(instance, &perf->socket, &sock_addr, OT_NETIF_THREAD);
+        if (error != OT_ERROR_NONE) {
+            otUdpClose(instance, &perf->socket);
+        }
+    }
+    return error;
+}
+
+static void free_perf(ot_perf_t *perf)
+{
+    otUdpClose(esp_openthread_get_instance(), &perf->socket);
+    free(perf->payload);
+    free(perf);
+}
+
+static void print_client_result(const ot_perf_t *perf)
+{
+    otCliOutputFormat("sent %" PRIu32 " packets, %" PRIu32 " bytes in %" PRIu32 " ms, %" PRIu32
+                      " kbps, %" PRIu32 " retries for message buffers\n",
+                      perf->sent_packets, perf->sent_bytes, (uint32_t)(perf->send_us / 1000),
+                      get_rate_kbps(perf->sent_bytes, perf->send_us), perf->no_bufs);
+    if (perf->rtt.count) {
+        otCliOutputFormat("rtt of %" PRIu32 " echoes (us): min %" PRIu32 " p50 %" PRIu32 " p90 %" PRIu32
+                          " p99 %" PRIu32 " max %" PRIu32 "\n",
+                          perf->rtt.count, perf->rtt.min, esp_ot_histogram_percentile(&perf->rtt, 50),
+                          esp_ot_histogram_percentile(&perf->rtt, 90), esp_ot_histogram_percentile(&perf->rtt, 99),
+                          perf->rtt.max);
+    }
+    if (perf->report_received) {
+        print_report(&perf->report);
+    } else {
+        otCliOutputFormat("no report from the server\n");
+    }
+}
+
+static void ot_perf_client_task(void *ctx)
+{
+    ot_perf_t *perf = (ot_perf_t *)ctx;
+    ot_perf_header_t *header = (ot_perf_header_t *)perf->payload;
+    // The time between two packets at the configured rate, 0 to send as fast as the message buffers allow.
+    int64_t interval_us = perf->rate_kbps ? (int64_t)perf->len * 8000 / perf->rate_kbps : 0;
+    int64_t start_us = esp_timer_get_time();
+    int64_t end_us = start_us + (int64_t)perf->time_s * 1000000;
+    int64_t next_us = start_us;
+
+    while (!perf->stop) {
+        int64_t now = esp_timer_get_time();
+        if (now >= end_us) {
+            break;
+        }
+        if (now < next_us) {
+            // The packets due during the delay are sent in a burst after it.
+            TickType_t ticks = pdMS_TO_TICKS((next_us - now) / 1000);
+            vTaskDelay(ticks ? ticks : 1);
+            continue;
+        }
+        header->type = OT_PERF_PACKET_DATA;
+        header->seq = perf->sent_packets;
+        header->flags = perf->echo_interval && perf->sent_packets % perf->echo_interval == 0
+            ? OT_PERF_FLAG_ECHO_REQUEST
+            : 0;
+        header->tx_time_us = now;
+        esp_openthread_lock_acquire(portMAX_DELAY);
+        otError error = send_packet(perf, &perf->peer.mAddress, perf->peer.mPort, perf->payload, perf->len);
+        esp_openthread_lock_release();
+        if (error == OT_ERROR_NO_BUFS) {
+            // The message pool is exhausted, let the OpenThread task drain it and send the same packet again.
+            perf->no_bufs++;
+            vTaskDelay(1);
+            continue;
+        } else if (error != OT_ERROR_NONE) {
+            ESP_LOGE(OT_EXT_CLI_TAG, "otperf: failed to send: %s", otThreadErrorToString(error));
+            break;
+        }
+        perf->sent_packets++;
+        perf->sent_bytes += perf->len;
+        next_us += interval_us;
+    }
+    perf->send_us = esp_timer_get_time() - start_us;
+
+    ot_perf_header_t fin = *header;
+    fin.type = OT_PERF_PACKET_FIN;
+    fin.flags = 0;
+    for (int i = 0; i < OT_PERF_FIN_RETRY_NUM; i++) {
+        esp_openthread_lock_acquire(portMAX_DELAY);
+        bool report_received = perf->report_received;
+        if (!report_received) {
+            fin.tx_time_us = esp_timer_get_time();
+            send_packet(perf, &perf->peer.mAddress, perf->peer.mPort, &fin, sizeof(fin));
+        }
+        esp_openthread_lock_release();
+        if (report_received) {
+            break;
+        }
+        vTaskDelay(pdMS_TO_TICKS(OT_PERF_FIN_INTERVAL_MS));
+    }
+
+    esp_openthread_lock_acquire(portMAX_DELAY);
+    print_client_result(perf);
+    free_perf(perf);
+    s_perf = NULL;
+    esp_openthread_lock_release();
+    vTaskDelete(NULL);
+}
+
+static void print_help(void)
+{
+    otCliOutputFormat("---otperf parameter---\n");
+    otCliOutputFormat("server [-p <port>]              :     receive the packets of the clients and report\n");
+    otCliOutputFormat("client <addr> [-p <port>]       :     send packets to the server for a time\n");
+    otCliOutputFormat("    [-l <len>]                  :     the UDP payload length, default %d\n",
+                      OT_IPERF_DEFAULT_LEN);
+    otCliOutputFormat("    [-b <kbps>]                 :     the sending rate, default 0 for as fast as possible\n");
+    otCliOutputFormat("    [-t <time>]                 :     time in seconds to send for, default %d\n",
+                      OT_PERF_DEFAULT_TIME);
+    otCliOutputFormat("    [-e <n>]                    :     request an echo of every n-th packet, default %d, 0 "
+                      "for none\n",
+                      OT_PERF_DEFAULT_ECHO_INTERVAL);
+    otCliOutputFormat("stop                            :     stop the server or the client\n");
+    otCliOutputFormat("---example---\n");
+    otCliOutputFormat("start a server      :     otperf server\n");
+    otCliOutputFormat("start a client      :     otperf client fd00::1 -l 81 -b 100 -t 20\n");
+}
+
+static otError parse_client_args(ot_perf_t *perf, uint8_t aArgsLength, char *aArgs[])
+{
+    perf->len = OT_IPERF_DEFAULT_LEN;
+    perf->time_s = OT_PERF_DEFAULT_TIME;
+    perf->echo_interval = OT_PERF_DEFAULT_ECHO_INTERVAL;
+    perf->peer.mPort = OT_PERF_DEFAULT_PORT;
+    if (aArgsLength < 2 || otIp6AddressFromString(aArgs[1], &perf->peer.mAddress) != OT_ERROR_NONE) {
+        return OT_ERROR_INVALID_ARGS;
+    }
+    for (int i = 2; i < aArgsLength; i++) {
+        if (i + 1 >= aArgsLength) {
+            return OT_ERROR_INVALID_ARGS;
+        }
+        long value = strtol(aArgs[i + 1], NULL, 10);
+        if (strcmp(aArgs[i], "-p") == 0 && value > 0 && value <= UINT16_MAX) {
+            perf->peer.mPort = value;
+        } else if (strcmp(aArgs[i], "-l") == 0 && value >= (long)sizeof(ot_perf_header_t) &&
+                   value <= OT_PERF_MAX_LEN) {
+            perf->len = value;
+        } else if (strcmp(aArgs[i], "-b") == 0 && value >= 0) {
+            perf->rate_kbps = value;
+        } else if (strcmp(aArgs[i], "-t") == 0 && value > 0) {
+            perf->time_s = value;
+        } else if (strcmp(aArgs[i], "-e") == 0 && value >= 0) {
+            perf->echo_interval = value;
+        } else {
+            return OT_ERROR_INVALID_ARGS;
+        }
+        i++;
+    }
+    return OT_ERROR_NONE;
+}
+
+static otError start_client(uint8_t aArgsLength, char *aArgs[])
+{
+    otError ret = OT_ERROR_NONE;
+    ot_perf_t *perf = calloc(1, sizeof(ot_perf_t));
+
+    ESP_RETURN_ON_FALSE(perf, OT_ERROR_NO_BUFS, OT_EXT_CLI_TAG, "Failed to allocate otperf");
+    ESP_GOTO_ON_FALSE(parse_client_args(perf, aArgsLength, aArgs) == OT_ERROR_NONE, OT_ERROR_INVALID_ARGS, exit,
+                      OT_EXT_CLI_TAG, "Invalid otperf client arguments");
+    // The payload is built once, only the header is updated for each packet.
+    perf->payload = malloc(perf->len);
+    ESP_GOTO_ON_FALSE(perf->payload, OT_ERROR_NO_BUFS, exit, OT_EXT_CLI_TAG, "Failed to allocate otperf payload");
+    for (uint16_t i = sizeof(ot_perf_header_t); i < perf->len; i++) {
+        perf->payload[i] = i;
+    }
+    ot_perf_header_t *header = (ot_perf_header_t *)perf->payload;
+    memset(header, 0, sizeof(*header));
+    header->magic = OT_PERF_MAGIC;
+    header->session = esp_random();
+    perf->session = header->session;
+    esp_ot_histogram_reset(&perf->rtt);
+    otError error = open_socket(perf, 0);
+    ESP_GOTO_ON_FALSE(error == OT_ERROR_NONE, error, exit, OT_EXT_CLI_TAG, "Failed to open otperf socket");
+    if (xTaskCreate(ot_perf_client_task, "ot_perf_client", OT_PERF_CLIENT_TASK_STACK_SIZE, perf,
+                    OT_PERF_CLIENT_TASK_PRIORITY, NULL) != pdPASS) {
+        otUdpClose(esp_openthread_get_instance(), &perf->socket);
+        ret = OT_ERROR_NO_BUFS;
+        goto exit;
+    }
+    s_perf = perf;
+    otCliOutputFormat("otperf: sending %u-byte packets to port %u for %" PRIu32 " s\n", perf->len, perf->peer.mPort,
+                      perf->time_s);
+exit:
+    if (ret != OT_ERROR_NONE) {
+        free(perf->payload);
+        free(perf);
+    }
+    return ret;
+}
+
+static otError start_server(uint8_t aArgsLength, char *aArgs[])
+{
+    otError error = OT_ERROR_NONE;
+    long port = OT_PERF_DEFAULT_PORT;
+    ot_perf_t *perf = NULL;
+
+    if (aArgsLength == 3 && strcmp(aArgs[1], "-p") == 0) {
+        port = strtol(aArgs[2], NULL, 10);
+    } else if (aArgsLength != 1) {
+        return OT_ERROR_INVALID_ARGS;
+    }
+    ESP_RETURN_ON_FALSE(port > 0 && port <= UINT16_MAX, OT_ERROR_INVALID_ARGS, OT_EXT_CLI_TAG, "Invalid port");
+    perf = calloc(1, sizeof(ot_perf_t));
+    ESP_RETURN_ON_FALSE(perf, OT_ERROR_NO_BUFS, OT_EXT_CLI_TAG, "Failed to allocate otperf");
+    perf->is_server = true;
+    reset_server_session(perf, 0);
+    error = open_socket(perf, port);
+    if (error != OT_ERROR_NONE) {
+        free(perf);
+        return error;
+    }
+    s_perf = perf;
+    otCliOutputFormat("otperf: server listening on port %ld\n", port);
+    return OT_ERROR_NONE;
+}
+
+otError esp_ot_process_perf(void *aContext, uint8_t aArgsLength, char *aArgs[])
+{
+    (void)(aContext);
+
+    if (aArgsLength == 0) {
+        print_help();
+    } else if (strcmp(aArgs[0], "stop") == 0) {
+        if (s_perf == NULL) {
+            return OT_ERROR_INVALID_STATE;
+        }
+        if (s_perf->is_server) {
+            free_perf(s_perf);
+            s_perf = NULL;
+        } else {
+            // The client task prints the result of the packets sent so far and frees it.
+            s_perf->stop = true;
+        }
+    } else if (s_perf) {
+        otCliOutputFormat("otperf is running, stop it first\n");
+        return OT_ERROR_BUSY;
+    } else if (strcmp(aArgs[0], "server") == 0) {
+        return start_server(aArgsLength, aArgs);
+    } else if (strcmp(aArgs[0], "client") == 0) {
+        return start_client(aArgsLength, aArgs);
+    } else {
+        print_help();
+        return OT_ERROR_INVALID_ARGS;
+    }
+    return OT_ERROR_NONE;
+}
@@ -15,6 +15,10 @@
 #include "esp_openthread_lock.h"
 #include "esp_openthread_netif_glue.h"
 #include "esp_ot_cli_extension.h"
+#include "esp_ot_histogram.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include <inttypes.h>
 #include <sys/unistd.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/event_groups.h"
@@ -24,12 +28,72 @@
 #include "lwip/sockets.h"
 #include "openthread/cli.h"
 
+#define UDP_PING_MAGIC 0x55445050 /* "UDPP" */
+#define UDP_PING_MAX_SIZE 1232    /* the UDP payload of an IPv6 packet of the minimum MTU */
+#define UDP_PING_DEFAULT_COUNT 100
+#define UDP_PING_DEFAULT_INTERVAL_MS 100
+#define UDP_PING_DEFAULT_SIZE 64
+#define UDP_PING_WAIT_MS 1000 /* the time to wait for the replies of the last probes */
+#define UDP_SOCKET_RX_BUFFER_SIZE (UDP_PING_MAX_SIZE + 1)
+
+// The start of every probe of "udpsockclient ping", reflected as is by "udpsockserver echo on".
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint32_t session;
+    uint32_t seq;
+    int64_t tx_time_us;
+} udp_ping_probe_t;
+
+typedef struct {
+    uint32_t session;
+    uint32_t sent;
+    uint32_t received;
+    uint32_t last_rtt_us;
+    uint64_t rtt_delta_sum_us; /* the sum of the differences between the RTTs of consecutive replies */
+    esp_ot_histogram_t rtt;
+} udp_ping_stats_t;
+
 static EventGroupHandle_t udp_server_event_group;
 static EventGroupHandle_t udp_client_event_group;
+static udp_ping_stats_t *s_udp_ping_stats = NULL;
+static portMUX_TYPE s_udp_ping_lock = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool s_udp_ping_running = false;
+
+static bool is_udp_ping_probe(const char *data, int len)
+{
+    uint32_t magic;
+
+    if (len < sizeof(udp_ping_probe_t)) {
+        return false;
+    }
+    memcpy(&magic, data, sizeof(magic));
+    return magic == UDP_PING_MAGIC;
+}
+
+static void udp_ping_record_reply(const char *data, int64_t rx_time_us)
+{
+    udp_ping_probe_t probe;
+
+    memcpy(&probe, data, sizeof(probe));
+    int64_t rtt_us = rx_time_us - probe.tx_time_us;
+    rtt_us = rtt_us < 0 ? 0 : (rtt_us > UINT32_MAX ? UINT32_MAX : rtt_us);
+    portENTER_CRITICAL(&s_udp_ping_lock);
+    udp_ping_stats_t *stats = s_udp_ping_stats;
+    if (stats && probe.session == stats->session && probe.seq < stats->sent) {
+        if (stats->received) {
+            stats->rtt_delta_sum_us +=
+                rtt_us > stats->last_rtt_us ? rtt_us - stats->last_rtt_us : stats->last_rtt_us - rtt_us;
+        }
+        stats->last_rtt_us = rtt_us;
+        stats->received++;
+        esp_ot_histogram_record(&stats->rtt, rtt_us);
+    }
+    portEXIT_CRITICAL(&s_udp_ping_lock);
+}
 
 static void udp_server_receive_task(void *pvParameters)
 {
-    char rx_buffer[128];
+    char rx_buffer[UDP_SOCKET_RX_BUFFER_SIZE];
     int len = 0;
     char addr_str[128];
     int port = 0;
@@ -43,7 +107,12 @@ static void udp_server_receive_task(void *pvParameters)
         if (len < 0) {
             ESP_LOGW(OT_EXT_CLI_TAG, "UDP server fail when receiving message");
         }
-        if (len > 0) {
+        if (len > 0 && udp_server_member->echo && is_udp_ping_probe(rx_buffer, len)) {
+            // The probe is reflected without logging, which would delay the following ones.
+            if (sendto(udp_server_member->sock, rx_buffer, len, 0, (struct sockaddr *)&source_addr, socklen) < 0) {
+                ESP_LOGW(OT_EXT_CLI_TAG, "UDP server fail to reflect a probe");
+            }
+        } else if (len > 0) {
             inet6_ntoa_r(((struct sockaddr_in6 *)&source_addr)->sin6_addr, addr_str, sizeof(addr_str) - 1);
             port = ntohs(((struct sockaddr_in6 *)&source_addr)->sin6_port);
             ESP_LOGI(OT_EXT_CLI_TAG, "sock %d Received %d bytes from %s : %d", udp_server_member->sock, len, addr_str,
@@ -132,6 +201,7 @@ static void udp_server_delete(UDP_SERVER *udp_server_member)
     shutdown(udp_server_member->sock, 0);
     close(udp_server_member->sock);
     udp_server_member->sock = -1;
+    udp_server_member->echo = 0;
 }
 
 static void udp_socket_server_task(void *pvParameters)
@@ -172,6 +242,7 @@ otError esp_ot_process_udp_server(void *aContext, uint8_t aArgsLength, char *aAr
         otCliOutputFormat("bind <port>                              :     create a UDP server with binding the port\n");
         otCliOutputFormat("send <ipaddr> <port> <message>           :     send a message to the UDP client\n");
         otCliOutputFormat("send <ipaddr> <port> <message> <if>      :     send a message to the UDP client via <if>\n");
+        otCliOutputFormat("echo <on|off>                            :     reflect the probes of udpsockclient ping\n");
         otCliOutputFormat("close                                    :     close UDP server\n");
         otCliOutputFormat("---example---\n");
         otCliOutputFormat("get UDP server status                    :     udpsockserver status\n");
@@ -183,6 +254,7 @@ otError esp_ot_process_udp_server(void *aContext, uint8_t aArgsLength, char *aAr
                           "FDDE:AD00:BEEF:CAFE:FD14:30B6:CDA:8A95 51876 hello st\n");
         otCliOutputFormat("send a message via OpenThread interface  :     udpsockserver send "
                           "FDDE:AD00:BEEF:CAFE:FD14:30B6:CDA:8A95 51876 hello ot\n");
+        otCliOutputFormat("reflect the probes                       :     udpsockserver echo on\n");
         otCliOutputFormat("close UDP server                         :     udpsockserver close\n");
     } else if (strcmp(aArgs[0], "status") == 0) {
         if (udp_server_handle == NULL) {
@@ -193,8 +265,8 @@ otError esp_ot_process_udp_server(void *aContext, uint8_t aArgsLength, char *aAr
             otCliOutputFormat("UDP server is not binded!\n");
             return OT_ERROR_NONE;
         }
-        otCliOutputFormat("open\tlocal ipaddr: %s\tlocal port: %d\n", udp_server_member.local_ipaddr,
-                          udp_server_member.local_port);
+        otCliOutputFormat("open\tlocal ipaddr: %s\tlocal port: %d\techo: %s\n", udp_server_member.local_ipaddr,
+                          udp_server_member.local_port, udp_server_member.echo ? "on" : "off");
     } else if (strcmp(aArgs[0], "open") == 0) {
         if (udp_server_handle == NULL) {
             udp_server_event_group = xEventGroupCreate();
@@ -250,6 +322,16 @@ otError esp_ot_process_udp_server(void *aContext, uint8_t aArgsLength, char *aAr
             return OT_ERROR_INVALID_ARGS;
         }
         xEventGroupSetBits(udp_server_event_group, UDP_SERVER_SEND_BIT);
+    } else if (strcmp(aArgs[0], "echo") == 0) {
+        if (udp_server_handle == NULL) {
+            otCliOutputFormat("UDP server is not open.\n");
+            return OT_ERROR_NONE;
+        }
+        if (aArgsLength != 2 || (strcmp(aArgs[1], "on") != 0 && strcmp(aArgs[1], "off") != 0)) {
+            ESP_LOGE(OT_EXT_CLI_TAG, "Invalid arguments.");
+            return OT_ERROR_INVALID_ARGS;
+        }
+        udp_server_member.echo = strcmp(aArgs[1], "on") == 0;
     } else if (strcmp(aArgs[0], "close") == 0) {
         if (udp_server_handle == NULL) {
             otCliOutputFormat("UDP server is not open.\n");
@@ -265,7 +347,7 @@ otError esp_ot_process_udp_server(void *aContext, uint8_t aArgsLength, char *aAr
 
 static void udp_client_receive_task(void *pvParameters)
 {
-    char rx_buffer[128];
+    char rx_buffer[UDP_SOCKET_RX_BUFFER_SIZE];
     int len = 0;
     char addr_str[128];
     int port = 0;
@@ -276,10 +358,13 @@ static void udp_client_receive_task(void *pvParameters)
         socklen_t socklen = sizeof(source_addr);
         len = recvfrom(udp_client_member->sock, rx_buffer, sizeof(rx_buffer) - 1, 0, (struct sockaddr *)&source_addr,
                        &socklen);
+        int64_t rx_time_us = esp_timer_get_time();
         if (len < 0) {
             ESP_LOGW(OT_EXT_CLI_TAG, "UDP client fail when receiving message");
         }
-        if (len > 0) {
+        if (len > 0 && is_udp_ping_probe(rx_buffer, len)) {
+            udp_ping_record_reply(rx_buffer, rx_time_us);
+        } else if (len > 0) {
             inet6_ntoa_r(((struct sockaddr_in6 *)&source_addr)->sin6_addr, addr_str, sizeof(addr_str) - 1);
             port = ntohs(((struct sockaddr_in6 *)&source_addr)->sin6_port);
             ESP_LOGI(OT_EXT_CLI_TAG, "sock %d Received %d bytes from %s : %d", udp_client_member->sock, len, addr_str,
@@ -314,6 +399,90 @@ static void udp_client_send(UDP_CLIENT *udp_client_member)
     }
 }
 
+static void udp_ping_print_stats(const udp_ping_stats_t *stats)
+{
+    uint32_t lost = stats->sent > stats->received ? stats->sent - stats->received : 0;
+    uint32_t loss_bp = stats->sent ? (uint32_t)((uint64_t)lost * 10000 / stats->sent) : 0;
+
+    ESP_LOGI(OT_EXT_CLI_TAG, "%" PRIu32 " probes sent, %" PRIu32 " replies received, %" PRIu32 ".%02" PRIu32 "%% loss",
+             stats->sent, stats->received, loss_bp / 100, loss_bp % 100);
+    if (stats->received == 0) {
+        return;
+    }
+    ESP_LOGI(OT_EXT_CLI_TAG,
+             "rtt(us) min %" PRIu32 " p50 %" PRIu32 " p90 %" PRIu32 " p99 %" PRIu32 " max %" PRIu32 " mean %" PRIu32
+             " jitter %" PRIu32,
+             stats->rtt.min, esp_ot_histogram_percentile(&stats->rtt, 50), esp_ot_histogram_percentile(&stats->rtt, 90),
+             esp_ot_histogram_percentile(&stats->rtt, 99), stats->rtt.max, esp_ot_histogram_mean(&stats->rtt),
+             stats->received > 1 ? (uint32_t)(stats->rtt_delta_sum_us / (stats->received - 1)) : 0);
+}
+
+static esp_err_t udp_client_ping(UDP_CLIENT *udp_client_member)
+{
+    esp_err_t ret = ESP_OK;
+    struct sockaddr_in6 dest_addr = {0};
+    const UDP_PING_CONFIG *config = &udp_client_member->ping;
+    udp_ping_stats_t *stats = calloc(1, sizeof(udp_ping_stats_t));
+    char *probe_buffer = malloc(config->size);
+    TickType_t next_tick = 0;
+    EventBits_t bits = 0;
+
+    ESP_GOTO_ON_FALSE(stats && probe_buffer, ESP_ERR_NO_MEM, exit, OT_EXT_CLI_TAG, "Fail to allocate the probes");
+    ESP_GOTO_ON_ERROR(socket_bind_interface(udp_client_member->sock, &(udp_client_member->ifr)), exit, OT_EXT_CLI_TAG,
+                      "Stop sending probes");
+    inet6_aton(udp_client_member->messagesend.ipaddr, &dest_addr.sin6_addr);
+    dest_addr.sin6_family = AF_INET6;
+    dest_addr.sin6_port = htons(udp_client_member->messagesend.port);
+    for (int i = sizeof(udp_ping_probe_t); i < config->size; i++) {
+        probe_buffer[i] = i;
+    }
+    esp_ot_histogram_reset(&stats->rtt);
+    stats->session = esp_random();
+    portENTER_CRITICAL(&s_udp_ping_lock);
+    s_udp_ping_stats = stats;
+    portEXIT_CRITICAL(&s_udp_ping_lock);
+    ESP_LOGI(OT_EXT_CLI_TAG, "Pinging %s : %d with %d probes of %d bytes every %d ms",
+             udp_client_member->messagesend.ipaddr, udp_client_member->messagesend.port, config->count, config->size,
+             config->interval_ms);
+
+    next_tick = xTaskGetTickCount();
+    for (int seq = 0; seq < config->count && !(bits & UDP_CLIENT_CLOSE_BIT); seq++) {
+        udp_ping_probe_t probe = {
+            .magic = UDP_PING_MAGIC,
+            .session = stats->session,
+            .seq = seq,
+            .tx_time_us = esp_timer_get_time(),
+        };
+        memcpy(probe_buffer, &probe, sizeof(probe));
+        portENTER_CRITICAL(&s_udp_ping_lock);
+        stats->sent++;
+        portEXIT_CRITICAL(&s_udp_ping_lock);
+        if (sendto(udp_client_member->sock, probe_buffer, config->size, 0, (struct sockaddr *)&dest_addr,
+                   sizeof(dest_addr)) < 0) {
+            ESP_LOGW(OT_EXT_CLI_TAG, "Fail to send probe %d", seq);
+        }
+        // The probes are sent at a fixed rate, the wait is cut short by closing the client.
+        next_tick += pdMS_TO_TICKS(config->interval_ms);
+        int32_t wait_ticks = (int32_t)(next_tick - xTaskGetTickCount());
+        bits = xEventGroupWaitBits(udp_client_event_group, UDP_CLIENT_CLOSE_BIT, pdFALSE, pdFALSE,
+                                   wait_ticks > 0 ? wait_ticks : 0);
+    }
+    if (!(bits & UDP_CLIENT_CLOSE_BIT)) {
+        xEventGroupWaitBits(udp_client_event_group, UDP_CLIENT_CLOSE_BIT, pdFALSE, pdFALSE,
+                            pdMS_TO_TICKS(UDP_PING_WAIT_MS));
+    }
+    portENTER_CRITICAL(&s_udp_ping_lock);
+    s_udp_ping_stats = NULL;
+    portEXIT_CRITICAL(&s_udp_ping_lock);
+    udp_ping_print_stats(stats);
+
+exit:
+    free(stats);
+    free(probe_buffer);
+    s_udp_ping_running = false;
+    return ret;
+}
+
 static void udp_client_delete(UDP_CLIENT *udp_client_member)
 {
     udp_client_member->exist = 0;
@@ -360,12 +529,18 @@ static void udp_socket_client_task(void *pvParameters)
     ESP_LOGI(OT_EXT_CLI_TAG, "Successfully created");
 
     while (true) {
-        int bits = xEventGroupWaitBits(udp_client_event_group, UDP_CLIENT_SEND_BIT | UDP_CLIENT_CLOSE_BIT, pdFALSE,
+        int bits = xEventGroupWaitBits(udp_client_event_group,
+                                       UDP_CLIENT_SEND_BIT | UDP_CLIENT_CLOSE_BIT | UDP_CLIENT_PING_BIT, pdFALSE,
                                        pdFALSE, 10000 / portTICK_PERIOD_MS);
         int udp_event = bits & 0x0f;
         if (udp_event == UDP_CLIENT_SEND_BIT) {
             xEventGroupClearBits(udp_client_event_group, UDP_CLIENT_SEND_BIT);
             udp_client_send(udp_client_member);
+        } else if (udp_event == UDP_CLIENT_PING_BIT) {
+            xEventGroupClearBits(udp_client_event_group, UDP_CLIENT_PING_BIT);
+            if (udp_client_ping(udp_client_member) != ESP_OK) {
+                ESP_LOGW(OT_EXT_CLI_TAG, "Fail to ping %s", udp_client_member->messagesend.ipaddr);
+            }
         } else if (udp_event == UDP_CLIENT_CLOSE_BIT) {
             xEventGroupClearBits(udp_client_event_group, UDP_CLIENT_CLOSE_BIT);
             udp_client_delete(udp_client_member);
@@ -400,6 +575,8 @@ otError esp_ot_process_udp_client(void *aContext, uint8_t aArgsLength, char *aAr
                           "client and bind a local port(optional)\n");
         otCliOutputFormat("send <ipaddr> <port> <message>           :     send a message to the UDP server\n");
         otCliOutputFormat("send <ipaddr> <port> <message> <if>      :     send a message to the UDP server via <if>\n");
+        otCliOutputFormat("ping <ipaddr> <port> [-c <count>] [-i <interval_ms>] [-s <size>] [-I <if>]\n");
+        otCliOutputFormat("                                         :     measure the round trip time to the server\n");
         otCliOutputFormat("close                                    :     close UDP client\n");
         otCliOutputFormat("---example---\n");
         otCliOutputFormat("get UDP client status                    :     udpsockclient status\n");
@@ -411,6 +588,8 @@ otError esp_ot_process_udp_client(void *aContext, uint8_t aArgsLength, char *aAr
                           "FDDE:AD00:BEEF:CAFE:FD14:30B6:CDA:8A95 51876 hello st\n");
         otCliOutputFormat("send a message via OpenThread interface  :     udpsockclient send "
                           "FDDE:AD00:BEEF:CAFE:FD14:30B6:CDA:8A95 51876 hello ot\n");
+        otCliOutputFormat("ping 1000 times every 20 ms via Wi-Fi    :     udpsockclient ping "
+                          "FDDE:AD00:BEEF:CAFE:FD14:30B6:CDA:8A95 12345 -c 1000 -i 20 -I st\n");
         otCliOutputFormat("close UDP client                         :     udpsockclient close\n");
     } else if (strcmp(aArgs[0], "status") == 0) {
         if (udp_client_handle == NULL) {
@@ -485,6 +664,49 @@ otError esp_ot_process_udp_client(void *aContext, uint8_t aArgsLength, char *aAr
             return OT_ERROR_INVALID_ARGS;
         }
         xEventGroupSetBits(udp_client_event_group, UDP_CLIENT_SEND_BIT);
+    } else if (strcmp(aArgs[0], "ping") == 0) {
+        if (udp_client_handle == NULL) {
+            otCliOutputFormat("UDP client is not open.\n");
+            return OT_ERROR_NONE;
+        }
+        if (udp_client_member.exist == 0) {
+            otCliOutputFormat("UDP client is not binded!\n");
+            return OT_ERROR_NONE;
+        }
+        if (s_udp_ping_running) {
+            otCliOutputFormat("UDP ping is running.\n");
+            return OT_ERROR_NONE;
+        }
+        if (aArgsLength < 3 || aArgsLength % 2 == 0) {
+            ESP_LOGE(OT_EXT_CLI_TAG, "Invalid arguments.");
+            return OT_ERROR_INVALID_ARGS;
+        }
+        UDP_PING_CONFIG ping = {UDP_PING_DEFAULT_COUNT, UDP_PING_DEFAULT_INTERVAL_MS, UDP_PING_DEFAULT_SIZE};
+        strcpy(udp_client_member.ifr.ifr_name, "");
+        for (int i = 3; i < aArgsLength; i += 2) {
+            if (strcmp(aArgs[i], "-c") == 0) {
+                ping.count = atoi(aArgs[i + 1]);
+            } else if (strcmp(aArgs[i], "-i") == 0) {
+                ping.interval_ms = atoi(aArgs[i + 1]);
+            } else if (strcmp(aArgs[i], "-s") == 0) {
+                ping.size = atoi(aArgs[i + 1]);
+            } else if (strcmp(aArgs[i], "-I") != 0 ||
+                       socket_get_netif_impl_name(aArgs[i + 1], &(udp_client_member.ifr)) != ESP_OK) {
+                otCliOutputFormat("invalid commands\n");
+                return OT_ERROR_INVALID_ARGS;
+            }
+        }
+        if (ping.count <= 0 || ping.interval_ms <= 0 || ping.size < sizeof(udp_ping_probe_t) ||
+            ping.size > UDP_PING_MAX_SIZE) {
+            otCliOutputFormat("The count and the interval shall be positive, the size from %d to %d bytes\n",
+                              (int)sizeof(udp_ping_probe_t), UDP_PING_MAX_SIZE);
+            return OT_ERROR_INVALID_ARGS;
+        }
+        strncpy(udp_client_member.messagesend.ipaddr, aArgs[1], sizeof(udp_client_member.messagesend.ipaddr));
+        udp_client_member.messagesend.port = atoi(aArgs[2]);
+        udp_client_member.ping = ping;
+        s_udp_ping_running = true;
+        xEventGroupSetBits(udp_client_event_group, UDP_CLIENT_PING_BIT);
     } else if (strcmp(aArgs[0], "close") == 0) {
         if (udp_client_handle == NULL) {
             otCliOutputFormat("UDP client is not open.\n");
@@ -3,9 +3,10 @@
 import os
 import sys
 import argparse
+import hashlib
 import pathlib
-import shutil
 import struct
+import zlib
 
 FILETAG_RCP_VERSION = 0
 FILETAG_RCP_FLASH_ARGS = 1
@@ -13,81 +14,175 @@ FILETAG_RCP_BOOTLOADER = 2
 FILETAG_RCP_PARTITION_TABLE = 3
 FILETAG_RCP_FIRMWARE = 4
 FILETAG_BR_OTA_IMAGE = 5
+FILETAG_RCP_REGION_DIGESTS = 6
+FILETAG_BR_OTA_DELTA = 7
+FILETAG_IMAGE_FORMAT = 0xfe
 FILETAG_IMAGE_HEADER = 0xff
+FILETAG_FLAG_COMPRESSED = 1 << 31
 
 HEADER_ENTRY_SIZE = 3 * 4
-RCP_IMAGE_HEADER_SIZE = HEADER_ENTRY_SIZE * 6
-RCP_FLASH_ARGS_SIZE = 2 * 4 * 3
+FLASH_SECTOR_SIZE = 0x1000
+IMAGE_FORMAT_VERSION = 2
+# The Border Router firmwares reading only version 1 hold the image header in a buffer of this many entries.
+IMAGE_V1_MAX_HEADER_ENTRIES = 7
+DELTA_OP_COPY = 0
+DELTA_OP_INSERT = 1
+DELTA_BLOCK_SIZE = 32
+DELTA_BLOCK_STEP = 16
 
 
-def append_subfile_header(fout, tag, size, offset):
-    fout.write(struct.pack('<LLL', tag, size, offset))
-    return offset + size
+def read_subfile(path):
+    with open(path, 'rb') as fin:
+        return fin.read()
 
 
-def append_subfile(fout, target_file):
-    buf_size = 4096
-    with open(target_file, 'rb') as fin:
-        data = fin.read(buf_size)
-        while data and len(data) > 0:
-            fout.write(data)
-            data = fin.read(buf_size)
+def compress_subfile(data):
+    # The compressed subfile is the raw size and MD5 followed by a zlib stream, which the ROM loader inflates.
+    return struct.pack('<L', len(data)) + hashlib.md5(data).digest() + zlib.compress(data, 9)
 
 
-def append_flash_args(fout, flash_args_path):
+def create_region_digests(subfiles, region_size):
+    # The region size and count, then for each subfile its tag, raw size and the MD5 digest of each region.
+    digests = struct.pack('<LL', region_size, len(subfiles))
+    for tag, data in subfiles:
+        digests += struct.pack('<LL', tag, len(data))
+        for region_offset in range(0, len(data), region_size):
+            digests += hashlib.md5(data[region_offset:region_offset + region_size]).digest()
+    return digests
+
+
+def create_delta(source, target):
+    # The source and target sizes and SHA-256 digests, then the operations building the target: a copy of a range of
+    # the source, or an insert of the data following the operation.
+    blocks = {}
+    for offset in range(0, len(source) - DELTA_BLOCK_SIZE + 1, DELTA_BLOCK_STEP):
+        blocks.setdefault(source[offset:offset + DELTA_BLOCK_SIZE], offset)
+    delta = struct.pack('<L32sL32s', len(source), hashlib.sha256(source).digest(), len(target),
+                        hashlib.sha256(target).digest())
+    insert_start = 0
+    pos = 0
+    while pos + DELTA_BLOCK_SIZE <= len(target):
+        source_offset = blocks.get(target[pos:pos + DELTA_BLOCK_SIZE])
+        if source_offset is None:
+            pos += 1
+            continue
+        # Extend the match backwards into the pending insert and forwards as far as the source matches.
+        start = pos
+        while start > insert_start and source_offset > 0 and source[source_offset - 1] == target[start - 1]:
+            start -= 1
+            source_offset -= 1
+        end = pos + DELTA_BLOCK_SIZE
+        while end < len(target) and source_offset + end - start < len(source) and \
+                source[source_offset + end - start] == target[end]:
+            end += 1
+        if start > insert_start:
+            delta += struct.pack('<LLL', DELTA_OP_INSERT, start - insert_start, 0) + target[insert_start:start]
+        delta += struct.pack('<LLL', DELTA_OP_COPY, end - start, source_offset)
+        insert_start = pos = end
+    if insert_start < len(target):
+        delta += struct.pack('<LLL', DELTA_OP_INSERT, len(target) - insert_start, 0) + target[insert_start:]
+    return delta
+
+
+def create_flash_args(flash_args_path):
     with open(flash_args_path, 'r') as f:
         # skip first line
         next(f)
         partition_info_list = [l.split() for l in f]
+    flash_args = b''
     for offset, partition_file in partition_info_list:
         offset = int(offset, 0)
         if partition_file.find('bootloader') >= 0:
-            fout.write(struct.pack('<LL', FILETAG_RCP_BOOTLOADER, offset))
+            flash_args += struct.pack('<LL', FILETAG_RCP_BOOTLOADER, offset)
         elif partition_file.find('partition_table') >= 0:
-            fout.write(struct.pack('<LL', FILETAG_RCP_PARTITION_TABLE, offset))
+            flash_args += struct.pack('<LL', FILETAG_RCP_PARTITION_TABLE, offset)
         else:
-            fout.write(struct.pack('<LL', FILETAG_RCP_FIRMWARE, offset))
+            flash_args += struct.pack('<LL', FILETAG_RCP_FIRMWARE, offset)
+    return flash_args
+
+
+def create_image_format(subfiles):
+    # The format version and count, then for each subfile its tag, raw size and the SHA-256 digest of its content.
+    image_format = struct.pack('<LL', IMAGE_FORMAT_VERSION, len(subfiles))
+    for tag, data, raw_size in subfiles:
+        image_format += struct.pack('<LL', tag, raw_size) + hashlib.sha256(data).digest()
+    return image_format
+
+
+def write_image(fout, subfiles):
+    header_size = HEADER_ENTRY_SIZE * (len(subfiles) + 1)
+    fout.write(struct.pack('<LLL', FILETAG_IMAGE_HEADER, header_size, 0))
+    offset = header_size
+    for tag, data, _ in subfiles:
+        fout.write(struct.pack('<LLL', tag, len(data), offset))
+        offset += len(data)
+    for _, data, _ in subfiles:
+        fout.write(data)
 
 
 def main():
     parser = argparse.ArgumentParser()
     parser.add_argument('--rcp-build-dir', type=str, required=True)
     parser.add_argument('--br-firmware', type=str, required=False)
+    parser.add_argument('--br-firmware-base', type=str, required=False,
+                        help='The Border Router firmware running on the devices to update, the Border Router '
+                        'firmware is stored as a delta to it')
     parser.add_argument('--target-file', type=str, required=True)
+    parser.add_argument('--compress', action='store_true',
+                        help='Store the bootloader, partition table and firmware of the RCP compressed')
+    parser.add_argument('--region-size', type=lambda x: int(x, 0), default=0x10000,
+                        help='The size of the RCP flash regions compared before flashing, a multiple of 4 KB')
+    parser.add_argument('--image-version', type=int, choices=[1, IMAGE_FORMAT_VERSION], default=IMAGE_FORMAT_VERSION,
+                        help='The version of the image format. Version 1 has the layout read by the Border Router '
+                        'firmwares released before version 2: it carries no image format or region digests, and it '
+                        'cannot be compressed')
     args = parser.parse_args()
+    if args.image_version != IMAGE_FORMAT_VERSION and args.compress:
+        sys.exit('An image of version 1 cannot be compressed')
+    if args.region_size <= 0 or args.region_size % FLASH_SECTOR_SIZE != 0:
+        sys.exit('The region size shall be a positive multiple of {}'.format(FLASH_SECTOR_SIZE))
+    if args.br_firmware_base and (not args.br_firmware or args.image_version != IMAGE_FORMAT_VERSION):
+        sys.exit('A Border Router firmware delta requires the Border Router firmware and an image of version {}'
+                 .format(IMAGE_FORMAT_VERSION))
     base_dir = args.rcp_build_dir
     pathlib.Path(os.path.dirname(args.target_file)).mkdir(parents=True, exist_ok=True)
-    rcp_version_path = os.path.join(base_dir, 'rcp_version')
-    flash_args_path = os.path.join(base_dir, 'flash_args')
-    bootloader_path = os.path.join(base_dir, 'bootloader', 'bootloader.bin')
-    partition_table_path = os.path.join(
-            base_dir, 'partition_table', 'partition-table.bin')
-    rcp_firmware_path = os.path.join(base_dir, 'esp_ot_rcp.bin')
+    bootloader = read_subfile(os.path.join(base_dir, 'bootloader', 'bootloader.bin'))
+    partition_table = read_subfile(os.path.join(base_dir, 'partition_table', 'partition-table.bin'))
+    rcp_firmware = read_subfile(os.path.join(base_dir, 'esp_ot_rcp.bin'))
+    # Each subfile is its tag, its content in the image and its raw size.
+    subfiles = []
+    rcp_version = read_subfile(os.path.join(base_dir, 'rcp_version'))
+    subfiles.append((FILETAG_RCP_VERSION, rcp_version, len(rcp_version)))
+    flash_args = create_flash_args(os.path.join(base_dir, 'flash_args'))
+    subfiles.append((FILETAG_RCP_FLASH_ARGS, flash_args, len(flash_args)))
+    for tag, data in ((FILETAG_RCP_BOOTLOADER, bootloader), (FILETAG_RCP_PARTITION_TABLE, partition_table),
+                      (FILETAG_RCP_FIRMWARE, rcp_firmware)):
+        if args.compress:
+            subfiles.append((tag | FILETAG_FLAG_COMPRESSED, compress_subfile(data), len(data)))
+        else:
+            subfiles.append((tag, data, len(data)))
+    if args.image_version == IMAGE_FORMAT_VERSION:
+        # The Border Router firmwares reading only version 1 do not expect the region digests in the header.
+        region_digests = create_region_digests([(FILETAG_RCP_BOOTLOADER, bootloader),
+                                                (FILETAG_RCP_PARTITION_TABLE, partition_table),
+                                                (FILETAG_RCP_FIRMWARE, rcp_firmware)], args.region_size)
+        subfiles.append((FILETAG_RCP_REGION_DIGESTS, region_digests, len(region_digests)))
+    if args.br_firmware:
+        br_firmware = read_subfile(args.br_firmware)
+        if args.br_firmware_base:
+            br_delta = create_delta(read_subfile(args.br_firmware_base), br_firmware)
+            subfiles.append((FILETAG_BR_OTA_DELTA, br_delta, len(br_delta)))
+        else:
+            subfiles.append((FILETAG_BR_OTA_IMAGE, br_firmware, len(br_firmware)))
+    if args.image_version == IMAGE_FORMAT_VERSION:
+        # The image format goes first so that the device has the digests before the subfiles arrive.
+        image_format = create_image_format(subfiles)
+        subfiles.insert(0, (FILETAG_IMAGE_FORMAT, image_format, len(image_format)))
+    elif len(subfiles) + 1 > IMAGE_V1_MAX_HEADER_ENTRIES:
+        sys.exit('The header of an image of version 1 holds at most {} entries, {} are needed'
+                 .format(IMAGE_V1_MAX_HEADER_ENTRIES, len(subfiles) + 1))
     with open(args.target_file, 'wb') as fout:
-        image_header_size = RCP_IMAGE_HEADER_SIZE
-        if args.br_firmware:
-            image_header_size += HEADER_ENTRY_SIZE
-        offset = append_subfile_header(
-                fout, FILETAG_IMAGE_HEADER, image_header_size, 0)
-        offset = append_subfile_header(
-                fout, FILETAG_RCP_VERSION, os.path.getsize(rcp_version_path), offset)
-        offset = append_subfile_header(
-                fout, FILETAG_RCP_FLASH_ARGS, RCP_FLASH_ARGS_SIZE, offset)
-        offset = append_subfile_header(
-                fout, FILETAG_RCP_BOOTLOADER, os.path.getsize(bootloader_path), offset)
-        offset = append_subfile_header(
-                fout, FILETAG_RCP_PARTITION_TABLE, os.path.getsize(partition_table_path), offset)
-        offset = append_subfile_header(
-                fout, FILETAG_RCP_FIRMWARE, os.path.getsize(rcp_firmware_path), offset)
-        if args.br_firmware:
-            offset = append_subfile_header(fout, FILETAG_BR_OTA_IMAGE, os.path.getsize(args.br_firmware), offset)
-        append_subfile(fout, rcp_version_path)
-        append_flash_args(fout, flash_args_path)
-        append_subfile(fout, bootloader_path)
-        append_subfile(fout, partition_table_path)
-        append_subfile(fout, rcp_firmware_path)
-        if args.br_firmware:
-            append_subfile(fout, args.br_firmware)
+        write_image(fout, subfiles)
 
 
 if __name__ == '__main__':
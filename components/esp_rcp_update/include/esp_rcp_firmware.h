@@ -11,7 +11,7 @@
 extern "C" {
 #endif
 
-#define MAX_SUBFILE_INFO 7
+#define MAX_SUBFILE_INFO 10
 
 typedef enum {
     FILETAG_RCP_VERSION = 0,
@@ -20,9 +20,16 @@ typedef enum {
     FILETAG_RCP_PARTITION_TABLE = 3,
     FILETAG_RCP_FIRMWARE = 4,
     FILETAG_HOST_FIRMWARE = 5,
+    FILETAG_RCP_REGION_DIGESTS = 6,
+    FILETAG_HOST_FIRMWARE_DELTA = 7,
+    FILETAG_IMAGE_FORMAT = 0xfe,
     FILETAG_IMAGE_HEADER = 0xff,
 } esp_rcp_filetag_t;
 
+/* Set in the tag of a subfile entry whose content is an esp_rcp_compressed_info_t followed by a zlib stream. */
+#define FILETAG_FLAG_COMPRESSED (1UL << 31)
+#define FILETAG_MASK (~FILETAG_FLAG_COMPRESSED)
+
 struct esp_rcp_subfile_info {
     uint32_t tag;
     uint32_t size;
@@ -31,6 +38,88 @@ struct esp_rcp_subfile_info {
 
 typedef struct esp_rcp_subfile_info esp_rcp_subfile_info_t;
 
+struct esp_rcp_compressed_info {
+    uint32_t raw_size; /* the size of the decompressed content */
+    uint8_t md5[16];   /* the MD5 digest of the decompressed content */
+} __attribute__((packed));
+
+typedef struct esp_rcp_compressed_info esp_rcp_compressed_info_t;
+
+/* The flash args subfile is an array of esp_rcp_flash_arg_t, one for each flashed subfile. */
+struct esp_rcp_flash_arg {
+    uint32_t tag;    /* the tag of the subfile without FILETAG_FLAG_COMPRESSED */
+    uint32_t offset; /* the flash address of the subfile */
+} __attribute__((packed));
+
+typedef struct esp_rcp_flash_arg esp_rcp_flash_arg_t;
+
+/*
+ * The region digests subfile starts with an esp_rcp_region_digests_t, followed by an esp_rcp_region_digests_entry_t
+ * for each flashed subfile. Each entry is followed by the MD5 digests of the regions of the raw subfile.
+ */
+struct esp_rcp_region_digests {
+    uint32_t region_size; /* the size of a region, a multiple of the flash sector size */
+    uint32_t entry_count; /* the number of entries */
+} __attribute__((packed));
+
+typedef struct esp_rcp_region_digests esp_rcp_region_digests_t;
+
+struct esp_rcp_region_digests_entry {
+    uint32_t tag;      /* the tag of the subfile without FILETAG_FLAG_COMPRESSED */
+    uint32_t raw_size; /* the size of the raw subfile */
+} __attribute__((packed));
+
+typedef struct esp_rcp_region_digests_entry esp_rcp_region_digests_entry_t;
+
+/* The version of the image format written in the image format subfile, an image without it is of version 1. */
+#define ESP_RCP_IMAGE_FORMAT_VERSION 2
+
+/*
+ * The image format subfile is stored right after the image header. It starts with an esp_rcp_image_format_t,
+ * followed by an esp_rcp_subfile_digest_t for every other subfile in the header.
+ */
+struct esp_rcp_image_format {
+    uint32_t version;     /* the version of the image format */
+    uint32_t entry_count; /* the number of subfile digests */
+} __attribute__((packed));
+
+typedef struct esp_rcp_image_format esp_rcp_image_format_t;
+
+struct esp_rcp_subfile_digest {
+    uint32_t tag;       /* the tag of the subfile, including the flags of its header entry */
+    uint32_t raw_size;  /* the size of the subfile after decompression, the size of the subfile if not compressed */
+    uint8_t sha256[32]; /* the SHA-256 digest of the subfile as stored in the image */
+} __attribute__((packed));
+
+typedef struct esp_rcp_subfile_digest esp_rcp_subfile_digest_t;
+
+/*
+ * The host firmware delta subfile replaces the host firmware subfile in an image built against the running host
+ * firmware. It starts with an esp_rcp_delta_header_t, followed by esp_rcp_delta_op_t entries which produce the new
+ * firmware in order. An ESP_RCP_DELTA_OP_INSERT entry is followed by its data.
+ */
+struct esp_rcp_delta_header {
+    uint32_t source_size;      /* the size of the firmware the delta applies to */
+    uint8_t source_sha256[32]; /* the SHA-256 digest of the firmware the delta applies to */
+    uint32_t target_size;      /* the size of the new firmware */
+    uint8_t target_sha256[32]; /* the SHA-256 digest of the new firmware */
+} __attribute__((packed));
+
+typedef struct esp_rcp_delta_header esp_rcp_delta_header_t;
+
+typedef enum {
+    ESP_RCP_DELTA_OP_COPY = 0,   /* copy size bytes at offset of the source firmware */
+    ESP_RCP_DELTA_OP_INSERT = 1, /* insert the size bytes following the entry */
+} esp_rcp_delta_op_type_t;
+
+struct esp_rcp_delta_op {
+    uint32_t type;   /* esp_rcp_delta_op_type_t */
+    uint32_t size;   /* the bytes produced by the operation */
+    uint32_t offset; /* the offset in the source firmware of ESP_RCP_DELTA_OP_COPY, 0 otherwise */
+} __attribute__((packed));
+
+typedef struct esp_rcp_delta_op esp_rcp_delta_op_t;
+
 #define ESP_RCP_IMAGE_FILENAME "rcp_image"
 
 #ifdef __cplusplus
@@ -8,6 +8,7 @@
 
 #include <esp_err.h>
 #include <esp_rcp_firmware.h>
+#include <esp_rcp_progress.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -24,6 +25,26 @@ typedef enum {
 /* RCP OTA handle */
 typedef uint32_t esp_rcp_ota_handle_t;
 
+/* The progress of storing a v2 RCP image, from which the RCP OTA can be resumed. */
+typedef struct esp_rcp_ota_checkpoint {
+    uint8_t image_id[32]; /* the SHA-256 digest of the image header and image format subfile */
+    uint32_t prefix_size; /* the size of the image header and image format subfile */
+    uint32_t offset;      /* the bytes of the image stored and synced, always at the end of a subfile */
+    int8_t seq;           /* the update sequence of the slot storing the image */
+} esp_rcp_ota_checkpoint_t;
+
+/**
+ * @brief Register the callback reporting the progress of storing the received RCP image
+ *
+ * The progress of the ESP_RCP_PROGRESS_PHASE_RCP_DOWNLOAD phase is reported for every RCP OTA handle.
+ *
+ * @param[in] callback The progress callback, NULL to unregister it.
+ * @param[in] user_ctx The user context passed to the callback.
+ *
+ * @return ESP_OK on success.
+ */
+esp_err_t esp_rcp_ota_register_progress_callback(esp_rcp_progress_cb_t callback, void *user_ctx);
+
 /**
  * @brief Initialize a handle of RCP OTA
  *
@@ -35,6 +56,38 @@ typedef uint32_t esp_rcp_ota_handle_t;
  */
 esp_err_t esp_rcp_ota_begin(esp_rcp_ota_handle_t *out_handle);
 
+/**
+ * @brief Flash the RCP while the RCP image is received
+ *
+ * The bootloader, partition table and firmware of the RCP are sent to the serial loader of the RCP as their data
+ * arrives, while the image is still stored as usual. Each of them is verified by MD5 once it is complete, and the
+ * flashed regions are checked against the region digests of the image. A failure of flashing does not fail the
+ * RCP OTA, the result is reported by esp_rcp_ota_get_stream_flash_result() and the stored image can then be
+ * flashed with esp_rcp_update().
+ *
+ * This function must be called before any data is received. The UART of the RCP shall be released by the Thread
+ * stack, the RCP is reset into its serial loader once the image header is received.
+ *
+ * @param[in] handle Handle of RCP OTA
+ *
+ * @return ESP_OK on success.
+ * @return ESP_ERR_INVALID_STATE if some data has been received.
+ */
+esp_err_t esp_rcp_ota_enable_stream_flash(esp_rcp_ota_handle_t handle);
+
+/**
+ * @brief Get the result of flashing the RCP while the RCP image is received
+ *
+ * This function must be called after the RCP OTA handle reaches the state of ESP_RCP_OTA_STATE_FINISHED.
+ *
+ * @param[in] handle Handle of RCP OTA
+ *
+ * @return ESP_OK if the RCP is flashed with the received image and verified.
+ * @return ESP_ERR_INVALID_STATE if flashing is not enabled or not finished.
+ * @return error in case of flashing failure, the RCP shall then be flashed with esp_rcp_update().
+ */
+esp_err_t esp_rcp_ota_get_stream_flash_result(esp_rcp_ota_handle_t handle);
+
 /**
  * @brief Get state of RCP OTA
  *
@@ -56,11 +109,30 @@ esp_rcp_ota_state_t esp_rcp_ota_get_state(esp_rcp_ota_handle_t handle);
  */
 uint32_t esp_rcp_ota_get_subfile_size(esp_rcp_ota_handle_t handle, esp_rcp_filetag_t filetag);
 
+/**
+ * @brief Get the SHA-256 digest of a subfile from the image format of a v2 RCP image
+ *
+ * This function must be called after the RCP OTA handle reaches the state of ESP_RCP_OTA_STATE_FINISHED. The
+ * subfiles stored by RCP OTA are already verified, the digest is used to verify the subfiles received by the caller,
+ * such as the Border Router firmware.
+ *
+ * @param[in]  handle  Handle of RCP OTA
+ * @param[in]  filetag Tag of the subfile
+ * @param[out] sha256  The 32-byte SHA-256 digest of the subfile as stored in the image.
+ *
+ * @return ESP_OK on success.
+ * @return ESP_ERR_NOT_FOUND if the image is of version 1 or has no such subfile.
+ * @return ESP_ERR_INVALID_STATE if the RCP image is not received.
+ */
+esp_err_t esp_rcp_ota_get_subfile_sha256(esp_rcp_ota_handle_t handle, esp_rcp_filetag_t filetag, uint8_t *sha256);
+
 /**
  * @brief Receive RCP OTA data
  *
  * This function should be called multiple times as data is received during the OTA operation.
  * Data should be read sequentially from the image file generated by esp_rcp_update/create_ota_image.py.
+ * For an image of version 2, each subfile is checked against the SHA-256 digest of the image format as it is
+ * received, and a mismatching image is rejected before it can be submitted or finish flashing the RCP.
  *
  * @param[in]  handle        Handle of RCP OTA
  * @param[in]  data          Data buffer received
@@ -68,6 +140,8 @@ uint32_t esp_rcp_ota_get_subfile_size(esp_rcp_ota_handle_t handle, esp_rcp_filet
  * @param[out] received_size Received size from the data buffer.
  *
  * @return ESP_OK on success.
+ * @return ESP_ERR_INVALID_CRC if a subfile does not match its digest.
+ * @return ESP_ERR_INVALID_VERSION if the image format version is not supported.
  * @return error in case of failure.
  */
 esp_err_t esp_rcp_ota_receive(esp_rcp_ota_handle_t handle, const void *data, size_t size, size_t *received_size);
@@ -85,6 +159,47 @@ esp_err_t esp_rcp_ota_receive(esp_rcp_ota_handle_t handle, const void *data, siz
  */
 esp_err_t esp_rcp_ota_end(esp_rcp_ota_handle_t handle);
 
+/**
+ * @brief Get the checkpoint of the RCP OTA
+ *
+ * The checkpoint is available once the image format subfile of a v2 image is received, and it advances whenever a
+ * stored subfile is complete and synced. It can be saved to resume the RCP OTA with esp_rcp_ota_resume() after the
+ * handle is aborted, for example when the download is interrupted or the device restarts.
+ *
+ * @param[in]  handle     Handle of RCP OTA
+ * @param[out] checkpoint The checkpoint.
+ *
+ * @return ESP_OK on success.
+ * @return ESP_ERR_NOT_FOUND if the image is of version 1 or its image format is not received yet.
+ */
+esp_err_t esp_rcp_ota_get_checkpoint(esp_rcp_ota_handle_t handle, esp_rcp_ota_checkpoint_t *checkpoint);
+
+/**
+ * @brief Resume the RCP OTA from a checkpoint
+ *
+ * The header and image format of the image are loaded from the slot of the checkpoint and checked against its image
+ * ID, and the slot is reopened for writing after the checkpoint. The data passed to esp_rcp_ota_receive() then
+ * continues at @p offset of the image. It is @p checkpoint->offset, or the start of the flash sector holding it
+ * when the images are stored in raw partitions, since the sector may have been programmed after the checkpoint.
+ * The caller shall make sure that the image being downloaded has the same image ID, for example by hashing its first
+ * @p checkpoint->prefix_size bytes.
+ *
+ * This function must be called before any data is received, and it cannot be used together with
+ * esp_rcp_ota_enable_stream_flash(). On failure the handle shall be aborted.
+ *
+ * @param[in]  handle     Handle of RCP OTA
+ * @param[in]  checkpoint The checkpoint got from esp_rcp_ota_get_checkpoint().
+ * @param[out] offset     The offset of the image at which the data continues.
+ *
+ * @return ESP_OK on success.
+ * @return ESP_ERR_INVALID_STATE if some data has been received, or if the slot of the checkpoint is no longer the
+ *         slot to update.
+ * @return ESP_ERR_INVALID_CRC if the stored image does not match the checkpoint.
+ * @return error in case of failure.
+ */
+esp_err_t esp_rcp_ota_resume(esp_rcp_ota_handle_t handle, const esp_rcp_ota_checkpoint_t *checkpoint,
+                             uint32_t *offset);
+
 /**
  * @brief Abort RCP OTA update, free the handle and memory associated with it.
  *
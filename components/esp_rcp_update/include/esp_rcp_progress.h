@@ -0,0 +1,123 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESP_RCP_PROGRESS_ETA_UNKNOWN UINT32_MAX
+
+typedef enum {
+    ESP_RCP_PROGRESS_PHASE_IDLE = 0,      /* No update has run */
+    ESP_RCP_PROGRESS_PHASE_RCP_DOWNLOAD,  /* Storing the downloaded RCP image */
+    ESP_RCP_PROGRESS_PHASE_HOST_DOWNLOAD, /* Writing the downloaded host firmware to the OTA partition */
+    ESP_RCP_PROGRESS_PHASE_RCP_FLASH,     /* Flashing the stored RCP image to the RCP */
+} esp_rcp_progress_phase_t;
+
+typedef enum {
+    ESP_RCP_PROGRESS_STATE_RUNNING = 0, /* The phase is running */
+    ESP_RCP_PROGRESS_STATE_SUCCEEDED,   /* The phase has completed */
+    ESP_RCP_PROGRESS_STATE_FAILED,      /* The phase has failed or been aborted */
+} esp_rcp_progress_state_t;
+
+/**
+ * @brief The progress of an update phase.
+ *
+ */
+typedef struct {
+    esp_rcp_progress_phase_t phase; /*!< The phase */
+    esp_rcp_progress_state_t state; /*!< The state of the phase */
+    uint32_t bytes_done;            /*!< The bytes processed */
+    uint32_t bytes_total;           /*!< The bytes to process in the phase */
+    uint32_t bytes_per_sec;         /*!< The average throughput since the phase began */
+    uint32_t elapsed_ms;            /*!< The time since the phase began */
+    uint32_t eta_ms;                /*!< The estimated remaining time, ESP_RCP_PROGRESS_ETA_UNKNOWN if unknown */
+} esp_rcp_progress_t;
+
+/**
+ * @brief The progress callback.
+ *
+ * It is called from the updating task at most once per RCP_PROGRESS_INTERVAL_MS while a phase is running, and
+ * always when a phase begins and ends, so it shall return quickly.
+ *
+ * @param[in] progress  The progress of the phase.
+ * @param[in] user_ctx  The user context passed on registration.
+ *
+ */
+typedef void (*esp_rcp_progress_cb_t)(const esp_rcp_progress_t *progress, void *user_ctx);
+
+/**
+ * @brief The tracker of an update phase, used by the update components to report the progress.
+ *
+ */
+typedef struct {
+    esp_rcp_progress_t progress;    /*!< The latest progress */
+    int64_t start_us;               /*!< The time when the phase began */
+    int64_t last_report_us;         /*!< The time of the last report */
+    esp_rcp_progress_cb_t callback; /*!< The progress callback, can be NULL */
+    void *user_ctx;                 /*!< The user context of the callback */
+} esp_rcp_progress_tracker_t;
+
+/**
+ * @brief This function begins a phase and reports it.
+ *
+ * @param[out] tracker      The tracker of the phase
+ * @param[in]  phase        The phase
+ * @param[in]  bytes_total  The bytes to process in the phase
+ * @param[in]  callback     The progress callback, can be NULL
+ * @param[in]  user_ctx     The user context of the callback
+ *
+ */
+void esp_rcp_progress_begin(esp_rcp_progress_tracker_t *tracker, esp_rcp_progress_phase_t phase, uint32_t bytes_total,
+                            esp_rcp_progress_cb_t callback, void *user_ctx);
+
+/**
+ * @brief This function updates the processed bytes of a phase, and reports it if RCP_PROGRESS_INTERVAL_MS has
+ *        passed since the last report.
+ *
+ * @param[in] tracker       The tracker of the phase
+ * @param[in] bytes_done    The bytes processed since the phase began
+ *
+ */
+void esp_rcp_progress_update(esp_rcp_progress_tracker_t *tracker, uint32_t bytes_done);
+
+/**
+ * @brief This function ends a phase and reports it.
+ *
+ * @param[in] tracker   The tracker of the phase
+ * @param[in] success   Whether the phase has completed
+ *
+ */
+void esp_rcp_progress_end(esp_rcp_progress_tracker_t *tracker, bool success);
+
+/**
+ * @brief This function gets the latest progress reported by any phase.
+ *
+ * @param[out] progress The latest progress, the phase is ESP_RCP_PROGRESS_PHASE_IDLE if no update has run.
+ *
+ */
+void esp_rcp_progress_get_latest(esp_rcp_progress_t *progress);
+
+/**
+ * @brief This function gets the name of a phase.
+ *
+ */
+const char *esp_rcp_progress_phase_to_str(esp_rcp_progress_phase_t phase);
+
+/**
+ * @brief This function gets the name of a state.
+ *
+ */
+const char *esp_rcp_progress_state_to_str(esp_rcp_progress_state_t state);
+
+#ifdef __cplusplus
+}
+#endif
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "esp_loader.h"
+#include "esp_rcp_progress.h"
 #include "nvs.h"
 
 #ifdef __cplusplus
@@ -39,7 +40,7 @@ typedef struct {
     int uart_baudrate;                        /*!< UART baudrate */
     int reset_pin;                            /*!< RESET pin */
     int boot_pin;                             /*!< Boot mode select pin */
-    uint32_t update_baudrate;                 /*!< Baudrate when flashing the firmware */
+    uint32_t update_baudrate;                 /*!< The highest baudrate when flashing the firmware */
     char firmware_dir[RCP_FIRMWARE_DIR_SIZE]; /*!< The directory storing the RCP firmware */
     target_chip_t target_chip;                /*!< The target chip type */
 } esp_rcp_update_config_t;
@@ -60,15 +61,36 @@ esp_err_t esp_rcp_update_init(const esp_rcp_update_config_t *update_config);
 /**
  * @brief This function triggers an RCP firmware update.
  *
+ * The RCP loader is switched to the highest baudrate which it responds at, starting at update_baudrate. The baudrate
+ * is stepped down after RCP_UPDATE_BAUD_STEP_DOWN_FAILURES consecutive failed blocks, and a failed raw binary is
+ * resumed from its last written flash sector.
+ *
  * @return
  *  - ESP_OK
  *  - ESP_FAIL
  *  - ESP_ERR_INVALID_STASTE    If the RCP update is not initialized.
  *  - ESP_ERR_NOT_FOUND         RCP firmware not found in storage.
+ *  - ESP_ERR_INVALID_CRC       The stored RCP image does not match its digests, the RCP is left untouched.
+ *  - ESP_FAIL                  The RCP cannot be flashed at the lowest baudrate, the RCP is left partially flashed.
  *
  */
 esp_err_t esp_rcp_update(void);
 
+/**
+ * @brief This function registers the callback reporting the progress of esp_rcp_update().
+ *
+ * The progress of the ESP_RCP_PROGRESS_PHASE_RCP_FLASH phase is reported, the bytes are counted as stored in the
+ * RCP image, and the unchanged regions skipped by the update are counted as done.
+ *
+ * @param[in] callback  The progress callback, NULL to unregister it.
+ * @param[in] user_ctx  The user context passed to the callback.
+ *
+ * @return
+ *  - ESP_OK
+ *
+ */
+esp_err_t esp_rcp_update_register_progress_callback(esp_rcp_progress_cb_t callback, void *user_ctx);
+
 /**
  * @brief This function acquires the RCP image base directory.
  *
@@ -145,6 +167,22 @@ esp_err_t esp_rcp_mark_image_unusable(void);
  */
 esp_err_t esp_rcp_load_version_in_storage(char *version_str, size_t size);
 
+/**
+ * @brief This function loads the image ID of the current update image.
+ *
+ * The image ID is the SHA-256 digest of the image header and the image format, the image format holding the digest
+ * of every other file of an image of version 2.
+ *
+ * @param[out] image_id         The 32-byte image ID output.
+ *
+ * @return
+ *  - ESP_OK
+ *  - ESP_ERR_NOT_FOUND         No image is found in the current slot.
+ *  - ESP_FAIL                  Failed to read the image.
+ *
+ */
+esp_err_t esp_rcp_load_image_id_in_storage(uint8_t *image_id);
+
 /**
  * @brief This function deinitializes the RCP update process.
  *
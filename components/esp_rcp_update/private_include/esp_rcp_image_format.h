@@ -0,0 +1,72 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_rcp_firmware.h"
+#include "esp_rcp_image_store.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The largest image format subfile, with a digest for every subfile but the header and itself. */
+#define ESP_RCP_IMAGE_FORMAT_MAX_LEN \
+    (sizeof(esp_rcp_image_format_t) + (MAX_SUBFILE_INFO - 2) * sizeof(esp_rcp_subfile_digest_t))
+
+/**
+ * @brief Check whether the subfile with @param tag is stored in the RCP image slot, FILETAG_FLAG_COMPRESSED is
+ * ignored.
+ */
+bool esp_rcp_image_is_stored_subfile(uint32_t tag);
+
+/**
+ * @brief Check the image format subfile against the image header.
+ *
+ * The format shall be of ESP_RCP_IMAGE_FORMAT_VERSION and hold a digest for every subfile of the header other than
+ * the header and the format subfile, with the same tag and flags.
+ *
+ * @param[in]  format       The image format subfile.
+ * @param[in]  format_size  The size of the image format subfile.
+ * @param[in]  header       The entries of the image header.
+ * @param[in]  header_num   The number of entries of the image header.
+ *
+ * @return
+ *      -   ESP_OK                  : On success
+ *      -   ESP_ERR_INVALID_VERSION : The image format version is not supported
+ *      -   ESP_ERR_INVALID_ARG     : The image format does not match the header
+ */
+esp_err_t esp_rcp_image_format_check(const void *format, size_t format_size, const esp_rcp_subfile_info_t *header,
+                                     size_t header_num);
+
+/**
+ * @brief Find the digest of the subfile with @param tag in an image format checked by esp_rcp_image_format_check(),
+ * FILETAG_FLAG_COMPRESSED is ignored.
+ *
+ * @return The digest of the subfile, NULL if not found.
+ */
+const esp_rcp_subfile_digest_t *esp_rcp_image_format_find_digest(const void *format, uint32_t tag);
+
+/**
+ * @brief Verify the SHA-256 digests of the subfiles stored in an image opened for reading.
+ *
+ * @return
+ *      -   ESP_OK                  : All the stored subfiles match their digests
+ *      -   ESP_ERR_NOT_FOUND       : The image is of version 1 and carries no digests
+ *      -   ESP_ERR_INVALID_CRC     : A subfile does not match its digest
+ *      -   ESP_ERR_NO_MEM          : Failed to allocate the read buffer
+ *      -   ESP_FAIL                : The image format is invalid or cannot be read
+ */
+esp_err_t esp_rcp_image_verify_digests(esp_rcp_image_t *image);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,80 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_rcp_image_store.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The size of the RCP version cached, including the terminating null character. */
+#define ESP_RCP_IMAGE_META_VERSION_SIZE 128
+
+/**
+ * @brief The metadata of the image in a slot, cached in NVS so that the image is not opened to check its version.
+ */
+typedef struct esp_rcp_image_meta {
+    uint8_t app_sha256[32];                        /* the ELF SHA-256 of the firmware which cached the metadata */
+    uint32_t image_size;                           /* the end of the last subfile of the image */
+    uint8_t digest[32];                            /* the SHA-256 digest of the image header and image format */
+    uint32_t slot_size;                            /* the size of the image file, or of the raw partition */
+    char version[ESP_RCP_IMAGE_META_VERSION_SIZE]; /* the RCP version of the image */
+} esp_rcp_image_meta_t;
+
+/**
+ * @brief Read the metadata of an image opened for reading.
+ *
+ * @param[in]  image    The image opened for reading.
+ * @param[out] meta     The metadata of the image.
+ *
+ * @return
+ *      -   ESP_OK                  : On success
+ *      -   ESP_ERR_NOT_FOUND       : The image has no version subfile
+ *      -   ESP_ERR_INVALID_SIZE    : The version exceeds ESP_RCP_IMAGE_META_VERSION_SIZE
+ *      -   ESP_FAIL                : Failed to read the image
+ */
+esp_err_t esp_rcp_image_meta_read(esp_rcp_image_t *image, esp_rcp_image_meta_t *meta);
+
+/**
+ * @brief Load the cached metadata of the slot @param seq.
+ *
+ * The metadata cached by another firmware is ignored, the slots may have been flashed along with the running one. The
+ * metadata is also checked against the storage, which may have been flashed alone: the size of the slot and the digest
+ * of its header and image format shall match. The metadata is discarded whenever the firmware writes the slot.
+ *
+ * @return
+ *      -   ESP_OK                  : On success
+ *      -   ESP_ERR_NOT_FOUND       : No metadata is cached for the slot
+ *      -   Others                  : Failed to read NVS
+ */
+esp_err_t esp_rcp_image_meta_load(int8_t seq, esp_rcp_image_meta_t *meta);
+
+/**
+ * @brief Cache the metadata of the slot @param seq.
+ *
+ * @return
+ *      -   ESP_OK                  : On success
+ *      -   Others                  : Failed to write NVS
+ */
+esp_err_t esp_rcp_image_meta_save(int8_t seq, const esp_rcp_image_meta_t *meta);
+
+/**
+ * @brief Discard the cached metadata of the slot @param seq, it is called before the slot is written.
+ *
+ * @return
+ *      -   ESP_OK                  : On success, or if no metadata is cached
+ *      -   Others                  : Failed to write NVS
+ */
+esp_err_t esp_rcp_image_meta_erase(int8_t seq);
+
+#ifdef __cplusplus
+}
+#endif
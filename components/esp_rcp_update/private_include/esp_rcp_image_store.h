@@ -0,0 +1,195 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "esp_err.h"
+#include "esp_rcp_firmware.h"
+#include "sdkconfig.h"
+
+#if CONFIG_RCP_IMAGE_STORE_RAW_PARTITION
+#include "esp_partition.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The number of image slots. */
+#define ESP_RCP_IMAGE_SLOT_NUM 2
+
+/* The subfile tags below this are indexed by their value, FILETAG_IMAGE_FORMAT is indexed after them. */
+#define ESP_RCP_IMAGE_INDEX_TAG_NUM 8
+
+/**
+ * @brief The parsed header of the image in a slot.
+ *
+ * The index is built when the image is first opened for reading and cached until the slot is written again, so that
+ * subfile lookups do not read the storage.
+ */
+typedef struct esp_rcp_image_index {
+    bool valid;                                        /* whether the index matches the image in the slot */
+    uint8_t subfile_num;                               /* the number of header entries, including the header */
+    esp_rcp_subfile_info_t subfiles[MAX_SUBFILE_INFO]; /* the header entries */
+    int8_t positions[ESP_RCP_IMAGE_INDEX_TAG_NUM + 1]; /* the entry of each indexed tag in subfiles, -1 if absent */
+} esp_rcp_image_index_t;
+
+/**
+ * @brief An RCP image slot opened for reading or writing.
+ *
+ * The slot is the "rcp_image" file in the "<firmware_dir>_<seq>" directory, or the raw data partition
+ * "<CONFIG_RCP_PARTITION_NAME>_<seq>" if CONFIG_RCP_IMAGE_STORE_RAW_PARTITION is enabled. All the accesses are
+ * addressed by the offset in the image.
+ */
+typedef struct esp_rcp_image {
+#if CONFIG_RCP_IMAGE_STORE_RAW_PARTITION
+    const esp_partition_t *partition;          /* the partition of the slot */
+    esp_partition_mmap_handle_t mmap_handle;   /* the mapping of the partition, for reading */
+    const uint8_t *data;                       /* the mapped partition, NULL if opened for writing */
+    uint32_t erased_size;                      /* the bytes erased from the start of the partition, for writing */
+#else
+    FILE *fp;                                  /* the image file */
+    long position;                             /* the current position of fp */
+#endif
+    const esp_rcp_image_index_t *index;        /* the index of the image, NULL if opened for writing */
+    int8_t seq;                                /* the update sequence of the slot */
+    bool written;                              /* whether the image has been written since it was opened */
+    bool opened;                               /* whether the slot is opened */
+} esp_rcp_image_t;
+
+/**
+ * @brief Initialize the image store, it shall be called before any slot is opened.
+ *
+ * It is called by esp_rcp_update_init(), calling it again does nothing.
+ *
+ * @return
+ *      -   ESP_OK                  : On success
+ *      -   ESP_FAIL                : Failed to create the lock of the store
+ */
+esp_err_t esp_rcp_image_store_init(void);
+
+/**
+ * @brief Open the image in the slot @param seq for reading.
+ *
+ * The image header is parsed into the index of the slot unless it is already cached.
+ *
+ * @param[in]  seq      The update sequence of the slot.
+ * @param[out] image    The opened image.
+ *
+ * @return
+ *      -   ESP_OK                  : On success
+ *      -   ESP_ERR_NOT_FOUND       : The slot does not exist
+ *      -   ESP_FAIL                : Failed to map the partition or the image header is invalid
+ */
+esp_err_t esp_rcp_image_open(int8_t seq, esp_rcp_image_t *image);
+
+/**
+ * @brief Open the slot @param seq for writing a new image, the previous content and index of the slot are discarded.
+ *
+ * @param[in]  seq      The update sequence of the slot.
+ * @param[out] image    The opened image.
+ *
+ * @return
+ *      -   ESP_OK                  : On success
+ *      -   ESP_ERR_NOT_FOUND       : The slot does not exist
+ *      -   ESP_FAIL                : Failed to create the image file
+ */
+esp_err_t esp_rcp_image_create(int8_t seq, esp_rcp_image_t *image);
+
+/**
+ * @brief Reopen the slot @param seq for writing the image after the first @param offset bytes, which are kept.
+ *
+ * With CONFIG_RCP_IMAGE_STORE_RAW_PARTITION, @param offset is moved back to the start of its flash sector, since the
+ * rest of the sector may have been programmed. The data from there shall be written again.
+ *
+ * @param[in]    seq      The update sequence of the slot.
+ * @param[inout] offset   The size of the image written in the slot, set to the offset at which writing continues.
+ * @param[out]   image    The opened image.
+ *
+ * @return
+ *      -   ESP_OK                  : On success
+ *      -   ESP_ERR_NOT_FOUND       : The slot does not exist
+ *      -   ESP_ERR_INVALID_SIZE    : The slot holds less than @param offset bytes
+ *      -   ESP_FAIL                : Failed to open the slot
+ */
+esp_err_t esp_rcp_image_resume(int8_t seq, uint32_t *offset, esp_rcp_image_t *image);
+
+/**
+ * @brief Read @param size bytes at @param offset of the image into @param buf.
+ *
+ * @return
+ *      -   ESP_OK                  : On success
+ *      -   ESP_ERR_INVALID_SIZE    : The range exceeds the slot
+ *      -   ESP_FAIL                : Failed to read the image file
+ */
+esp_err_t esp_rcp_image_read(esp_rcp_image_t *image, uint32_t offset, void *buf, size_t size);
+
+/**
+ * @brief Get the size of the slot of @param image, the size of the image file or of the raw partition.
+ *
+ * @return
+ *      -   ESP_OK                  : On success
+ *      -   ESP_FAIL                : Failed to get the size of the image file
+ */
+esp_err_t esp_rcp_image_get_slot_size(esp_rcp_image_t *image, uint32_t *size);
+
+/**
+ * @brief Find the subfile with @param tag in the index of the image, FILETAG_FLAG_COMPRESSED is ignored.
+ *
+ * @param[in]  image    The image opened for reading.
+ * @param[in]  tag      The tag of the subfile.
+ * @param[out] info     The header entry of the subfile.
+ *
+ * @return
+ *      -   ESP_OK                  : On success
+ *      -   ESP_ERR_NOT_FOUND       : The subfile does not exist
+ */
+esp_err_t esp_rcp_image_find_subfile(esp_rcp_image_t *image, esp_rcp_filetag_t tag, esp_rcp_subfile_info_t *info);
+
+/**
+ * @brief Discard the cached index of the slot @param seq, the header is parsed again on the next opening.
+ */
+void esp_rcp_image_invalidate_index(int8_t seq);
+
+/**
+ * @brief Write @param size bytes of @param data at @param offset of the image.
+ *
+ * The raw partition is erased sector by sector ahead of the written data. The first write discards the cached index
+ * and metadata of the slot again, in case the slot was read and cached since it was opened for writing.
+ *
+ * @return
+ *      -   ESP_OK                  : On success
+ *      -   ESP_ERR_INVALID_SIZE    : The range exceeds the slot
+ *      -   ESP_FAIL                : Failed to write the slot
+ */
+esp_err_t esp_rcp_image_write(esp_rcp_image_t *image, uint32_t offset, const void *data, size_t size);
+
+/**
+ * @brief Make the written data persistent.
+ *
+ * @return
+ *      -   ESP_OK                  : On success
+ *      -   ESP_FAIL                : Failed to sync the image file
+ */
+esp_err_t esp_rcp_image_sync(esp_rcp_image_t *image);
+
+/**
+ * @brief Close the image, it does nothing if @param image is not opened.
+ *
+ * @return
+ *      -   ESP_OK                  : On success
+ *      -   ESP_FAIL                : Failed to close the image file
+ */
+esp_err_t esp_rcp_image_close(esp_rcp_image_t *image);
+
+#ifdef __cplusplus
+}
+#endif
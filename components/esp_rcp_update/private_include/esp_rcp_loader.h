@@ -0,0 +1,38 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Reset the RCP into its serial loader and connect to it with the config passed to esp_rcp_update_init().
+ *
+ * @note The UART of the RCP shall not be used by the Thread stack.
+ *
+ * @return
+ *      -   ESP_OK                  : On success
+ *      -   ESP_ERR_INVALID_STATE   : The RCP update is not initialized
+ *      -   Others                  : Failed to connect to the loader
+ */
+esp_err_t esp_rcp_loader_connect(void);
+
+/**
+ * @brief Reset the RCP into its firmware and release the UART.
+ *
+ * @return
+ *      -   ESP_OK                  : On success
+ *      -   Others                  : Failed to multiplex the boot pin
+ */
+esp_err_t esp_rcp_loader_disconnect(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,68 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief The flashing of an RCP image to the RCP while the image is being received.
+ *
+ * The subfiles listed in the flash args are sent to the RCP loader as their data arrives. Each of them is verified
+ * by MD5 once it is complete, and the flashed regions are checked against the region digests of the image.
+ */
+typedef struct esp_rcp_stream esp_rcp_stream_t;
+
+/**
+ * @brief Connect to the RCP loader and start streaming an image.
+ *
+ * @param[in]  image_header     The image header, an array of esp_rcp_subfile_info_t.
+ * @param[in]  header_size      The size of @param image_header in bytes.
+ * @param[out] out_stream       The created stream.
+ *
+ * @return
+ *      -   ESP_OK                  : On success
+ *      -   ESP_ERR_NOT_SUPPORTED   : The image layout does not allow streaming
+ *      -   ESP_ERR_NO_MEM          : Failed to allocate the stream
+ *      -   Others                  : Failed to connect to the RCP loader
+ */
+esp_err_t esp_rcp_stream_begin(const uint8_t *image_header, size_t header_size, esp_rcp_stream_t **out_stream);
+
+/**
+ * @brief Feed @param size bytes at @param offset of the image, the image shall be fed in order.
+ *
+ * @return
+ *      -   ESP_OK                  : On success
+ *      -   ESP_ERR_INVALID_STATE   : The data is out of order or a subfile is not flashable
+ *      -   ESP_ERR_INVALID_CRC     : The flashed data does not match its digest
+ *      -   ESP_FAIL                : Failed to flash the RCP
+ */
+esp_err_t esp_rcp_stream_write(esp_rcp_stream_t *stream, uint32_t offset, const uint8_t *data, size_t size);
+
+/**
+ * @brief Check that every subfile is flashed and verified, reset the RCP and free @param stream.
+ *
+ * @return
+ *      -   ESP_OK                  : The RCP is flashed with the image
+ *      -   ESP_ERR_INVALID_STATE   : Some subfiles are not flashed or not verified
+ */
+esp_err_t esp_rcp_stream_end(esp_rcp_stream_t *stream);
+
+/**
+ * @brief Stop streaming, reset the RCP and free @param stream.
+ */
+void esp_rcp_stream_abort(esp_rcp_stream_t *stream);
+
+#ifdef __cplusplus
+}
+#endif
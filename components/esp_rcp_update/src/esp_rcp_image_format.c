@@ -0,0 +1,130 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "esp_rcp_image_format.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_check.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "mbedtls/sha256.h"
+
+#define TAG "RCP_IMAGE_FORMAT"
+#define VERIFY_READ_SIZE 4096
+
+bool esp_rcp_image_is_stored_subfile(uint32_t tag)
+{
+    tag &= FILETAG_MASK;
+    return tag == FILETAG_IMAGE_HEADER || tag == FILETAG_IMAGE_FORMAT || tag == FILETAG_RCP_VERSION ||
+        tag == FILETAG_RCP_FLASH_ARGS || tag == FILETAG_RCP_BOOTLOADER || tag == FILETAG_RCP_PARTITION_TABLE ||
+        tag == FILETAG_RCP_FIRMWARE || tag == FILETAG_RCP_REGION_DIGESTS;
+}
+
+static const esp_rcp_subfile_digest_t *get_digests(const void *format)
+{
+    return (const esp_rcp_subfile_digest_t *)((const uint8_t *)format + sizeof(esp_rcp_image_format_t));
+}
+
+esp_err_t esp_rcp_image_format_check(const void *format, size_t format_size, const esp_rcp_subfile_info_t *header,
+                                     size_t header_num)
+{
+    const esp_rcp_image_format_t *info = format;
+    size_t digest_num = 0;
+
+    ESP_RETURN_ON_FALSE(format_size >= sizeof(*info), ESP_ERR_INVALID_ARG, TAG, "Image format is too short");
+    ESP_RETURN_ON_FALSE(info->version == ESP_RCP_IMAGE_FORMAT_VERSION, ESP_ERR_INVALID_VERSION, TAG,
+                        "Unsupported image format version %lu", info->version);
+    ESP_RETURN_ON_FALSE(info->entry_count <= MAX_SUBFILE_INFO - 2 &&
+                            format_size == sizeof(*info) + info->entry_count * sizeof(esp_rcp_subfile_digest_t),
+                        ESP_ERR_INVALID_ARG, TAG, "Invalid image format size %u", format_size);
+    for (size_t i = 0; i < header_num; i++) {
+        uint32_t tag = header[i].tag & FILETAG_MASK;
+        if (tag == FILETAG_IMAGE_HEADER || tag == FILETAG_IMAGE_FORMAT) {
+            continue;
+        }
+        const esp_rcp_subfile_digest_t *digest = esp_rcp_image_format_find_digest(format, tag);
+        ESP_RETURN_ON_FALSE(digest && digest->tag == header[i].tag, ESP_ERR_INVALID_ARG, TAG,
+                            "No digest of subfile %lu", tag);
+        ESP_RETURN_ON_FALSE((header[i].tag & FILETAG_FLAG_COMPRESSED) || digest->raw_size == header[i].size,
+                            ESP_ERR_INVALID_ARG, TAG, "Size of subfile %lu does not match its digest", tag);
+        digest_num++;
+    }
+    ESP_RETURN_ON_FALSE(digest_num == info->entry_count, ESP_ERR_INVALID_ARG, TAG,
+                        "Image format has %lu digests for %u subfiles", info->entry_count, digest_num);
+    return ESP_OK;
+}
+
+const esp_rcp_subfile_digest_t *esp_rcp_image_format_find_digest(const void *format, uint32_t tag)
+{
+    const esp_rcp_image_format_t *info = format;
+    const esp_rcp_subfile_digest_t *digests = get_digests(format);
+
+    for (uint32_t i = 0; i < info->entry_count; i++) {
+        if ((digests[i].tag & FILETAG_MASK) == (tag & FILETAG_MASK)) {
+            return &digests[i];
+        }
+    }
+    return NULL;
+}
+
+static esp_err_t verify_subfile(esp_rcp_image_t *image, const esp_rcp_subfile_info_t *subfile,
+                                const esp_rcp_subfile_digest_t *digest, uint8_t *buf)
+{
+    esp_err_t ret = ESP_OK;
+    uint8_t sha256[sizeof(digest->sha256)];
+    mbedtls_sha256_context ctx;
+
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_starts(&ctx, 0);
+    for (uint32_t done = 0; done < subfile->size;) {
+        size_t read_size = subfile->size - done < VERIFY_READ_SIZE ? subfile->size - done : VERIFY_READ_SIZE;
+        ESP_GOTO_ON_ERROR(esp_rcp_image_read(image, subfile->offset + done, buf, read_size), exit, TAG,
+                          "Failed to read subfile %lu", subfile->tag & FILETAG_MASK);
+        mbedtls_sha256_update(&ctx, buf, read_size);
+        done += read_size;
+    }
+    mbedtls_sha256_finish(&ctx, sha256);
+    ESP_GOTO_ON_FALSE(memcmp(sha256, digest->sha256, sizeof(sha256)) == 0, ESP_ERR_INVALID_CRC, exit, TAG,
+                      "Subfile %lu does not match its SHA-256 digest", subfile->tag & FILETAG_MASK);
+exit:
+    mbedtls_sha256_free(&ctx);
+    return ret;
+}
+
+esp_err_t esp_rcp_image_verify_digests(esp_rcp_image_t *image)
+{
+    esp_err_t ret = ESP_OK;
+    const esp_rcp_subfile_info_t *header = image->index->subfiles;
+    size_t header_num = image->index->subfile_num;
+    esp_rcp_subfile_info_t format_info;
+    uint8_t format[ESP_RCP_IMAGE_FORMAT_MAX_LEN];
+    uint8_t *buf = NULL;
+
+    if (esp_rcp_image_find_subfile(image, FILETAG_IMAGE_FORMAT, &format_info) != ESP_OK) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    ESP_RETURN_ON_FALSE(format_info.size <= sizeof(format) &&
+                            esp_rcp_image_read(image, format_info.offset, format, format_info.size) == ESP_OK,
+                        ESP_FAIL, TAG, "Failed to read the image format");
+    ESP_RETURN_ON_FALSE(esp_rcp_image_format_check(format, format_info.size, header, header_num) == ESP_OK, ESP_FAIL,
+                        TAG, "Invalid image format");
+
+    buf = malloc(VERIFY_READ_SIZE);
+    ESP_RETURN_ON_FALSE(buf, ESP_ERR_NO_MEM, TAG, "Failed to allocate the read buffer");
+    for (size_t i = 0; i < header_num; i++) {
+        uint32_t tag = header[i].tag & FILETAG_MASK;
+        if (tag == FILETAG_IMAGE_HEADER || tag == FILETAG_IMAGE_FORMAT || !esp_rcp_image_is_stored_subfile(tag)) {
+            continue;
+        }
+        ESP_GOTO_ON_ERROR(verify_subfile(image, &header[i], esp_rcp_image_format_find_digest(format, tag), buf), exit,
+                          TAG, "Failed to verify the image");
+    }
+exit:
+    free(buf);
+    return ret;
+}
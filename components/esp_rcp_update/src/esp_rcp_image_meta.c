@@ -0,0 +1,165 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "esp_rcp_image_meta.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_app_desc.h"
+#include "esp_check.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_rcp_firmware.h"
+#include "mbedtls/sha256.h"
+#include "nvs.h"
+
+#define RCP_META_NAMESPACE "storage"
+#define RCP_META_KEY_FORMAT "rcp_meta_%d"
+#define RCP_META_KEY_SIZE 16
+#define RCP_META_READ_CHUNK_SIZE 256
+#define TAG "RCP_IMAGE_META"
+
+static void get_meta_key(int8_t seq, char *key)
+{
+    snprintf(key, RCP_META_KEY_SIZE, RCP_META_KEY_FORMAT, seq);
+}
+
+static esp_err_t compute_image_digest(esp_rcp_image_t *image, uint8_t *digest)
+{
+    esp_err_t ret = ESP_OK;
+    mbedtls_sha256_context ctx;
+    esp_rcp_subfile_info_t format_info;
+    uint8_t buf[RCP_META_READ_CHUNK_SIZE];
+
+    // The same digest as the image ID of an OTA download, the header followed by the image format if any.
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_starts(&ctx, 0);
+    mbedtls_sha256_update(&ctx, (const uint8_t *)image->index->subfiles,
+                          image->index->subfile_num * sizeof(esp_rcp_subfile_info_t));
+    if (esp_rcp_image_find_subfile(image, FILETAG_IMAGE_FORMAT, &format_info) == ESP_OK) {
+        for (uint32_t done = 0; done < format_info.size;) {
+            size_t size = format_info.size - done < sizeof(buf) ? format_info.size - done : sizeof(buf);
+            ESP_GOTO_ON_ERROR(esp_rcp_image_read(image, format_info.offset + done, buf, size), exit, TAG,
+                              "Failed to read the image format");
+            mbedtls_sha256_update(&ctx, buf, size);
+            done += size;
+        }
+    }
+    mbedtls_sha256_finish(&ctx, digest);
+exit:
+    mbedtls_sha256_free(&ctx);
+    return ret;
+}
+
+// Only the size of the slot and its header and image format are read, not the whole storage. A slot written by
+// the firmware discards its metadata, so this only catches the storage flashed without the firmware.
+static esp_err_t check_storage(int8_t seq, const esp_rcp_image_meta_t *meta)
+{
+    esp_err_t ret = ESP_OK;
+    esp_rcp_image_t image;
+    uint32_t slot_size = 0;
+    uint8_t digest[sizeof(meta->digest)];
+
+    ESP_RETURN_ON_ERROR(esp_rcp_image_open(seq, &image), TAG, "Failed to open image %d", seq);
+    ESP_GOTO_ON_ERROR(esp_rcp_image_get_slot_size(&image, &slot_size), exit, TAG, "Failed to get the size of slot %d",
+                      seq);
+    ESP_GOTO_ON_FALSE(slot_size == meta->slot_size, ESP_ERR_INVALID_SIZE, exit, TAG, "Slot %d has been resized", seq);
+    ESP_GOTO_ON_ERROR(compute_image_digest(&image, digest), exit, TAG, "Failed to hash image %d", seq);
+    ESP_GOTO_ON_FALSE(memcmp(digest, meta->digest, sizeof(digest)) == 0, ESP_ERR_INVALID_CRC, exit, TAG,
+                      "The header of slot %d has changed", seq);
+exit:
+    esp_rcp_image_close(&image);
+    return ret;
+}
+
+esp_err_t esp_rcp_image_meta_read(esp_rcp_image_t *image, esp_rcp_image_meta_t *meta)
+{
+    esp_rcp_subfile_info_t version_info;
+
+    memset(meta, 0, sizeof(*meta));
+    memcpy(meta->app_sha256, esp_app_get_description()->app_elf_sha256, sizeof(meta->app_sha256));
+    ESP_RETURN_ON_ERROR(esp_rcp_image_find_subfile(image, FILETAG_RCP_VERSION, &version_info), TAG,
+                        "Failed to find version subfile");
+    ESP_RETURN_ON_FALSE(version_info.size < sizeof(meta->version), ESP_ERR_INVALID_SIZE, TAG,
+                        "RCP version of %lu bytes is too long to cache", version_info.size);
+    ESP_RETURN_ON_ERROR(esp_rcp_image_read(image, version_info.offset, meta->version, version_info.size), TAG,
+                        "Failed to read version subfile");
+    for (uint8_t i = 1; i < image->index->subfile_num; i++) {
+        const esp_rcp_subfile_info_t *subfile = &image->index->subfiles[i];
+        if (subfile->offset + subfile->size > meta->image_size) {
+            meta->image_size = subfile->offset + subfile->size;
+        }
+    }
+    ESP_RETURN_ON_ERROR(esp_rcp_image_get_slot_size(image, &meta->slot_size), TAG, "Failed to get the slot size");
+    ESP_RETURN_ON_ERROR(compute_image_digest(image, meta->digest), TAG, "Failed to hash the image");
+    return ESP_OK;
+}
+
+esp_err_t esp_rcp_image_meta_load(int8_t seq, esp_rcp_image_meta_t *meta)
+{
+    esp_err_t ret = ESP_OK;
+    nvs_handle_t handle;
+    char key[RCP_META_KEY_SIZE];
+    size_t size = sizeof(*meta);
+
+    ret = nvs_open(RCP_META_NAMESPACE, NVS_READONLY, &handle);
+    if (ret == ESP_ERR_NVS_NOT_FOUND) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    ESP_RETURN_ON_ERROR(ret, TAG, "Failed to open nvs");
+    get_meta_key(seq, key);
+    ret = nvs_get_blob(handle, key, meta, &size);
+    nvs_close(handle);
+    if (ret == ESP_ERR_NVS_NOT_FOUND || (ret == ESP_OK && size != sizeof(*meta))) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    ESP_RETURN_ON_ERROR(ret, TAG, "Failed to read %s", key);
+    if (memcmp(meta->app_sha256, esp_app_get_description()->app_elf_sha256, sizeof(meta->app_sha256)) != 0) {
+        ESP_LOGD(TAG, "Ignoring the metadata of slot %d cached by another firmware", seq);
+        return ESP_ERR_NOT_FOUND;
+    }
+    // The storage may have been flashed without the firmware, for example by esptool.
+    if (check_storage(seq, meta) != ESP_OK) {
+        ESP_LOGW(TAG, "Ignoring the metadata of slot %d, the storage has changed", seq);
+        return ESP_ERR_NOT_FOUND;
+    }
+    meta->version[sizeof(meta->version) - 1] = '\0';
+    return ESP_OK;
+}
+
+esp_err_t esp_rcp_image_meta_save(int8_t seq, const esp_rcp_image_meta_t *meta)
+{
+    esp_err_t ret = ESP_OK;
+    nvs_handle_t handle;
+    char key[RCP_META_KEY_SIZE];
+
+    ESP_RETURN_ON_ERROR(nvs_open(RCP_META_NAMESPACE, NVS_READWRITE, &handle), TAG, "Failed to open nvs");
+    get_meta_key(seq, key);
+    ESP_GOTO_ON_ERROR(nvs_set_blob(handle, key, meta, sizeof(*meta)), exit, TAG, "Failed to write %s", key);
+    ESP_GOTO_ON_ERROR(nvs_commit(handle), exit, TAG, "Failed to commit %s", key);
+exit:
+    nvs_close(handle);
+    return ret;
+}
+
+esp_err_t esp_rcp_image_meta_erase(int8_t seq)
+{
+    esp_err_t ret = ESP_OK;
+    nvs_handle_t handle;
+    char key[RCP_META_KEY_SIZE];
+
+    ESP_RETURN_ON_ERROR(nvs_open(RCP_META_NAMESPACE, NVS_READWRITE, &handle), TAG, "Failed to open nvs");
+    get_meta_key(seq, key);
+    ret = nvs_erase_key(handle, key);
+    if (ret == ESP_ERR_NVS_NOT_FOUND) {
+        ret = ESP_OK;
+    } else if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    return ret;
+}
@@ -0,0 +1,438 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "esp_rcp_image_store.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "esp_check.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_rcp_firmware.h"
+#include "esp_rcp_image_meta.h"
+#include "esp_rcp_update.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#if CONFIG_AUTO_UPDATE_RCP && !CONFIG_RCP_IMAGE_STORE_RAW_PARTITION
+#include "esp_spiffs.h"
+#include "esp_timer.h"
+#endif
+
+#define RCP_STORAGE_MAX_FILES 10
+#define TAG "RCP_IMAGE"
+
+static esp_rcp_image_index_t s_indexes[ESP_RCP_IMAGE_SLOT_NUM];
+static SemaphoreHandle_t s_store_lock = NULL;
+static StaticSemaphore_t s_store_lock_buffer;
+
+// The indexes and the mount of the storage are shared by the boot and the OTA tasks, which may open slots at once.
+static void store_lock(void)
+{
+    assert(s_store_lock != NULL);
+    xSemaphoreTake(s_store_lock, portMAX_DELAY);
+}
+
+static void store_unlock(void)
+{
+    xSemaphoreGive(s_store_lock);
+}
+
+esp_err_t esp_rcp_image_store_init(void)
+{
+    if (s_store_lock == NULL) {
+        s_store_lock = xSemaphoreCreateMutexStatic(&s_store_lock_buffer);
+    }
+    ESP_RETURN_ON_FALSE(s_store_lock, ESP_FAIL, TAG, "Failed to create the store lock");
+    return ESP_OK;
+}
+
+static int index_position(uint32_t tag)
+{
+    tag &= FILETAG_MASK;
+    if (tag < ESP_RCP_IMAGE_INDEX_TAG_NUM) {
+        return tag;
+    }
+    return tag == FILETAG_IMAGE_FORMAT ? ESP_RCP_IMAGE_INDEX_TAG_NUM : -1;
+}
+
+static esp_err_t build_index(esp_rcp_image_t *image, uint32_t image_size, esp_rcp_image_index_t *index)
+{
+    esp_rcp_subfile_info_t *subfiles = index->subfiles;
+
+    memset(index, 0, sizeof(*index));
+    memset(index->positions, -1, sizeof(index->positions));
+    ESP_RETURN_ON_FALSE(esp_rcp_image_read(image, 0, subfiles, sizeof(subfiles[0])) == ESP_OK, ESP_FAIL, TAG,
+                        "Failed to read the image header");
+    // An erased slot reads as 0xff, which does not match the tag of the header.
+    uint32_t header_size = subfiles[0].size;
+    ESP_RETURN_ON_FALSE(subfiles[0].tag == FILETAG_IMAGE_HEADER && header_size >= sizeof(subfiles[0]) &&
+                            header_size % sizeof(subfiles[0]) == 0 && header_size <= sizeof(index->subfiles),
+                        ESP_FAIL, TAG, "Invalid image header");
+    ESP_RETURN_ON_FALSE(esp_rcp_image_read(image, 0, subfiles, header_size) == ESP_OK, ESP_FAIL, TAG,
+                        "Failed to read the image header");
+    index->subfile_num = header_size / sizeof(subfiles[0]);
+    for (int i = 1; i < index->subfile_num; i++) {
+        ESP_RETURN_ON_FALSE(subfiles[i].offset <= image_size && subfiles[i].size <= image_size - subfiles[i].offset,
+                            ESP_FAIL, TAG, "Subfile %lu exceeds the image", subfiles[i].tag & FILETAG_MASK);
+        int position = index_position(subfiles[i].tag);
+        if (position >= 0 && index->positions[position] < 0) {
+            index->positions[position] = i;
+        }
+    }
+    index->valid = true;
+    return ESP_OK;
+}
+
+static esp_err_t load_index(esp_rcp_image_t *image, int8_t seq, uint32_t image_size)
+{
+    esp_err_t ret = ESP_OK;
+    esp_rcp_image_index_t *index = &s_indexes[seq];
+
+    store_lock();
+    if (!index->valid) {
+        ret = build_index(image, image_size, index);
+    }
+    store_unlock();
+    ESP_RETURN_ON_ERROR(ret, TAG, "Failed to index image %d", seq);
+    image->index = index;
+    return ESP_OK;
+}
+
+void esp_rcp_image_invalidate_index(int8_t seq)
+{
+    if (seq >= 0 && seq < ESP_RCP_IMAGE_SLOT_NUM) {
+        store_lock();
+        s_indexes[seq].valid = false;
+        store_unlock();
+    }
+}
+
+// The cached index and metadata of the slot do not match the image once the slot is written.
+static esp_err_t discard_slot_cache(int8_t seq)
+{
+    esp_rcp_image_invalidate_index(seq);
+    ESP_RETURN_ON_ERROR(esp_rcp_image_meta_erase(seq), TAG, "Failed to discard the metadata of slot %d", seq);
+    return ESP_OK;
+}
+
+// A reader may have cached the slot again since it was opened for writing, the cache is discarded once more when
+// the image is first written.
+static esp_err_t discard_slot_cache_on_write(esp_rcp_image_t *image)
+{
+    if (!image->written) {
+        ESP_RETURN_ON_ERROR(discard_slot_cache(image->seq), TAG, "Failed to write slot %d", image->seq);
+        image->written = true;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_rcp_image_find_subfile(esp_rcp_image_t *image, esp_rcp_filetag_t tag, esp_rcp_subfile_info_t *info)
+{
+    int position = index_position(tag);
+
+    if (position < 0 || image->index->positions[position] < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    *info = image->index->subfiles[image->index->positions[position]];
+    return ESP_OK;
+}
+
+#if CONFIG_RCP_IMAGE_STORE_RAW_PARTITION
+
+static const esp_partition_t *find_slot_partition(int8_t seq)
+{
+    char label[sizeof(((esp_partition_t *)0)->label)];
+
+    snprintf(label, sizeof(label), "%s_%d", CONFIG_RCP_PARTITION_NAME, seq);
+    const esp_partition_t *partition =
+        esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    if (partition == NULL) {
+        ESP_LOGE(TAG, "Cannot find partition %s", label);
+    }
+    return partition;
+}
+
+esp_err_t esp_rcp_image_open(int8_t seq, esp_rcp_image_t *image)
+{
+    const void *data = NULL;
+
+    memset(image, 0, sizeof(*image));
+    ESP_RETURN_ON_FALSE(seq >= 0 && seq < ESP_RCP_IMAGE_SLOT_NUM, ESP_ERR_NOT_FOUND, TAG, "Invalid slot %d", seq);
+    image->partition = find_slot_partition(seq);
+    ESP_RETURN_ON_FALSE(image->partition, ESP_ERR_NOT_FOUND, TAG, "Cannot find rcp image");
+    ESP_RETURN_ON_ERROR(esp_partition_mmap(image->partition, 0, image->partition->size, ESP_PARTITION_MMAP_DATA,
+                                           &data, &image->mmap_handle),
+                        TAG, "Failed to map partition %s", image->partition->label);
+    image->data = data;
+    image->seq = seq;
+    image->opened = true;
+    if (load_index(image, seq, image->partition->size) != ESP_OK) {
+        esp_rcp_image_close(image);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_rcp_image_create(int8_t seq, esp_rcp_image_t *image)
+{
+    memset(image, 0, sizeof(*image));
+    ESP_RETURN_ON_FALSE(seq >= 0 && seq < ESP_RCP_IMAGE_SLOT_NUM, ESP_ERR_NOT_FOUND, TAG, "Invalid slot %d", seq);
+    ESP_RETURN_ON_ERROR(discard_slot_cache(seq), TAG, "Failed to open slot %d for writing", seq);
+    image->partition = find_slot_partition(seq);
+    ESP_RETURN_ON_FALSE(image->partition, ESP_ERR_NOT_FOUND, TAG, "Cannot create rcp image");
+    image->seq = seq;
+    image->opened = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_rcp_image_resume(int8_t seq, uint32_t *offset, esp_rcp_image_t *image)
+{
+    ESP_RETURN_ON_ERROR(esp_rcp_image_create(seq, image), TAG, "Cannot resume rcp image");
+    const esp_partition_t *partition = image->partition;
+    if (*offset > partition->size) {
+        ESP_LOGE(TAG, "Offset %lu exceeds partition %s", *offset, partition->label);
+        esp_rcp_image_close(image);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    // The sector holding the offset may have been programmed after it before the interruption, so the writing
+    // continues at the start of that sector, which is erased by the first write. The sectors before it are never
+    // erased again, an interrupted resume can then be resumed from the same checkpoint.
+    *offset -= *offset % partition->erase_size;
+    image->erased_size = *offset;
+    return ESP_OK;
+}
+
+esp_err_t esp_rcp_image_read(esp_rcp_image_t *image, uint32_t offset, void *buf, size_t size)
+{
+    ESP_RETURN_ON_FALSE(offset <= image->partition->size && size <= image->partition->size - offset,
+                        ESP_ERR_INVALID_SIZE, TAG, "Read of %u bytes at %lu exceeds partition %s", size, offset,
+                        image->partition->label);
+    if (image->data == NULL) {
+        // The slot is opened for writing and not mapped.
+        return esp_partition_read(image->partition, offset, buf, size);
+    }
+    memcpy(buf, image->data + offset, size);
+    return ESP_OK;
+}
+
+esp_err_t esp_rcp_image_write(esp_rcp_image_t *image, uint32_t offset, const void *data, size_t size)
+{
+    const esp_partition_t *partition = image->partition;
+
+    ESP_RETURN_ON_FALSE(offset <= partition->size && size <= partition->size - offset, ESP_ERR_INVALID_SIZE, TAG,
+                        "RCP image of %lu bytes exceeds partition %s", offset + size, partition->label);
+    ESP_RETURN_ON_ERROR(discard_slot_cache_on_write(image), TAG, "Failed to write image");
+    if (offset + size > image->erased_size) {
+        uint32_t erase_size = partition->erase_size;
+        uint32_t erase_end = (offset + size + erase_size - 1) / erase_size * erase_size;
+        ESP_RETURN_ON_ERROR(esp_partition_erase_range(partition, image->erased_size, erase_end - image->erased_size),
+                            TAG, "Failed to erase partition %s at %lu", partition->label, image->erased_size);
+        image->erased_size = erase_end;
+    }
+    ESP_RETURN_ON_ERROR(esp_partition_write(partition, offset, data, size), TAG,
+                        "Failed to write %u bytes at %lu of partition %s", size, offset, partition->label);
+    return ESP_OK;
+}
+
+esp_err_t esp_rcp_image_get_slot_size(esp_rcp_image_t *image, uint32_t *size)
+{
+    *size = image->partition->size;
+    return ESP_OK;
+}
+
+esp_err_t esp_rcp_image_sync(esp_rcp_image_t *image)
+{
+    // esp_partition_write() returns once the data is programmed.
+    return ESP_OK;
+}
+
+esp_err_t esp_rcp_image_close(esp_rcp_image_t *image)
+{
+    if (image->opened && image->data) {
+        esp_partition_munmap(image->mmap_handle);
+    }
+    memset(image, 0, sizeof(*image));
+    return ESP_OK;
+}
+
+#else
+
+static void get_slot_path(int8_t seq, char *path, size_t size)
+{
+    snprintf(path, size, "%s_%d/" ESP_RCP_IMAGE_FILENAME, esp_rcp_get_firmware_dir(), seq);
+}
+
+// The storage is mounted on the first access to a slot, so that a boot without RCP update does not mount it.
+static esp_err_t do_mount_storage(void)
+{
+#if CONFIG_AUTO_UPDATE_RCP
+    char base_path[RCP_FIRMWARE_DIR_SIZE];
+    const char *firmware_dir = esp_rcp_get_firmware_dir();
+    const char *dir_end = strchr(firmware_dir + 1, '/');
+
+    if (esp_spiffs_mounted(CONFIG_RCP_PARTITION_NAME)) {
+        return ESP_OK;
+    }
+    // The storage is mounted at the first directory of the firmware directory.
+    snprintf(base_path, sizeof(base_path), "%.*s", dir_end ? (int)(dir_end - firmware_dir) : (int)strlen(firmware_dir),
+             firmware_dir);
+    esp_vfs_spiffs_conf_t conf = {
+        .base_path = base_path,
+        .partition_label = CONFIG_RCP_PARTITION_NAME,
+        .max_files = RCP_STORAGE_MAX_FILES,
+        .format_if_mount_failed = false,
+    };
+    int64_t start_us = esp_timer_get_time();
+    ESP_RETURN_ON_ERROR(esp_vfs_spiffs_register(&conf), TAG, "Failed to mount rcp firmware storage");
+    ESP_LOGI(TAG, "Mounted %s at %s in %lld ms", CONFIG_RCP_PARTITION_NAME, base_path,
+             (esp_timer_get_time() - start_us) / 1000);
+#endif
+    return ESP_OK;
+}
+
+static esp_err_t mount_storage(void)
+{
+    store_lock();
+    esp_err_t ret = do_mount_storage();
+    store_unlock();
+    return ret;
+}
+
+esp_err_t esp_rcp_image_open(int8_t seq, esp_rcp_image_t *image)
+{
+    char path[RCP_FILENAME_MAX_SIZE];
+
+    memset(image, 0, sizeof(*image));
+    ESP_RETURN_ON_FALSE(seq >= 0 && seq < ESP_RCP_IMAGE_SLOT_NUM, ESP_ERR_NOT_FOUND, TAG, "Invalid slot %d", seq);
+    ESP_RETURN_ON_ERROR(mount_storage(), TAG, "Cannot open rcp image");
+    get_slot_path(seq, path, sizeof(path));
+    image->fp = fopen(path, "r");
+    if (image->fp == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    image->seq = seq;
+    image->opened = true;
+    if (load_index(image, seq, UINT32_MAX) != ESP_OK) {
+        esp_rcp_image_close(image);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_rcp_image_create(int8_t seq, esp_rcp_image_t *image)
+{
+    char path[RCP_FILENAME_MAX_SIZE];
+
+    memset(image, 0, sizeof(*image));
+    ESP_RETURN_ON_FALSE(seq >= 0 && seq < ESP_RCP_IMAGE_SLOT_NUM, ESP_ERR_NOT_FOUND, TAG, "Invalid slot %d", seq);
+    ESP_RETURN_ON_ERROR(discard_slot_cache(seq), TAG, "Failed to open slot %d for writing", seq);
+    ESP_RETURN_ON_ERROR(mount_storage(), TAG, "Cannot create rcp image");
+    get_slot_path(seq, path, sizeof(path));
+    image->fp = fopen(path, "w");
+    if (!image->fp) {
+        ESP_LOGE(TAG, "Fail to open %s, will delete it and create a new one", path);
+        remove(path);
+        image->fp = fopen(path, "w");
+    }
+    ESP_RETURN_ON_FALSE(image->fp, ESP_FAIL, TAG, "Fail to open %s: %s", path, strerror(errno));
+    // The writers buffer the data themselves, bypass the buffering of stdio.
+    setvbuf(image->fp, NULL, _IONBF, 0);
+    image->seq = seq;
+    image->opened = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_rcp_image_resume(int8_t seq, uint32_t *offset, esp_rcp_image_t *image)
+{
+    char path[RCP_FILENAME_MAX_SIZE];
+
+    memset(image, 0, sizeof(*image));
+    ESP_RETURN_ON_FALSE(seq >= 0 && seq < ESP_RCP_IMAGE_SLOT_NUM, ESP_ERR_NOT_FOUND, TAG, "Invalid slot %d", seq);
+    ESP_RETURN_ON_ERROR(discard_slot_cache(seq), TAG, "Failed to open slot %d for writing", seq);
+    ESP_RETURN_ON_ERROR(mount_storage(), TAG, "Cannot resume rcp image");
+    get_slot_path(seq, path, sizeof(path));
+    image->fp = fopen(path, "r+");
+    ESP_RETURN_ON_FALSE(image->fp, ESP_ERR_NOT_FOUND, TAG, "Fail to open %s: %s", path, strerror(errno));
+    setvbuf(image->fp, NULL, _IONBF, 0);
+    image->seq = seq;
+    image->opened = true;
+    if (fseek(image->fp, 0, SEEK_END) != 0 || ftell(image->fp) < (long)*offset) {
+        ESP_LOGE(TAG, "%s holds less than %lu bytes", path, *offset);
+        esp_rcp_image_close(image);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    image->position = ftell(image->fp);
+    return ESP_OK;
+}
+
+static esp_err_t seek_image(esp_rcp_image_t *image, uint32_t offset)
+{
+    if (image->position != offset) {
+        ESP_RETURN_ON_FALSE(fseek(image->fp, offset, SEEK_SET) == 0, ESP_FAIL, TAG, "Failed to seek to %lu: %s",
+                            offset, strerror(errno));
+        image->position = offset;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_rcp_image_read(esp_rcp_image_t *image, uint32_t offset, void *buf, size_t size)
+{
+    ESP_RETURN_ON_ERROR(seek_image(image, offset), TAG, "Failed to read image");
+    size_t read_size = fread(buf, 1, size, image->fp);
+    image->position += read_size;
+    ESP_RETURN_ON_FALSE(read_size == size, feof(image->fp) ? ESP_ERR_INVALID_SIZE : ESP_FAIL, TAG,
+                        "Failed to read image at %lu, %u of %u bytes read", offset, read_size, size);
+    return ESP_OK;
+}
+
+esp_err_t esp_rcp_image_write(esp_rcp_image_t *image, uint32_t offset, const void *data, size_t size)
+{
+    ESP_RETURN_ON_ERROR(discard_slot_cache_on_write(image), TAG, "Failed to write image");
+    ESP_RETURN_ON_ERROR(seek_image(image, offset), TAG, "Failed to write image");
+    size_t written = fwrite(data, 1, size, image->fp);
+    image->position += written;
+    ESP_RETURN_ON_FALSE(written == size, ESP_FAIL, TAG, "Failed to write image at %lu, %u of %u bytes written: %s",
+                        offset, written, size, strerror(errno));
+    return ESP_OK;
+}
+
+esp_err_t esp_rcp_image_get_slot_size(esp_rcp_image_t *image, uint32_t *size)
+{
+    ESP_RETURN_ON_FALSE(fseek(image->fp, 0, SEEK_END) == 0, ESP_FAIL, TAG, "Failed to seek to the end: %s",
+                        strerror(errno));
+    long end = ftell(image->fp);
+    ESP_RETURN_ON_FALSE(end >= 0, ESP_FAIL, TAG, "Failed to get the image size: %s", strerror(errno));
+    image->position = end;
+    *size = (uint32_t)end;
+    return ESP_OK;
+}
+
+esp_err_t esp_rcp_image_sync(esp_rcp_image_t *image)
+{
+    ESP_RETURN_ON_FALSE(fflush(image->fp) == 0 && fsync(fileno(image->fp)) == 0, ESP_FAIL, TAG,
+                        "Failed to sync image at %ld: %s", image->position, strerror(errno));
+    return ESP_OK;
+}
+
+esp_err_t esp_rcp_image_close(esp_rcp_image_t *image)
+{
+    esp_err_t ret = ESP_OK;
+
+    if (image->opened && fclose(image->fp) != 0) {
+        ESP_LOGE(TAG, "Failed to close image: %s", strerror(errno));
+        ret = ESP_FAIL;
+    }
+    memset(image, 0, sizeof(*image));
+    return ret;
+}
+
+#endif
@@ -9,15 +9,25 @@
 #include <esp_log.h>
 #include <esp_partition.h>
 #include <esp_rcp_firmware.h>
+#include <esp_rcp_image_format.h>
+#include <esp_rcp_image_store.h>
 #include <esp_rcp_ota.h>
+#include <esp_rcp_progress.h>
+#include <esp_rcp_stream.h>
 #include <esp_rcp_update.h>
+#include <mbedtls/sha256.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/queue.h>
 
 #define IMAGE_HEADER_MAX_LEN sizeof(esp_rcp_subfile_info_t) * MAX_SUBFILE_INFO
-#define OTA_MAX_WRITE_SIZE 16
+#define OTA_WRITE_BUFFER_SIZE CONFIG_RCP_OTA_WRITE_BUFFER_SIZE
+#define STORAGE_PAGE_SIZE 256
+
+_Static_assert(OTA_WRITE_BUFFER_SIZE % STORAGE_PAGE_SIZE == 0,
+               "The RCP OTA write buffer size shall be a multiple of the storage page size");
 
 typedef struct rcp_ota_entry_ {
     esp_rcp_ota_handle_t handle;
@@ -27,7 +37,24 @@ typedef struct rcp_ota_entry_ {
     uint8_t image_header_buffer[IMAGE_HEADER_MAX_LEN];
     uint32_t rcp_firmware_size;
     uint32_t rcp_firmware_downloaded;
-    FILE *rcp_fp;
+    esp_rcp_image_t rcp_image;
+    int8_t rcp_image_seq;                     /* the update sequence of the slot of rcp_image */
+    uint8_t *write_buffer;                    /* the data not yet written to rcp_image */
+    size_t write_buffer_len;                  /* the length of the data in write_buffer */
+    uint32_t file_offset;                     /* the bytes written to rcp_image */
+    uint32_t subfile_ends[MAX_SUBFILE_INFO];  /* the end offsets of the stored subfiles, in ascending order */
+    uint8_t subfile_end_num;                  /* the number of subfile_ends */
+    uint8_t next_subfile_end;                 /* the index of the next subfile end to reach */
+    uint32_t synced_offset;                   /* the bytes written to rcp_image and synced */
+    bool stream_flash;                        /* whether the RCP is flashed while receiving */
+    esp_rcp_stream_t *stream;                 /* the flashing of the RCP, NULL if not running */
+    esp_err_t stream_result;                  /* the result of flashing the RCP */
+    const esp_rcp_subfile_info_t *image_format_info;      /* the header entry of the image format, NULL for v1 */
+    uint8_t image_format[ESP_RCP_IMAGE_FORMAT_MAX_LEN];   /* the received image format subfile */
+    bool image_format_checked;                            /* whether the image format is received and checked */
+    uint8_t image_id[32];                                 /* the digest of the header and the image format */
+    mbedtls_sha256_context subfile_sha256;                /* the digest of the subfile being received */
+    esp_rcp_progress_tracker_t progress;
     LIST_ENTRY(rcp_ota_entry_) entries;
 } rcp_ota_entry_t;
 
@@ -35,9 +62,18 @@ static LIST_HEAD(rcp_ota_entries_head,
                  rcp_ota_entry_) s_rcp_ota_entries_head = LIST_HEAD_INITIALIZER(s_rcp_ota_entries_head);
 
 static esp_rcp_ota_handle_t s_ota_last_handle = 0;
+static esp_rcp_progress_cb_t s_progress_callback = NULL;
+static void *s_progress_user_ctx = NULL;
 
 const static char *TAG = "esp_rcp_ota";
 
+esp_err_t esp_rcp_ota_register_progress_callback(esp_rcp_progress_cb_t callback, void *user_ctx)
+{
+    s_progress_callback = callback;
+    s_progress_user_ctx = user_ctx;
+    return ESP_OK;
+}
+
 esp_err_t esp_rcp_ota_begin(esp_rcp_ota_handle_t *out_handle)
 {
     rcp_ota_entry_t *new_entry = NULL;
@@ -52,8 +88,10 @@ esp_err_t esp_rcp_ota_begin(esp_rcp_ota_handle_t *out_handle)
     new_entry->header_read = 0;
     new_entry->rcp_firmware_size = 0;
     new_entry->rcp_firmware_downloaded = 0;
-    new_entry->rcp_fp = NULL;
+    memset(&new_entry->rcp_image, 0, sizeof(new_entry->rcp_image));
+    new_entry->stream_result = ESP_ERR_INVALID_STATE;
     memset(new_entry->image_header_buffer, 0, sizeof(new_entry->image_header_buffer));
+    mbedtls_sha256_init(&new_entry->subfile_sha256);
     new_entry->handle = ++s_ota_last_handle;
     *out_handle = new_entry->handle;
     return ESP_OK;
@@ -70,6 +108,40 @@ static rcp_ota_entry_t *find_esp_rcp_ota_entry(esp_rcp_ota_handle_t handle)
     return NULL;
 }
 
+esp_err_t esp_rcp_ota_enable_stream_flash(esp_rcp_ota_handle_t handle)
+{
+    rcp_ota_entry_t *entry = find_esp_rcp_ota_entry(handle);
+    ESP_RETURN_ON_FALSE(entry, ESP_ERR_NOT_FOUND, TAG, "Invalid rcp_ota handle");
+    ESP_RETURN_ON_FALSE(entry->state == ESP_RCP_OTA_STATE_READ_HEADER && entry->header_read == 0,
+                        ESP_ERR_INVALID_STATE, TAG, "RCP OTA data has been received or resumed");
+    entry->stream_flash = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_rcp_ota_get_stream_flash_result(esp_rcp_ota_handle_t handle)
+{
+    rcp_ota_entry_t *entry = find_esp_rcp_ota_entry(handle);
+    ESP_RETURN_ON_FALSE(entry, ESP_ERR_NOT_FOUND, TAG, "Invalid rcp_ota handle");
+    return entry->stream_result;
+}
+
+esp_err_t esp_rcp_ota_get_subfile_sha256(esp_rcp_ota_handle_t handle, esp_rcp_filetag_t tag, uint8_t *sha256)
+{
+    rcp_ota_entry_t *entry = find_esp_rcp_ota_entry(handle);
+    ESP_RETURN_ON_FALSE(entry, ESP_ERR_NOT_FOUND, TAG, "Invalid rcp_ota handle");
+    ESP_RETURN_ON_FALSE(entry->state == ESP_RCP_OTA_STATE_FINISHED, ESP_ERR_INVALID_STATE, TAG,
+                        "RCP image is not received");
+    if (!entry->image_format_checked) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    const esp_rcp_subfile_digest_t *digest = esp_rcp_image_format_find_digest(entry->image_format, tag);
+    if (digest == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    memcpy(sha256, digest->sha256, sizeof(digest->sha256));
+    return ESP_OK;
+}
+
 esp_rcp_ota_state_t esp_rcp_ota_get_state(esp_rcp_ota_handle_t handle)
 {
     rcp_ota_entry_t *entry = find_esp_rcp_ota_entry(handle);
@@ -86,50 +158,220 @@ uint32_t esp_rcp_ota_get_subfile_size(esp_rcp_ota_handle_t handle, esp_rcp_filet
     for (size_t i = 0; i < subfile_info_num; ++i) {
         esp_rcp_subfile_info_t *subfile_info =
             (esp_rcp_subfile_info_t *)(&entry->image_header_buffer[i * sizeof(esp_rcp_subfile_info_t)]);
-        if (subfile_info->tag == tag) {
+        if ((subfile_info->tag & FILETAG_MASK) == tag) {
             return subfile_info->size;
         }
     }
     return 0;
 }
 
-static void parse_image_header(rcp_ota_entry_t *entry)
+static esp_err_t parse_image_header(rcp_ota_entry_t *entry)
 {
     size_t subfile_info_num = entry->header_size / sizeof(esp_rcp_subfile_info_t);
     for (size_t i = 0; i < subfile_info_num; ++i) {
         esp_rcp_subfile_info_t *subfile_info =
             (esp_rcp_subfile_info_t *)(&entry->image_header_buffer[i * sizeof(esp_rcp_subfile_info_t)]);
-        if (subfile_info->tag == FILETAG_IMAGE_HEADER || subfile_info->tag == FILETAG_RCP_VERSION ||
-            subfile_info->tag == FILETAG_RCP_BOOTLOADER || subfile_info->tag == FILETAG_RCP_FLASH_ARGS ||
-            subfile_info->tag == FILETAG_RCP_PARTITION_TABLE || subfile_info->tag == FILETAG_RCP_FIRMWARE) {
+        if (subfile_info->tag == FILETAG_IMAGE_FORMAT) {
+            // The digests are needed before any other subfile arrives.
+            ESP_RETURN_ON_FALSE(subfile_info->offset == entry->header_size &&
+                                    subfile_info->size <= sizeof(entry->image_format),
+                                ESP_ERR_INVALID_ARG, TAG, "Invalid image format entry");
+            entry->image_format_info = subfile_info;
+        }
+        // The compressed flag does not change where the subfile is stored.
+        if (esp_rcp_image_is_stored_subfile(subfile_info->tag)) {
             entry->rcp_firmware_size += subfile_info->size;
+            // Insert the end of the subfile in order, the storage is synchronized whenever one is reached.
+            uint32_t end = subfile_info->offset + subfile_info->size;
+            uint8_t pos = entry->subfile_end_num++;
+            while (pos > 0 && entry->subfile_ends[pos - 1] > end) {
+                entry->subfile_ends[pos] = entry->subfile_ends[pos - 1];
+                pos--;
+            }
+            entry->subfile_ends[pos] = end;
         }
     }
+    return ESP_OK;
 }
 
-static int write_file_for_length(FILE *fp, const void *buf, size_t size)
+static const esp_rcp_subfile_info_t *find_subfile_at(rcp_ota_entry_t *entry, uint32_t offset)
 {
-    static const int k_max_retry = 5;
-    int retry_count = 0;
-    int offset = 0;
-    const uint8_t *data = (const uint8_t *)buf;
-    while (offset < size) {
-        int ret =
-            fwrite(data + offset, 1, ((size - offset) < OTA_MAX_WRITE_SIZE ? (size - offset) : OTA_MAX_WRITE_SIZE), fp);
-        if (ret < 0) {
-            return ret;
+    size_t subfile_info_num = entry->header_size / sizeof(esp_rcp_subfile_info_t);
+    for (size_t i = 0; i < subfile_info_num; ++i) {
+        const esp_rcp_subfile_info_t *subfile_info =
+            (const esp_rcp_subfile_info_t *)(&entry->image_header_buffer[i * sizeof(esp_rcp_subfile_info_t)]);
+        if (offset >= subfile_info->offset && offset - subfile_info->offset < subfile_info->size) {
+            return subfile_info;
         }
-        if (ret == 0) {
-            retry_count++;
-        } else {
-            offset += ret;
-            retry_count = 0;
+    }
+    return NULL;
+}
+
+static void compute_image_id(rcp_ota_entry_t *entry, uint8_t *image_id)
+{
+    mbedtls_sha256_context ctx;
+
+    // The image format follows the header, the ID is the digest of the first bytes of the image.
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_starts(&ctx, 0);
+    mbedtls_sha256_update(&ctx, entry->image_header_buffer, entry->header_size);
+    mbedtls_sha256_update(&ctx, entry->image_format, entry->image_format_info->size);
+    mbedtls_sha256_finish(&ctx, image_id);
+    mbedtls_sha256_free(&ctx);
+}
+
+// Check the data of a v2 image against the digests of the image format before it is stored or flashed. The data
+// never crosses the end of a subfile, see write_subfile_data().
+static esp_err_t verify_subfile_data(rcp_ota_entry_t *entry, uint32_t offset, const uint8_t *data, size_t size)
+{
+    const esp_rcp_subfile_info_t *format_info = entry->image_format_info;
+
+    if (format_info == NULL || offset < entry->header_size) {
+        // The header is checked against the image format once it arrives.
+        return ESP_OK;
+    }
+    if (offset < format_info->offset + format_info->size) {
+        memcpy(entry->image_format + offset - format_info->offset, data, size);
+        if (offset + size == format_info->offset + format_info->size) {
+            ESP_RETURN_ON_ERROR(esp_rcp_image_format_check(entry->image_format, format_info->size,
+                                                           (const esp_rcp_subfile_info_t *)entry->image_header_buffer,
+                                                           entry->header_size / sizeof(esp_rcp_subfile_info_t)),
+                                TAG, "Invalid image format");
+            entry->image_format_checked = true;
+            compute_image_id(entry, entry->image_id);
+        }
+        return ESP_OK;
+    }
+
+    const esp_rcp_subfile_info_t *subfile_info = find_subfile_at(entry, offset);
+    ESP_RETURN_ON_FALSE(subfile_info && entry->image_format_checked, ESP_ERR_INVALID_ARG, TAG,
+                        "Unexpected data at %lu", offset);
+    if (offset == subfile_info->offset) {
+        mbedtls_sha256_starts(&entry->subfile_sha256, 0);
+    }
+    mbedtls_sha256_update(&entry->subfile_sha256, data, size);
+    if (offset + size == subfile_info->offset + subfile_info->size) {
+        uint8_t sha256[32];
+        const esp_rcp_subfile_digest_t *digest = esp_rcp_image_format_find_digest(entry->image_format,
+                                                                                  subfile_info->tag);
+        mbedtls_sha256_finish(&entry->subfile_sha256, sha256);
+        ESP_RETURN_ON_FALSE(memcmp(sha256, digest->sha256, sizeof(sha256)) == 0, ESP_ERR_INVALID_CRC, TAG,
+                            "Subfile %lu does not match its SHA-256 digest", subfile_info->tag & FILETAG_MASK);
+    }
+    return ESP_OK;
+}
+
+static esp_err_t write_storage(rcp_ota_entry_t *entry, const void *data, size_t size)
+{
+    ESP_RETURN_ON_ERROR(esp_rcp_image_write(&entry->rcp_image, entry->file_offset, data, size), TAG,
+                        "Failed to write storage");
+    entry->file_offset += size;
+    return ESP_OK;
+}
+
+static esp_err_t flush_write_buffer(rcp_ota_entry_t *entry, bool sync)
+{
+    if (entry->write_buffer_len > 0) {
+        ESP_RETURN_ON_ERROR(write_storage(entry, entry->write_buffer, entry->write_buffer_len), TAG,
+                            "Failed to flush the write buffer");
+        entry->write_buffer_len = 0;
+    }
+    if (sync) {
+        ESP_RETURN_ON_ERROR(esp_rcp_image_sync(&entry->rcp_image), TAG, "Failed to sync storage");
+    }
+    return ESP_OK;
+}
+
+// Buffer the data so that the storage is written in whole buffers at buffer-aligned offsets, except for the
+// partial buffers flushed at subfile boundaries.
+static esp_err_t buffered_write(rcp_ota_entry_t *entry, const uint8_t *data, size_t size)
+{
+    while (size > 0) {
+        uint32_t buffered_end = entry->file_offset + entry->write_buffer_len;
+        size_t room = OTA_WRITE_BUFFER_SIZE - buffered_end % OTA_WRITE_BUFFER_SIZE;
+
+        if (entry->write_buffer_len == 0 && room == OTA_WRITE_BUFFER_SIZE && size >= OTA_WRITE_BUFFER_SIZE) {
+            size_t direct_size = size - size % OTA_WRITE_BUFFER_SIZE;
+            ESP_RETURN_ON_ERROR(write_storage(entry, data, direct_size), TAG, "Failed to write data");
+            data += direct_size;
+            size -= direct_size;
+            continue;
+        }
+        size_t copy_size = size < room ? size : room;
+        memcpy(entry->write_buffer + entry->write_buffer_len, data, copy_size);
+        entry->write_buffer_len += copy_size;
+        data += copy_size;
+        size -= copy_size;
+        if (copy_size == room) {
+            ESP_RETURN_ON_ERROR(flush_write_buffer(entry, false), TAG, "Failed to write data");
         }
-        if (retry_count > k_max_retry) {
-            return -1;
+    }
+    return ESP_OK;
+}
+
+static void stream_flash_data(rcp_ota_entry_t *entry, uint32_t offset, const uint8_t *data, size_t size)
+{
+    if (entry->stream) {
+        esp_err_t err = esp_rcp_stream_write(entry->stream, offset, data, size);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Stop flashing the RCP while receiving, the stored image shall be flashed instead");
+            esp_rcp_stream_abort(entry->stream);
+            entry->stream = NULL;
+            entry->stream_result = err;
         }
     }
-    return size;
+}
+
+// Write the data to the end of the current subfile at most, and sync the storage if the end is reached.
+static esp_err_t write_subfile_data(rcp_ota_entry_t *entry, const uint8_t *data, size_t size, size_t *written_size)
+{
+    uint32_t offset = entry->file_offset + entry->write_buffer_len;
+
+    while (entry->next_subfile_end < entry->subfile_end_num && entry->subfile_ends[entry->next_subfile_end] <= offset) {
+        entry->next_subfile_end++;
+    }
+    if (entry->next_subfile_end < entry->subfile_end_num &&
+        size > entry->subfile_ends[entry->next_subfile_end] - offset) {
+        size = entry->subfile_ends[entry->next_subfile_end] - offset;
+    }
+    ESP_RETURN_ON_ERROR(verify_subfile_data(entry, offset, data, size), TAG, "Failed to verify data");
+    ESP_RETURN_ON_ERROR(buffered_write(entry, data, size), TAG, "Failed to write data");
+    stream_flash_data(entry, offset, data, size);
+    if (entry->next_subfile_end < entry->subfile_end_num &&
+        offset + size == entry->subfile_ends[entry->next_subfile_end]) {
+        ESP_RETURN_ON_ERROR(flush_write_buffer(entry, true), TAG, "Failed to write data");
+        entry->synced_offset = entry->file_offset;
+        entry->next_subfile_end++;
+    }
+    *written_size = size;
+    return ESP_OK;
+}
+
+static esp_err_t close_rcp_image(rcp_ota_entry_t *entry)
+{
+    esp_err_t ret = esp_rcp_image_close(&entry->rcp_image);
+    if (entry->stream) {
+        esp_rcp_stream_abort(entry->stream);
+        entry->stream = NULL;
+    }
+    free(entry->write_buffer);
+    entry->write_buffer = NULL;
+    entry->write_buffer_len = 0;
+    return ret;
+}
+
+static esp_err_t finish_rcp_fw(rcp_ota_entry_t *entry)
+{
+    ESP_RETURN_ON_ERROR(flush_write_buffer(entry, true), TAG, "Failed to write data");
+    entry->synced_offset = entry->file_offset;
+    if (entry->stream) {
+        entry->stream_result = esp_rcp_stream_end(entry->stream);
+        entry->stream = NULL;
+    }
+    ESP_RETURN_ON_ERROR(close_rcp_image(entry), TAG, "Failed to write data");
+    entry->state = ESP_RCP_OTA_STATE_FINISHED;
+    esp_rcp_progress_end(&entry->progress, true);
+    return ESP_OK;
 }
 
 static esp_err_t receive_header(const uint8_t *data, size_t size, rcp_ota_entry_t *entry, size_t *consumed_size)
@@ -148,7 +390,7 @@ static esp_err_t receive_header(const uint8_t *data, size_t size, rcp_ota_entry_
         if (entry->header_read >= sizeof(esp_rcp_subfile_info_t)) {
             esp_rcp_subfile_info_t *subfile_info = (esp_rcp_subfile_info_t *)(entry->image_header_buffer);
             if (subfile_info->tag != FILETAG_IMAGE_HEADER || subfile_info->offset != 0 ||
-                subfile_info->size % sizeof(esp_rcp_subfile_info_t) != 0) {
+                subfile_info->size % sizeof(esp_rcp_subfile_info_t) != 0 || subfile_info->size > IMAGE_HEADER_MAX_LEN) {
                 ESP_LOGE(TAG, "Invalid image header");
                 return ESP_ERR_INVALID_ARG;
             } else {
@@ -167,9 +409,11 @@ static esp_err_t receive_header(const uint8_t *data, size_t size, rcp_ota_entry_
         *consumed_size += copy_size;
     }
     if (entry->header_size > 0 && entry->header_read >= entry->header_size) {
-        parse_image_header(entry);
+        ESP_RETURN_ON_ERROR(parse_image_header(entry), TAG, "Invalid image header");
         if (entry->rcp_firmware_size > 0) {
             entry->state = ESP_RCP_OTA_STATE_DOWNLOAD_RCP_FW;
+            esp_rcp_progress_begin(&entry->progress, ESP_RCP_PROGRESS_PHASE_RCP_DOWNLOAD, entry->rcp_firmware_size,
+                                   s_progress_callback, s_progress_user_ctx);
         } else {
             entry->state = ESP_RCP_OTA_STATE_FINISHED;
         }
@@ -182,44 +426,40 @@ static esp_err_t receive_rcp_fw(const uint8_t *data, size_t size, rcp_ota_entry_
     if (entry->rcp_firmware_size == 0 || entry->rcp_firmware_size <= entry->rcp_firmware_downloaded) {
         return ESP_ERR_INVALID_STATE;
     }
-    if (!entry->rcp_fp) {
-        const char *rcp_firmware_dir = esp_rcp_get_firmware_dir();
-        int8_t rcp_update_seq = esp_rcp_get_next_update_seq();
-        char rcp_target_path[RCP_FILENAME_MAX_SIZE];
-        sprintf(rcp_target_path, "%s_%d/" ESP_RCP_IMAGE_FILENAME, rcp_firmware_dir, rcp_update_seq);
-        entry->rcp_fp = fopen(rcp_target_path, "w");
-        if (!entry->rcp_fp) {
-            ESP_LOGE(TAG, "Fail to open %s, will delete it and create a new one", rcp_target_path);
-            remove(rcp_target_path);
-            entry->rcp_fp = fopen(rcp_target_path, "w");
+    if (!entry->rcp_image.opened) {
+        entry->rcp_image_seq = esp_rcp_get_next_update_seq();
+        ESP_RETURN_ON_ERROR(esp_rcp_image_create(entry->rcp_image_seq, &entry->rcp_image), TAG,
+                            "Failed to create the rcp image");
+        entry->write_buffer = malloc(OTA_WRITE_BUFFER_SIZE);
+        ESP_RETURN_ON_FALSE(entry->write_buffer, ESP_ERR_NO_MEM, TAG, "Failed to allocate the write buffer");
+        if (entry->stream_flash) {
+            esp_err_t err = esp_rcp_stream_begin(entry->image_header_buffer, entry->header_size, &entry->stream);
+            if (err != ESP_OK) {
+                ESP_LOGW(TAG, "Failed to start flashing the RCP while receiving: %s", esp_err_to_name(err));
+                entry->stream_result = err;
+            }
         }
-        ESP_RETURN_ON_FALSE(entry->rcp_fp, ESP_FAIL, TAG, "Fail to open %s", rcp_target_path);
         ESP_LOGI(TAG, "Start downloading the rcp firmware");
     }
-    if (entry->rcp_firmware_downloaded == 0) {
-        ESP_RETURN_ON_FALSE(write_file_for_length(entry->rcp_fp, entry->image_header_buffer, entry->header_size) ==
-                                entry->header_size,
-                            ESP_FAIL, TAG, "Failed to write data");
-        entry->rcp_firmware_downloaded += entry->header_size;
-        ESP_LOGD(TAG, "RCP firmware download %ld/%ld", entry->rcp_firmware_downloaded, entry->rcp_firmware_size);
+    while (entry->rcp_firmware_downloaded < entry->header_size) {
+        size_t written_size = 0;
+        ESP_RETURN_ON_ERROR(write_subfile_data(entry, entry->image_header_buffer + entry->rcp_firmware_downloaded,
+                                               entry->header_size - entry->rcp_firmware_downloaded, &written_size),
+                            TAG, "Failed to write the image header");
+        entry->rcp_firmware_downloaded += written_size;
     }
     if (entry->rcp_firmware_downloaded < entry->rcp_firmware_size &&
         entry->rcp_firmware_downloaded >= entry->header_size) {
         size_t copy_size = size > entry->rcp_firmware_size - entry->rcp_firmware_downloaded
             ? entry->rcp_firmware_size - entry->rcp_firmware_downloaded
             : size;
-        ESP_RETURN_ON_FALSE(write_file_for_length(entry->rcp_fp, data, copy_size) == copy_size, ESP_FAIL, TAG,
-                            "Failed to write data");
+        ESP_RETURN_ON_ERROR(write_subfile_data(entry, data, copy_size, &copy_size), TAG, "Failed to write data");
         entry->rcp_firmware_downloaded += copy_size;
         *consumed_size += copy_size;
-        ESP_LOGD(TAG, "RCP firmware download %ld/%ld", entry->rcp_firmware_downloaded, entry->rcp_firmware_size);
+        esp_rcp_progress_update(&entry->progress, entry->rcp_firmware_downloaded);
     }
     if (entry->rcp_firmware_downloaded >= entry->rcp_firmware_size) {
-        if (entry->rcp_fp != NULL) {
-            fclose(entry->rcp_fp);
-            entry->rcp_fp = NULL;
-        }
-        entry->state = ESP_RCP_OTA_STATE_FINISHED;
+        ESP_RETURN_ON_ERROR(finish_rcp_fw(entry), TAG, "Failed to write data");
     }
     return ESP_OK;
 }
@@ -269,22 +509,147 @@ esp_err_t esp_rcp_ota_end(esp_rcp_ota_handle_t handle)
     // TODO: esp_rcp_submit_new_image() is not a thread-safe function, we need to make it thread-safe.
     ESP_GOTO_ON_ERROR(esp_rcp_submit_new_image(), cleanup, TAG, "Failed to submit RCP image");
 cleanup:
-    if (entry->rcp_fp != NULL) {
-        fclose(entry->rcp_fp);
-    }
+    close_rcp_image(entry);
+    esp_rcp_progress_end(&entry->progress, false);
+    mbedtls_sha256_free(&entry->subfile_sha256);
     LIST_REMOVE(entry, entries);
     free(entry);
     return ret;
 }
 
-esp_err_t esp_rcp_ota_abort(esp_rcp_ota_handle_t handle)
+esp_err_t esp_rcp_ota_get_checkpoint(esp_rcp_ota_handle_t handle, esp_rcp_ota_checkpoint_t *checkpoint)
 {
     rcp_ota_entry_t *entry = find_esp_rcp_ota_entry(handle);
     ESP_RETURN_ON_FALSE(entry, ESP_ERR_NOT_FOUND, TAG, "Invalid rcp_ota handle");
+    ESP_RETURN_ON_FALSE(checkpoint, ESP_ERR_INVALID_ARG, TAG, "checkpoint cannot be NULL");
+    uint32_t prefix_size = entry->header_size;
+    if (entry->image_format_info) {
+        prefix_size = entry->image_format_info->offset + entry->image_format_info->size;
+    }
+    if (!entry->image_format_checked || entry->synced_offset < prefix_size) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    memcpy(checkpoint->image_id, entry->image_id, sizeof(checkpoint->image_id));
+    checkpoint->prefix_size = prefix_size;
+    checkpoint->offset = entry->synced_offset;
+    checkpoint->seq = entry->rcp_image_seq;
+    return ESP_OK;
+}
 
-    if (entry->rcp_fp != NULL) {
-        fclose(entry->rcp_fp);
+static bool is_subfile_end(rcp_ota_entry_t *entry, uint32_t offset)
+{
+    for (uint8_t i = 0; i < entry->subfile_end_num; i++) {
+        if (entry->subfile_ends[i] == offset) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Load the header and image format of the image stored in the slot of the checkpoint into the entry.
+static esp_err_t load_stored_image(rcp_ota_entry_t *entry, const esp_rcp_ota_checkpoint_t *checkpoint)
+{
+    esp_err_t ret = ESP_OK;
+    esp_rcp_image_t image;
+    uint8_t image_id[sizeof(entry->image_id)];
+
+    ESP_RETURN_ON_ERROR(esp_rcp_image_open(checkpoint->seq, &image), TAG, "Failed to open the stored image");
+    entry->header_size = image.index->subfile_num * sizeof(esp_rcp_subfile_info_t);
+    memcpy(entry->image_header_buffer, image.index->subfiles, entry->header_size);
+    entry->header_read = entry->header_size;
+    ESP_GOTO_ON_ERROR(parse_image_header(entry), exit, TAG, "Invalid stored image header");
+    ESP_GOTO_ON_FALSE(entry->image_format_info, ESP_ERR_INVALID_CRC, exit, TAG, "Stored image has no image format");
+    ESP_GOTO_ON_ERROR(esp_rcp_image_read(&image, entry->image_format_info->offset, entry->image_format,
+                                         entry->image_format_info->size),
+                      exit, TAG, "Failed to read the stored image format");
+    ESP_GOTO_ON_FALSE(esp_rcp_image_format_check(entry->image_format, entry->image_format_info->size,
+                                                 image.index->subfiles, image.index->subfile_num) == ESP_OK,
+                      ESP_ERR_INVALID_CRC, exit, TAG, "Invalid stored image format");
+    compute_image_id(entry, image_id);
+    ESP_GOTO_ON_FALSE(memcmp(image_id, checkpoint->image_id, sizeof(image_id)) == 0 &&
+                          checkpoint->prefix_size ==
+                              entry->image_format_info->offset + entry->image_format_info->size,
+                      ESP_ERR_INVALID_CRC, exit, TAG, "Stored image does not match the checkpoint");
+    ESP_GOTO_ON_FALSE(checkpoint->offset >= checkpoint->prefix_size && checkpoint->offset <= entry->rcp_firmware_size &&
+                          is_subfile_end(entry, checkpoint->offset),
+                      ESP_ERR_INVALID_ARG, exit, TAG, "Invalid checkpoint offset %lu", checkpoint->offset);
+    memcpy(entry->image_id, image_id, sizeof(image_id));
+    entry->image_format_checked = true;
+exit:
+    esp_rcp_image_close(&image);
+    return ret;
+}
+
+// Feed the stored part of the subfile at the offset into its digest, the rest of the subfile is received again.
+static esp_err_t resume_subfile_digest(rcp_ota_entry_t *entry, uint32_t offset)
+{
+    const esp_rcp_subfile_info_t *subfile_info = find_subfile_at(entry, offset);
+
+    if (subfile_info == NULL || offset == subfile_info->offset) {
+        return ESP_OK;
+    }
+    mbedtls_sha256_starts(&entry->subfile_sha256, 0);
+    for (uint32_t pos = subfile_info->offset; pos < offset;) {
+        size_t size = offset - pos < OTA_WRITE_BUFFER_SIZE ? offset - pos : OTA_WRITE_BUFFER_SIZE;
+        ESP_RETURN_ON_ERROR(esp_rcp_image_read(&entry->rcp_image, pos, entry->write_buffer, size), TAG,
+                            "Failed to read the stored subfile at %lu", pos);
+        mbedtls_sha256_update(&entry->subfile_sha256, entry->write_buffer, size);
+        pos += size;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_rcp_ota_resume(esp_rcp_ota_handle_t handle, const esp_rcp_ota_checkpoint_t *checkpoint,
+                             uint32_t *offset)
+{
+    uint32_t resume_offset;
+
+    rcp_ota_entry_t *entry = find_esp_rcp_ota_entry(handle);
+    ESP_RETURN_ON_FALSE(entry, ESP_ERR_NOT_FOUND, TAG, "Invalid rcp_ota handle");
+    ESP_RETURN_ON_FALSE(checkpoint && offset, ESP_ERR_INVALID_ARG, TAG, "checkpoint and offset cannot be NULL");
+    ESP_RETURN_ON_FALSE(entry->state == ESP_RCP_OTA_STATE_READ_HEADER && entry->header_read == 0 &&
+                            !entry->stream_flash,
+                        ESP_ERR_INVALID_STATE, TAG, "RCP OTA data has been received");
+    ESP_RETURN_ON_FALSE(checkpoint->seq == esp_rcp_get_next_update_seq(), ESP_ERR_INVALID_STATE, TAG,
+                        "Slot %d is no longer the slot to update", checkpoint->seq);
+
+    ESP_RETURN_ON_ERROR(load_stored_image(entry, checkpoint), TAG, "Failed to load the stored image");
+    entry->rcp_image_seq = checkpoint->seq;
+    resume_offset = checkpoint->offset;
+    ESP_RETURN_ON_ERROR(esp_rcp_image_resume(entry->rcp_image_seq, &resume_offset, &entry->rcp_image), TAG,
+                        "Failed to reopen the rcp image");
+    if (checkpoint->offset >= entry->rcp_firmware_size) {
+        // The image is complete, nothing is written to the slot again.
+        resume_offset = checkpoint->offset;
+    }
+    ESP_RETURN_ON_FALSE(resume_offset >= checkpoint->prefix_size, ESP_ERR_INVALID_SIZE, TAG,
+                        "No stored data to resume from");
+    entry->write_buffer = malloc(OTA_WRITE_BUFFER_SIZE);
+    ESP_RETURN_ON_FALSE(entry->write_buffer, ESP_ERR_NO_MEM, TAG, "Failed to allocate the write buffer");
+    ESP_RETURN_ON_ERROR(resume_subfile_digest(entry, resume_offset), TAG, "Failed to resume the subfile digest");
+    entry->file_offset = resume_offset;
+    entry->synced_offset = checkpoint->offset;
+    entry->rcp_firmware_downloaded = resume_offset;
+    *offset = resume_offset;
+    ESP_LOGI(TAG, "Resume downloading the rcp firmware at %lu/%lu", resume_offset, entry->rcp_firmware_size);
+    esp_rcp_progress_begin(&entry->progress, ESP_RCP_PROGRESS_PHASE_RCP_DOWNLOAD, entry->rcp_firmware_size,
+                           s_progress_callback, s_progress_user_ctx);
+    esp_rcp_progress_update(&entry->progress, entry->rcp_firmware_downloaded);
+    entry->state = ESP_RCP_OTA_STATE_DOWNLOAD_RCP_FW;
+    if (entry->rcp_firmware_downloaded >= entry->rcp_firmware_size) {
+        ESP_RETURN_ON_ERROR(finish_rcp_fw(entry), TAG, "Failed to write data");
     }
+    return ESP_OK;
+}
+
+esp_err_t esp_rcp_ota_abort(esp_rcp_ota_handle_t handle)
+{
+    rcp_ota_entry_t *entry = find_esp_rcp_ota_entry(handle);
+    ESP_RETURN_ON_FALSE(entry, ESP_ERR_NOT_FOUND, TAG, "Invalid rcp_ota handle");
+
+    close_rcp_image(entry);
+    esp_rcp_progress_end(&entry->progress, false);
+    mbedtls_sha256_free(&entry->subfile_sha256);
     LIST_REMOVE(entry, entries);
     free(entry);
     return ESP_OK;
@@ -0,0 +1,111 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "esp_rcp_progress.h"
+
+#include <string.h>
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "sdkconfig.h"
+
+static esp_rcp_progress_t s_latest_progress = {.phase = ESP_RCP_PROGRESS_PHASE_IDLE};
+static portMUX_TYPE s_latest_progress_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void report_progress(esp_rcp_progress_tracker_t *tracker, int64_t now_us)
+{
+    esp_rcp_progress_t *progress = &tracker->progress;
+    int64_t elapsed_us = now_us - tracker->start_us;
+
+    progress->elapsed_ms = elapsed_us / 1000;
+    progress->bytes_per_sec = elapsed_us > 0 ? (uint64_t)progress->bytes_done * 1000000 / elapsed_us : 0;
+    if (progress->state != ESP_RCP_PROGRESS_STATE_RUNNING) {
+        progress->eta_ms = 0;
+    } else if (progress->bytes_per_sec == 0 || progress->bytes_done > progress->bytes_total) {
+        progress->eta_ms = ESP_RCP_PROGRESS_ETA_UNKNOWN;
+    } else {
+        progress->eta_ms = (uint64_t)(progress->bytes_total - progress->bytes_done) * 1000 / progress->bytes_per_sec;
+    }
+    tracker->last_report_us = now_us;
+
+    portENTER_CRITICAL(&s_latest_progress_lock);
+    s_latest_progress = *progress;
+    portEXIT_CRITICAL(&s_latest_progress_lock);
+    if (tracker->callback) {
+        tracker->callback(progress, tracker->user_ctx);
+    }
+}
+
+void esp_rcp_progress_begin(esp_rcp_progress_tracker_t *tracker, esp_rcp_progress_phase_t phase, uint32_t bytes_total,
+                            esp_rcp_progress_cb_t callback, void *user_ctx)
+{
+    memset(tracker, 0, sizeof(*tracker));
+    tracker->progress.phase = phase;
+    tracker->progress.state = ESP_RCP_PROGRESS_STATE_RUNNING;
+    tracker->progress.bytes_total = bytes_total;
+    tracker->callback = callback;
+    tracker->user_ctx = user_ctx;
+    tracker->start_us = esp_timer_get_time();
+    report_progress(tracker, tracker->start_us);
+}
+
+void esp_rcp_progress_update(esp_rcp_progress_tracker_t *tracker, uint32_t bytes_done)
+{
+    int64_t now_us = esp_timer_get_time();
+
+    tracker->progress.bytes_done = bytes_done;
+    if (now_us - tracker->last_report_us >= CONFIG_RCP_PROGRESS_INTERVAL_MS * 1000LL) {
+        report_progress(tracker, now_us);
+    }
+}
+
+void esp_rcp_progress_end(esp_rcp_progress_tracker_t *tracker, bool success)
+{
+    // Nothing to report if the phase has not begun or has already ended.
+    if (tracker->progress.phase == ESP_RCP_PROGRESS_PHASE_IDLE ||
+        tracker->progress.state != ESP_RCP_PROGRESS_STATE_RUNNING) {
+        return;
+    }
+    tracker->progress.state = success ? ESP_RCP_PROGRESS_STATE_SUCCEEDED : ESP_RCP_PROGRESS_STATE_FAILED;
+    report_progress(tracker, esp_timer_get_time());
+}
+
+void esp_rcp_progress_get_latest(esp_rcp_progress_t *progress)
+{
+    portENTER_CRITICAL(&s_latest_progress_lock);
+    *progress = s_latest_progress;
+    portEXIT_CRITICAL(&s_latest_progress_lock);
+}
+
+const char *esp_rcp_progress_phase_to_str(esp_rcp_progress_phase_t phase)
+{
+    switch (phase) {
+    case ESP_RCP_PROGRESS_PHASE_IDLE:
+        return "idle";
+    case ESP_RCP_PROGRESS_PHASE_RCP_DOWNLOAD:
+        return "rcp_download";
+    case ESP_RCP_PROGRESS_PHASE_HOST_DOWNLOAD:
+        return "host_download";
+    case ESP_RCP_PROGRESS_PHASE_RCP_FLASH:
+        return "rcp_flash";
+    default:
+        return "unknown";
+    }
+}
+
+const char *esp_rcp_progress_state_to_str(esp_rcp_progress_state_t state)
+{
+    switch (state) {
+    case ESP_RCP_PROGRESS_STATE_RUNNING:
+        return "running";
+    case ESP_RCP_PROGRESS_STATE_SUCCEEDED:
+        return "succeeded";
+    case ESP_RCP_PROGRESS_STATE_FAILED:
+        return "failed";
+    default:
+        return "unknown";
+    }
+}
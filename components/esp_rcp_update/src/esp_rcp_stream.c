@@ -0,0 +1,352 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "esp_rcp_stream.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_check.h"
+#include "esp_err.h"
+#include "esp_loader.h"
+#include "esp_log.h"
+#include "esp_rcp_firmware.h"
+#include "esp_rcp_loader.h"
+#include "sdkconfig.h"
+
+#define TAG "RCP_STREAM"
+#define STREAM_MAX_FLASH_ARGS 4
+#define STREAM_MAX_DIGESTS_SIZE 4096
+#define REGION_MD5_SIZE 16
+
+typedef esp_loader_error_t (*stream_write_fn_t)(void *payload, uint32_t size);
+
+struct esp_rcp_stream {
+    esp_rcp_subfile_info_t subfiles[MAX_SUBFILE_INFO];
+    uint8_t subfile_num;
+    esp_rcp_flash_arg_t flash_args[STREAM_MAX_FLASH_ARGS];
+    uint8_t flash_arg_num;
+    uint32_t flash_args_received;
+    uint32_t flashed_tags;                     /* a bit for each flashed and verified tag */
+    const esp_rcp_subfile_info_t *binary;      /* the subfile being flashed */
+    uint32_t binary_received;                  /* the bytes of binary received */
+    uint32_t address;                          /* the flash address of binary */
+    bool skip_binary;                          /* binary is not listed in the flash args */
+    esp_rcp_compressed_info_t compressed_info; /* the info of binary if it is compressed */
+    stream_write_fn_t write_fn;                /* NULL until the flashing of binary starts */
+    uint8_t *block;                            /* the block sent to the loader */
+    size_t block_len;
+    uint8_t *digests;                          /* the region digests subfile, NULL if absent */
+    bool digests_verified;
+};
+
+static bool is_flashed_tag(uint32_t tag)
+{
+    return tag == FILETAG_RCP_BOOTLOADER || tag == FILETAG_RCP_PARTITION_TABLE || tag == FILETAG_RCP_FIRMWARE;
+}
+
+static void free_stream(esp_rcp_stream_t *stream)
+{
+    if (stream) {
+        free(stream->block);
+        free(stream->digests);
+        free(stream);
+    }
+}
+
+static esp_err_t find_flash_address(esp_rcp_stream_t *stream, uint32_t tag, uint32_t *address)
+{
+    ESP_RETURN_ON_FALSE(stream->flash_args_received == stream->flash_arg_num * sizeof(esp_rcp_flash_arg_t),
+                        ESP_ERR_INVALID_STATE, TAG, "The flash args are not received");
+    for (uint8_t i = 0; i < stream->flash_arg_num; i++) {
+        if (stream->flash_args[i].tag == tag) {
+            *address = stream->flash_args[i].offset;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t esp_rcp_stream_begin(const uint8_t *image_header, size_t header_size, esp_rcp_stream_t **out_stream)
+{
+    esp_err_t ret = ESP_OK;
+    esp_rcp_stream_t *stream = NULL;
+    const esp_rcp_subfile_info_t *flash_args = NULL;
+    const esp_rcp_subfile_info_t *digests = NULL;
+
+    ESP_RETURN_ON_FALSE(header_size % sizeof(esp_rcp_subfile_info_t) == 0 &&
+                            header_size <= MAX_SUBFILE_INFO * sizeof(esp_rcp_subfile_info_t),
+                        ESP_ERR_INVALID_ARG, TAG, "Invalid image header");
+    stream = calloc(1, sizeof(esp_rcp_stream_t));
+    ESP_RETURN_ON_FALSE(stream, ESP_ERR_NO_MEM, TAG, "Failed to allocate the stream");
+    memcpy(stream->subfiles, image_header, header_size);
+    stream->subfile_num = header_size / sizeof(esp_rcp_subfile_info_t);
+    for (uint8_t i = 1; i < stream->subfile_num; i++) {
+        uint32_t tag = stream->subfiles[i].tag & FILETAG_MASK;
+        if (tag == FILETAG_RCP_FLASH_ARGS) {
+            flash_args = &stream->subfiles[i];
+        } else if (tag == FILETAG_RCP_REGION_DIGESTS) {
+            digests = &stream->subfiles[i];
+        }
+    }
+    ESP_GOTO_ON_FALSE(flash_args && flash_args->size % sizeof(esp_rcp_flash_arg_t) == 0 &&
+                          flash_args->size <= sizeof(stream->flash_args),
+                      ESP_ERR_NOT_SUPPORTED, exit, TAG, "Invalid flash args");
+    // The flash addresses shall arrive before the flashed subfiles, and the region digests after them.
+    for (uint8_t i = 1; i < stream->subfile_num; i++) {
+        const esp_rcp_subfile_info_t *subfile = &stream->subfiles[i];
+        if (is_flashed_tag(subfile->tag & FILETAG_MASK)) {
+            ESP_GOTO_ON_FALSE(subfile->offset >= flash_args->offset + flash_args->size &&
+                                  (!digests || digests->offset >= subfile->offset + subfile->size),
+                              ESP_ERR_NOT_SUPPORTED, exit, TAG, "The image layout cannot be streamed");
+        }
+    }
+    stream->flash_arg_num = flash_args->size / sizeof(esp_rcp_flash_arg_t);
+    if (digests) {
+        ESP_GOTO_ON_FALSE(digests->size <= STREAM_MAX_DIGESTS_SIZE, ESP_ERR_NOT_SUPPORTED, exit, TAG,
+                          "The region digests are too large");
+        stream->digests = malloc(digests->size + 1);
+        ESP_GOTO_ON_FALSE(stream->digests, ESP_ERR_NO_MEM, exit, TAG, "Failed to allocate the region digests");
+    }
+    stream->block = malloc(CONFIG_RCP_FLASH_BLOCK_SIZE);
+    ESP_GOTO_ON_FALSE(stream->block, ESP_ERR_NO_MEM, exit, TAG, "Failed to allocate the flash block");
+    ESP_GOTO_ON_ERROR(esp_rcp_loader_connect(), exit, TAG, "Failed to connect to the RCP loader");
+    *out_stream = stream;
+
+exit:
+    if (ret != ESP_OK) {
+        free_stream(stream);
+    }
+    return ret;
+}
+
+static esp_err_t send_block(esp_rcp_stream_t *stream)
+{
+    esp_loader_error_t err = stream->write_fn(stream->block, stream->block_len);
+
+    ESP_RETURN_ON_FALSE(err == ESP_LOADER_SUCCESS, ESP_FAIL, TAG, "Failed to write subfile %lu: %d",
+                        stream->binary->tag & FILETAG_MASK, err);
+    stream->block_len = 0;
+    return ESP_OK;
+}
+
+static esp_err_t start_binary(esp_rcp_stream_t *stream)
+{
+    const esp_rcp_subfile_info_t *subfile = stream->binary;
+    esp_loader_error_t err;
+
+    if (subfile->tag & FILETAG_FLAG_COMPRESSED) {
+        err = esp_loader_flash_deflate_start(stream->address, stream->compressed_info.raw_size,
+                                             subfile->size - sizeof(esp_rcp_compressed_info_t),
+                                             CONFIG_RCP_FLASH_BLOCK_SIZE);
+        stream->write_fn = esp_loader_flash_deflate_write;
+    } else {
+        err = esp_loader_flash_start(stream->address, subfile->size, CONFIG_RCP_FLASH_BLOCK_SIZE);
+        stream->write_fn = esp_loader_flash_write;
+    }
+    ESP_RETURN_ON_FALSE(err == ESP_LOADER_SUCCESS, ESP_FAIL, TAG, "Failed to start flashing subfile %lu: %d",
+                        subfile->tag & FILETAG_MASK, err);
+    return ESP_OK;
+}
+
+static esp_err_t finish_binary(esp_rcp_stream_t *stream)
+{
+    const esp_rcp_subfile_info_t *subfile = stream->binary;
+    uint32_t tag = subfile->tag & FILETAG_MASK;
+    esp_loader_error_t err;
+
+    if (stream->block_len > 0) {
+        ESP_RETURN_ON_ERROR(send_block(stream), TAG, "Failed to finish subfile %lu", tag);
+    }
+    // The loader checks the MD5 of the data it was sent, a compressed subfile is checked against the MD5 of the raw
+    // binary instead.
+    if (subfile->tag & FILETAG_FLAG_COMPRESSED) {
+        err = esp_loader_flash_verify_known_md5(stream->address, stream->compressed_info.raw_size,
+                                                stream->compressed_info.md5);
+    } else {
+        err = esp_loader_flash_verify();
+    }
+    ESP_RETURN_ON_FALSE(err == ESP_LOADER_SUCCESS, ESP_ERR_INVALID_CRC, TAG, "MD5 of subfile %lu does not match: %d",
+                        tag, err);
+    stream->flashed_tags |= 1UL << tag;
+    ESP_LOGI(TAG, "Flashed subfile %lu at 0x%lx", tag, stream->address);
+    return ESP_OK;
+}
+
+static esp_err_t write_binary(esp_rcp_stream_t *stream, const esp_rcp_subfile_info_t *subfile, uint32_t pos,
+                              const uint8_t *data, size_t len)
+{
+    bool compressed = subfile->tag & FILETAG_FLAG_COMPRESSED;
+
+    if (pos == 0) {
+        ESP_RETURN_ON_FALSE(stream->binary == NULL, ESP_ERR_INVALID_STATE, TAG, "Subfile %lu is not complete",
+                            stream->binary ? stream->binary->tag & FILETAG_MASK : 0);
+        ESP_RETURN_ON_FALSE(!compressed || subfile->size >= sizeof(esp_rcp_compressed_info_t), ESP_ERR_INVALID_STATE,
+                            TAG, "Invalid compressed subfile");
+        esp_err_t err = find_flash_address(stream, subfile->tag & FILETAG_MASK, &stream->address);
+        ESP_RETURN_ON_FALSE(err == ESP_OK || err == ESP_ERR_NOT_FOUND, err, TAG, "Failed to find the flash address");
+        stream->binary = subfile;
+        stream->binary_received = 0;
+        stream->skip_binary = err == ESP_ERR_NOT_FOUND;
+        stream->write_fn = NULL;
+        stream->block_len = 0;
+    }
+    ESP_RETURN_ON_FALSE(stream->binary == subfile && pos == stream->binary_received, ESP_ERR_INVALID_STATE, TAG,
+                        "Out of order data of subfile %lu", subfile->tag & FILETAG_MASK);
+    stream->binary_received += len;
+    if (!stream->skip_binary) {
+        if (compressed && pos < sizeof(esp_rcp_compressed_info_t)) {
+            size_t info_len = sizeof(esp_rcp_compressed_info_t) - pos;
+            info_len = len < info_len ? len : info_len;
+            memcpy((uint8_t *)&stream->compressed_info + pos, data, info_len);
+            pos += info_len;
+            data += info_len;
+            len -= info_len;
+        }
+        if (!stream->write_fn && (!compressed || pos == sizeof(esp_rcp_compressed_info_t))) {
+            ESP_RETURN_ON_ERROR(start_binary(stream), TAG, "Failed to write subfile");
+        }
+        while (len > 0) {
+            size_t copy_len = CONFIG_RCP_FLASH_BLOCK_SIZE - stream->block_len;
+            copy_len = len < copy_len ? len : copy_len;
+            memcpy(stream->block + stream->block_len, data, copy_len);
+            stream->block_len += copy_len;
+            data += copy_len;
+            len -= copy_len;
+            if (stream->block_len == CONFIG_RCP_FLASH_BLOCK_SIZE) {
+                ESP_RETURN_ON_ERROR(send_block(stream), TAG, "Failed to write subfile");
+            }
+        }
+        if (stream->binary_received == subfile->size) {
+            ESP_RETURN_ON_ERROR(finish_binary(stream), TAG, "Failed to write subfile");
+        }
+    }
+    if (stream->binary_received == subfile->size) {
+        stream->binary = NULL;
+    }
+    return ESP_OK;
+}
+
+// Check every region of the flashed subfiles against the digests shipped in the image.
+static esp_err_t verify_region_digests(esp_rcp_stream_t *stream, uint32_t size)
+{
+    esp_rcp_region_digests_t header;
+    esp_rcp_region_digests_entry_t entry;
+    uint32_t pos = sizeof(header);
+
+    ESP_RETURN_ON_FALSE(size >= sizeof(header), ESP_ERR_INVALID_SIZE, TAG, "Invalid region digests");
+    memcpy(&header, stream->digests, sizeof(header));
+    ESP_RETURN_ON_FALSE(header.region_size > 0, ESP_ERR_INVALID_SIZE, TAG, "Invalid region digests");
+    for (uint32_t i = 0; i < header.entry_count; i++) {
+        ESP_RETURN_ON_FALSE(size - pos >= sizeof(entry), ESP_ERR_INVALID_SIZE, TAG, "Invalid region digests");
+        memcpy(&entry, stream->digests + pos, sizeof(entry));
+        pos += sizeof(entry);
+        uint32_t region_count = (entry.raw_size + header.region_size - 1) / header.region_size;
+        ESP_RETURN_ON_FALSE((size - pos) / REGION_MD5_SIZE >= region_count, ESP_ERR_INVALID_SIZE, TAG,
+                            "Invalid region digests");
+        uint32_t address;
+        if (find_flash_address(stream, entry.tag, &address) == ESP_OK) {
+            for (uint32_t region = 0; region < region_count; region++) {
+                uint32_t region_start = region * header.region_size;
+                uint32_t region_size = entry.raw_size - region_start < header.region_size
+                    ? entry.raw_size - region_start
+                    : header.region_size;
+                esp_loader_error_t err = esp_loader_flash_verify_known_md5(
+                    address + region_start, region_size, stream->digests + pos + region * REGION_MD5_SIZE);
+                ESP_RETURN_ON_FALSE(err == ESP_LOADER_SUCCESS, ESP_ERR_INVALID_CRC, TAG,
+                                    "Region %lu of subfile %lu does not match its digest", region, entry.tag);
+            }
+        }
+        pos += region_count * REGION_MD5_SIZE;
+    }
+    stream->digests_verified = true;
+    ESP_LOGI(TAG, "Flashed regions verified");
+    return ESP_OK;
+}
+
+static esp_err_t write_subfile(esp_rcp_stream_t *stream, const esp_rcp_subfile_info_t *subfile, uint32_t pos,
+                               const uint8_t *data, size_t len)
+{
+    uint32_t tag = subfile->tag & FILETAG_MASK;
+
+    if (tag == FILETAG_RCP_FLASH_ARGS) {
+        ESP_RETURN_ON_FALSE(pos == stream->flash_args_received, ESP_ERR_INVALID_STATE, TAG,
+                            "Out of order data of the flash args");
+        memcpy((uint8_t *)stream->flash_args + pos, data, len);
+        stream->flash_args_received += len;
+    } else if (tag == FILETAG_RCP_REGION_DIGESTS) {
+        memcpy(stream->digests + pos, data, len);
+        if (pos + len == subfile->size) {
+            return verify_region_digests(stream, subfile->size);
+        }
+    } else if (is_flashed_tag(tag)) {
+        return write_binary(stream, subfile, pos, data, len);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_rcp_stream_write(esp_rcp_stream_t *stream, uint32_t offset, const uint8_t *data, size_t size)
+{
+    while (size > 0) {
+        const esp_rcp_subfile_info_t *subfile = NULL;
+        uint32_t next_start = UINT32_MAX;
+        size_t len;
+
+        // The first entry is the image header itself, which is not streamed.
+        for (uint8_t i = 1; i < stream->subfile_num; i++) {
+            const esp_rcp_subfile_info_t *info = &stream->subfiles[i];
+            if (offset >= info->offset && offset - info->offset < info->size) {
+                subfile = info;
+                break;
+            }
+            if (info->offset > offset && info->offset < next_start) {
+                next_start = info->offset;
+            }
+        }
+        if (subfile) {
+            len = subfile->offset + subfile->size - offset;
+            len = size < len ? size : len;
+            ESP_RETURN_ON_ERROR(write_subfile(stream, subfile, offset - subfile->offset, data, len), TAG,
+                                "Failed to stream subfile %lu", subfile->tag & FILETAG_MASK);
+        } else if (next_start != UINT32_MAX) {
+            len = next_start - offset;
+            len = size < len ? size : len;
+        } else {
+            break;
+        }
+        offset += len;
+        data += len;
+        size -= len;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_rcp_stream_end(esp_rcp_stream_t *stream)
+{
+    esp_err_t ret = ESP_OK;
+
+    for (uint8_t i = 0; i < stream->flash_arg_num && ret == ESP_OK; i++) {
+        uint32_t tag = stream->flash_args[i].tag;
+        if (!is_flashed_tag(tag) || !(stream->flashed_tags & (1UL << tag))) {
+            ESP_LOGE(TAG, "Subfile %lu is not flashed", tag);
+            ret = ESP_ERR_INVALID_STATE;
+        }
+    }
+    if (ret == ESP_OK && stream->digests && !stream->digests_verified) {
+        ESP_LOGE(TAG, "The region digests are not verified");
+        ret = ESP_ERR_INVALID_STATE;
+    }
+    esp_rcp_loader_disconnect();
+    free_stream(stream);
+    return ret;
+}
+
+void esp_rcp_stream_abort(esp_rcp_stream_t *stream)
+{
+    esp_rcp_loader_disconnect();
+    free_stream(stream);
+}
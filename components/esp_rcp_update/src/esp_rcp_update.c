@@ -8,6 +8,7 @@
 
 #include <ctype.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "esp32_port.h"
@@ -16,137 +17,437 @@
 #include "esp_loader.h"
 #include "esp_log.h"
 #include "esp_rcp_firmware.h"
+#include "esp_rcp_image_format.h"
+#include "esp_rcp_image_meta.h"
+#include "esp_rcp_image_store.h"
+#include "esp_rcp_loader.h"
+#include "esp_rcp_progress.h"
+#include "esp_rom_md5.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
 #include "nvs.h"
 #include "nvs_flash.h"
 #include "driver/gpio.h"
 #include "driver/uart.h"
 
-#define RCP_UPDATE_MAX_RETRY 3
 #define RCP_VERIFIED_FLAG (1 << 5)
 #define RCP_SEQ_KEY "rcp_seq"
+#define RCP_FLASH_SECTOR_SIZE 0x1000
+#define RCP_REGION_MD5_SIZE 16
+#define RCP_BAUD_LADDER_MAX_LEN 8
+// Readable on all the chips, read to check the link to the loader.
+#define CHIP_DETECT_MAGIC_REG_ADDR 0x40001000
 #define TAG "RCP_UPDATE"
 
+// The baudrates tried below the update baudrate, from the fastest.
+static const uint32_t k_baud_ladder[] = {2000000, 1500000, 921600, 460800, 230400, 115200};
+
 typedef struct esp_rcp_update_handle {
     nvs_handle_t nvs_handle;
     int8_t update_seq;
     bool verified;
     esp_rcp_update_config_t update_config;
+    esp_rcp_progress_tracker_t flash_progress;
+    esp_rcp_progress_cb_t progress_callback;
+    void *progress_user_ctx;
+    uint32_t baud_ladder[RCP_BAUD_LADDER_MAX_LEN]; /* the baudrates to flash the RCP at, from the fastest */
+    size_t baud_num;
+    size_t baud_index;                             /* the index of the baudrate in use */
+    uint32_t link_baudrate;                        /* the baudrate of the UART port */
+    uint32_t link_failures;                        /* the failures at the baudrate in use */
 } esp_rcp_update_handle;
 
-struct rcp_flash_arg_t {
-    uint32_t tag;
-    uint32_t offset;
-} __attribute__((packed));
-
-typedef struct rcp_flash_arg_t rcp_flash_arg_t;
-
 static esp_rcp_update_handle s_handle;
 
-static esp_loader_error_t connect_to_target(target_chip_t target_chip, uint32_t higher_baudrate)
+// The ladder starts at the update baudrate and ends at the baudrate the loader is connected at.
+static void init_baud_ladder(void)
+{
+    uint32_t base = s_handle.update_config.uart_baudrate;
+    uint32_t top = s_handle.update_config.update_baudrate;
+
+    s_handle.baud_num = 0;
+    if (top > base) {
+        s_handle.baud_ladder[s_handle.baud_num++] = top;
+        for (size_t i = 0; i < sizeof(k_baud_ladder) / sizeof(k_baud_ladder[0]); i++) {
+            if (k_baud_ladder[i] < top && k_baud_ladder[i] > base) {
+                s_handle.baud_ladder[s_handle.baud_num++] = k_baud_ladder[i];
+            }
+        }
+    }
+    s_handle.baud_ladder[s_handle.baud_num++] = base;
+    s_handle.baud_index = 0;
+    s_handle.link_failures = 0;
+}
+
+static esp_err_t connect_loader(void)
 {
     esp_loader_connect_args_t connect_config = ESP_LOADER_CONNECT_DEFAULT();
+    uint32_t base = s_handle.update_config.uart_baudrate;
 
-    esp_loader_error_t err = esp_loader_connect(&connect_config);
-    if (err != ESP_LOADER_SUCCESS) {
-        return err;
-    }
-    if (esp_loader_get_target() != target_chip) {
-        return ESP_LOADER_ERROR_UNSUPPORTED_CHIP;
+    if (s_handle.link_baudrate != base) {
+        ESP_RETURN_ON_FALSE(loader_port_change_transmission_rate(base) == ESP_LOADER_SUCCESS, ESP_FAIL, TAG,
+                            "Failed to change local port baudrate");
+        s_handle.link_baudrate = base;
     }
+    ESP_RETURN_ON_FALSE(esp_loader_connect(&connect_config) == ESP_LOADER_SUCCESS, ESP_FAIL, TAG,
+                        "Failed to connect to the loader");
+    ESP_RETURN_ON_FALSE(esp_loader_get_target() == s_handle.update_config.target_chip, ESP_ERR_NOT_SUPPORTED, TAG,
+                        "Unsupported RCP chip");
+    return ESP_OK;
+}
 
-    if (higher_baudrate) {
-        ESP_RETURN_ON_ERROR(esp_loader_change_transmission_rate(higher_baudrate), TAG,
+// Switch the loader and the UART port to @baudrate and check that the loader responds.
+static esp_err_t switch_baudrate(uint32_t baudrate)
+{
+    uint32_t reg_value;
+
+    if (baudrate != s_handle.link_baudrate) {
+        ESP_RETURN_ON_FALSE(esp_loader_change_transmission_rate(baudrate) == ESP_LOADER_SUCCESS, ESP_FAIL, TAG,
                             "Failed to change bootloader baudrate");
-        ESP_RETURN_ON_ERROR(loader_port_change_transmission_rate(higher_baudrate), TAG,
+        ESP_RETURN_ON_FALSE(loader_port_change_transmission_rate(baudrate) == ESP_LOADER_SUCCESS, ESP_FAIL, TAG,
                             "Failed to change local port baudrate");
+        s_handle.link_baudrate = baudrate;
     }
-    return ESP_LOADER_SUCCESS;
+    ESP_RETURN_ON_FALSE(esp_loader_read_register(CHIP_DETECT_MAGIC_REG_ADDR, &reg_value) == ESP_LOADER_SUCCESS,
+                        ESP_FAIL, TAG, "No response from the loader at %lu", baudrate);
+    return ESP_OK;
 }
 
-static esp_err_t seek_to_subfile(FILE *fp, esp_rcp_filetag_t tag, esp_rcp_subfile_info_t *found_info)
+// Connect to the loader at the fastest baudrate of the ladder it responds at.
+static esp_err_t connect_to_target(void)
 {
-    if (fseek(fp, 0, SEEK_SET) != 0) {
-        return ESP_FAIL;
+    init_baud_ladder();
+    ESP_RETURN_ON_ERROR(connect_loader(), TAG, "Failed to connect to the loader");
+    while (switch_baudrate(s_handle.baud_ladder[s_handle.baud_index]) != ESP_OK) {
+        ESP_RETURN_ON_FALSE(s_handle.baud_index + 1 < s_handle.baud_num, ESP_FAIL, TAG, "No working baudrate");
+        s_handle.baud_index++;
+        ESP_RETURN_ON_ERROR(connect_loader(), TAG, "Failed to connect to the loader");
     }
-    esp_rcp_subfile_info_t subfile_info;
-    if (fread(&subfile_info, 1, sizeof(subfile_info), fp) != sizeof(subfile_info)) {
-        return ESP_FAIL;
+    ESP_LOGI(TAG, "Connected to the RCP loader at %lu", s_handle.link_baudrate);
+    return ESP_OK;
+}
+
+// Count a failure of the link to the loader, and resynchronize with the loader. The baudrate is stepped down after
+// RCP_UPDATE_BAUD_STEP_DOWN_FAILURES consecutive failures at a baudrate, the update gives up after as many failures
+// at the slowest one. The count is reset whenever a block is acknowledged.
+static esp_err_t recover_link(void)
+{
+    if (++s_handle.link_failures >= CONFIG_RCP_UPDATE_BAUD_STEP_DOWN_FAILURES) {
+        ESP_RETURN_ON_FALSE(s_handle.baud_index + 1 < s_handle.baud_num, ESP_FAIL, TAG,
+                            "Too many failures at %lu", s_handle.link_baudrate);
+        s_handle.baud_index++;
+        s_handle.link_failures = 0;
+        ESP_LOGW(TAG, "Stepping the baudrate down to %lu", s_handle.baud_ladder[s_handle.baud_index]);
     }
-    if (subfile_info.tag != FILETAG_IMAGE_HEADER || subfile_info.size % sizeof(subfile_info) != 0) {
-        return ESP_FAIL;
+    if (switch_baudrate(s_handle.baud_ladder[s_handle.baud_index]) != ESP_OK) {
+        ESP_LOGW(TAG, "Reconnecting to the loader");
+        ESP_RETURN_ON_ERROR(connect_loader(), TAG, "Failed to reconnect to the loader");
+        ESP_RETURN_ON_ERROR(switch_baudrate(s_handle.baud_ladder[s_handle.baud_index]), TAG,
+                            "Failed to switch the baudrate");
     }
+    return ESP_OK;
+}
 
-    int num_subfiles = subfile_info.size / sizeof(subfile_info);
-    for (int i = 1; i < num_subfiles; i++) {
-        if (fread(&subfile_info, 1, sizeof(subfile_info), fp) != sizeof(subfile_info)) {
-            return ESP_FAIL;
-        }
-        if (subfile_info.tag == tag) {
-            *found_info = subfile_info;
-            return fseek(fp, subfile_info.offset, SEEK_SET) == 0 ? ESP_OK : ESP_FAIL;
-        }
+// Cache the metadata of the image in the slot @param seq opened for reading, unless it is cached already.
+static void cache_image_meta(int8_t seq, esp_rcp_image_t *image)
+{
+    esp_rcp_image_meta_t meta;
+    esp_rcp_image_meta_t cached;
+
+    if (esp_rcp_image_meta_read(image, &meta) != ESP_OK) {
+        return;
+    }
+    esp_err_t err = esp_rcp_image_meta_load(seq, &cached);
+    if (err == ESP_OK && memcmp(&meta, &cached, sizeof(meta)) == 0) {
+        return;
+    }
+    if (err == ESP_OK) {
+        ESP_LOGW(TAG, "The cached metadata of image %d is stale", seq);
+    }
+    if (esp_rcp_image_meta_save(seq, &meta) != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to cache the metadata of image %d", seq);
     }
-    return ESP_ERR_NOT_FOUND;
 }
 
 esp_err_t esp_rcp_load_version_in_storage(char *version_str, size_t size)
 {
-    char fullpath[RCP_FILENAME_MAX_SIZE];
-    int8_t update_seq = esp_rcp_get_update_seq();
-
-    sprintf(fullpath, "%s_%d/" ESP_RCP_IMAGE_FILENAME, s_handle.update_config.firmware_dir, update_seq);
-    FILE *fp = fopen(fullpath, "r");
-    if (fp == NULL) {
-        return ESP_ERR_NOT_FOUND;
-    }
+    esp_err_t ret = ESP_OK;
+    int8_t seq = esp_rcp_get_update_seq();
+    esp_rcp_image_t image;
+    esp_rcp_image_meta_t meta;
     esp_rcp_subfile_info_t version_info;
-    ESP_RETURN_ON_ERROR(seek_to_subfile(fp, FILETAG_RCP_VERSION, &version_info), TAG, "Failed to find version subfile");
+
     memset(version_str, 0, size);
-    int read_size = size < version_info.size ? size : version_info.size;
-    fread(version_str, 1, read_size, fp);
-    fclose(fp);
+    if (esp_rcp_image_meta_load(seq, &meta) == ESP_OK) {
+        size_t version_len = strlen(meta.version);
+        memcpy(version_str, meta.version, size < version_len ? size : version_len);
+        return ESP_OK;
+    }
+    ESP_RETURN_ON_ERROR(esp_rcp_image_open(seq, &image), TAG, "Cannot find rcp image");
+    ESP_GOTO_ON_ERROR(esp_rcp_image_find_subfile(&image, FILETAG_RCP_VERSION, &version_info), exit, TAG,
+                      "Failed to find version subfile");
+    size_t read_size = size < version_info.size ? size : version_info.size;
+    ESP_GOTO_ON_ERROR(esp_rcp_image_read(&image, version_info.offset, version_str, read_size), exit, TAG,
+                      "Failed to read version subfile");
+    // The image flashed along with the firmware is cached on its first check, the next boots skip the storage.
+    cache_image_meta(seq, &image);
+exit:
+    esp_rcp_image_close(&image);
+    return ret;
+}
+
+esp_err_t esp_rcp_load_image_id_in_storage(uint8_t *image_id)
+{
+    esp_err_t ret = ESP_OK;
+    int8_t seq = esp_rcp_get_update_seq();
+    esp_rcp_image_t image;
+    esp_rcp_image_meta_t meta;
+
+    if (esp_rcp_image_meta_load(seq, &meta) != ESP_OK) {
+        ESP_RETURN_ON_ERROR(esp_rcp_image_open(seq, &image), TAG, "Cannot find rcp image");
+        ret = esp_rcp_image_meta_read(&image, &meta);
+        if (ret == ESP_OK && esp_rcp_image_meta_save(seq, &meta) != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to cache the metadata of image %d", seq);
+        }
+        esp_rcp_image_close(&image);
+        ESP_RETURN_ON_ERROR(ret, TAG, "Failed to read the metadata of image %d", seq);
+    }
+    memcpy(image_id, meta.digest, sizeof(meta.digest));
     return ESP_OK;
 }
 
-static esp_loader_error_t flash_binary(FILE *firmware, size_t size, size_t address)
+typedef esp_loader_error_t (*rcp_flash_write_fn_t)(void *payload, uint32_t size);
+
+static void flash_progress_add(uint32_t size)
+{
+    esp_rcp_progress_update(&s_handle.flash_progress, s_handle.flash_progress.progress.bytes_done + size);
+}
+
+// Send a block to the loader.
+static esp_loader_error_t write_block(rcp_flash_write_fn_t write_fn, uint8_t *data, uint32_t len)
+{
+    esp_loader_error_t err = write_fn(data, len);
+
+    if (err == ESP_LOADER_SUCCESS) {
+        // Only the consecutive failures count towards stepping the baudrate down.
+        s_handle.link_failures = 0;
+    }
+    return err;
+}
+
+// The bytes of a binary written to the RCP, a failed binary is resumed from the last complete flash sector.
+typedef struct rcp_flash_resume {
+    bool resumable;          /* whether the binary starts at a flash sector */
+    uint32_t written;        /* the bytes written */
+    md5_context_t md5;       /* the MD5 of the bytes written */
+    uint32_t done;           /* the bytes written up to the last complete flash sector */
+    md5_context_t done_md5;  /* the MD5 of the bytes done */
+} rcp_flash_resume_t;
+
+static void flash_resume_add(rcp_flash_resume_t *resume, const uint8_t *data, uint32_t len)
+{
+    while (len > 0) {
+        uint32_t chunk = RCP_FLASH_SECTOR_SIZE - resume->written % RCP_FLASH_SECTOR_SIZE;
+        chunk = chunk < len ? chunk : len;
+        esp_rom_md5_update(&resume->md5, data, chunk);
+        resume->written += chunk;
+        data += chunk;
+        len -= chunk;
+        if (resume->resumable && resume->written % RCP_FLASH_SECTOR_SIZE == 0) {
+            resume->done = resume->written;
+            resume->done_md5 = resume->md5;
+        }
+    }
+}
+
+typedef struct rcp_flash_block {
+    uint8_t *data;
+    int32_t len; /* the length of the data, 0 at the end of the stream and -1 on read failure */
+} rcp_flash_block_t;
+
+typedef struct rcp_flash_reader {
+    esp_rcp_image_t *image;
+    uint32_t offset;
+    size_t size;
+    QueueHandle_t free_queue;   /* the blocks which can be filled */
+    QueueHandle_t filled_queue; /* the blocks which are ready to be sent */
+    volatile bool abort;
+} rcp_flash_reader_t;
+
+static void flash_reader_task(void *arg)
+{
+    rcp_flash_reader_t *reader = (rcp_flash_reader_t *)arg;
+    QueueHandle_t filled_queue = reader->filled_queue;
+    uint32_t offset = reader->offset;
+    size_t size = reader->size;
+    rcp_flash_block_t block;
+
+    while (true) {
+        xQueueReceive(reader->free_queue, &block.data, portMAX_DELAY);
+        if (reader->abort || size == 0) {
+            block.len = 0;
+            break;
+        }
+        size_t to_read = size < CONFIG_RCP_FLASH_BLOCK_SIZE ? size : CONFIG_RCP_FLASH_BLOCK_SIZE;
+        if (esp_rcp_image_read(reader->image, offset, block.data, to_read) != ESP_OK) {
+            block.len = -1;
+            break;
+        }
+        block.len = to_read;
+        offset += to_read;
+        size -= to_read;
+        xQueueSend(filled_queue, &block, portMAX_DELAY);
+    }
+    // The reader shall not be accessed after the last block is sent, it is on the stack of the writer.
+    xQueueSend(filled_queue, &block, portMAX_DELAY);
+    vTaskDelete(NULL);
+}
+
+// Send @size bytes at @offset of @image with @write_fn. The image is read by a reader task into a ring of blocks, so
+// that the storage reads overlap with the transmission over UART. The written blocks are added to @resume if it is not
+// NULL.
+static esp_loader_error_t flash_stream(esp_rcp_image_t *image, uint32_t offset, size_t size,
+                                       rcp_flash_write_fn_t write_fn, rcp_flash_resume_t *resume)
+{
+    esp_loader_error_t err = ESP_LOADER_SUCCESS;
+    rcp_flash_reader_t reader = {.image = image, .offset = offset, .size = size, .abort = false};
+    uint8_t *blocks = malloc(CONFIG_RCP_FLASH_BLOCK_NUM * CONFIG_RCP_FLASH_BLOCK_SIZE);
+
+    reader.free_queue = xQueueCreate(CONFIG_RCP_FLASH_BLOCK_NUM, sizeof(uint8_t *));
+    reader.filled_queue = xQueueCreate(CONFIG_RCP_FLASH_BLOCK_NUM + 1, sizeof(rcp_flash_block_t));
+    if (!blocks || !reader.free_queue || !reader.filled_queue) {
+        ESP_LOGE(TAG, "Failed to allocate the flash blocks");
+        err = ESP_LOADER_ERROR_FAIL;
+        goto exit;
+    }
+    for (int i = 0; i < CONFIG_RCP_FLASH_BLOCK_NUM; i++) {
+        uint8_t *data = blocks + i * CONFIG_RCP_FLASH_BLOCK_SIZE;
+        xQueueSend(reader.free_queue, &data, 0);
+    }
+    if (xTaskCreate(flash_reader_task, "rcp_flash_reader", 3072, &reader, uxTaskPriorityGet(NULL), NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create the flash reader task");
+        err = ESP_LOADER_ERROR_FAIL;
+        goto exit;
+    }
+
+    while (true) {
+        rcp_flash_block_t block;
+        xQueueReceive(reader.filled_queue, &block, portMAX_DELAY);
+        if (block.len <= 0) {
+            if (block.len < 0 && err == ESP_LOADER_SUCCESS) {
+                ESP_LOGE(TAG, "Failed to read the firmware");
+                err = ESP_LOADER_ERROR_FAIL;
+            }
+            break;
+        }
+        // Keep draining the blocks after a failure until the reader stops.
+        if (err == ESP_LOADER_SUCCESS) {
+            err = write_block(write_fn, block.data, block.len);
+            if (err != ESP_LOADER_SUCCESS) {
+                ESP_LOGE(TAG, "Packet could not be written! Error %d.", err);
+                reader.abort = true;
+            } else {
+                flash_progress_add(block.len);
+                if (resume) {
+                    flash_resume_add(resume, block.data, block.len);
+                }
+            }
+        }
+        xQueueSend(reader.free_queue, &block.data, 0);
+    }
+
+exit:
+    if (reader.filled_queue) {
+        vQueueDelete(reader.filled_queue);
+    }
+    if (reader.free_queue) {
+        vQueueDelete(reader.free_queue);
+    }
+    free(blocks);
+    return err;
+}
+
+// Flash a raw binary. On a failure the link is recovered and the binary is resumed from the last complete flash sector,
+// the whole binary is verified once it is written.
+static esp_loader_error_t flash_binary(esp_rcp_image_t *image, uint32_t offset, size_t size, size_t address)
 {
     esp_loader_error_t err;
-    static uint8_t payload[1024];
+    rcp_flash_resume_t resume = {.resumable = address % RCP_FLASH_SECTOR_SIZE == 0};
+    uint8_t md5[RCP_REGION_MD5_SIZE];
+
+    esp_rom_md5_init(&resume.md5);
+    resume.done_md5 = resume.md5;
+    while (true) {
+        uint32_t done = resume.done;
+        ESP_LOGI(TAG, "Erasing flash (this may take a while)...");
+        err = esp_loader_flash_start(address + done, size - done, CONFIG_RCP_FLASH_BLOCK_SIZE);
+        if (err == ESP_LOADER_SUCCESS) {
+            if (done == 0) {
+                ESP_LOGI(TAG, "Start programming, binary_size %u", size);
+            } else {
+                ESP_LOGI(TAG, "Resume programming at %lu of %u", done, size);
+            }
+            err = flash_stream(image, offset + done, size - done, esp_loader_flash_write, &resume);
+            if (err == ESP_LOADER_SUCCESS) {
+                break;
+            }
+        } else {
+            ESP_LOGE(TAG, "Erasing flash failed with error %d.", err);
+        }
+        // Rewind to the last complete sector, which is erased again when the binary is resumed.
+        esp_rcp_progress_update(&s_handle.flash_progress,
+                                s_handle.flash_progress.progress.bytes_done - (resume.written - resume.done));
+        resume.written = resume.done;
+        resume.md5 = resume.done_md5;
+        if (recover_link() != ESP_OK) {
+            return err;
+        }
+    }
 
-    ESP_LOGI(TAG, "Erasing flash (this may take a while)...");
-    err = esp_loader_flash_start(address, size, sizeof(payload));
+    ESP_LOGI(TAG, "Finished programming");
+
+    esp_rom_md5_final(md5, &resume.md5);
+    err = esp_loader_flash_verify_known_md5(address, size, md5);
     if (err != ESP_LOADER_SUCCESS) {
-        ESP_LOGE(TAG, "Erasing flash failed with error %d.", err);
+        ESP_LOGE(TAG, "MD5 does not match. err: %d", err);
         return err;
     }
-    ESP_LOGI(TAG, "Start programming");
+    ESP_LOGI(TAG, "Flash verified");
 
-    size_t binary_size = size;
-    size_t written = 0;
+    return ESP_LOADER_SUCCESS;
+}
 
-    ESP_LOGI(TAG, "binary_size %u", binary_size);
-    while (size > 0) {
-        size_t to_read = size < sizeof(payload) ? size : sizeof(payload);
-        fread(payload, 1, to_read, firmware);
+static esp_loader_error_t flash_compressed_binary(esp_rcp_image_t *image, uint32_t offset, size_t size,
+                                                  size_t address)
+{
+    esp_loader_error_t err;
+    esp_rcp_compressed_info_t info;
 
-        err = esp_loader_flash_write(payload, to_read);
-        if (err != ESP_LOADER_SUCCESS) {
-            ESP_LOGE(TAG, "Packet could not be written! Error %d.", err);
-            return err;
-        }
+    if (size < sizeof(info) || esp_rcp_image_read(image, offset, &info, sizeof(info)) != ESP_OK) {
+        ESP_LOGE(TAG, "Invalid compressed subfile");
+        return ESP_LOADER_ERROR_INVALID_PARAM;
+    }
+    size -= sizeof(info);
 
-        size -= to_read;
-        written += to_read;
-        ESP_LOGI(TAG, "left size %u, written %u", size, written);
+    ESP_LOGI(TAG, "Erasing flash (this may take a while)...");
+    err = esp_loader_flash_deflate_start(address, info.raw_size, size, CONFIG_RCP_FLASH_BLOCK_SIZE);
+    if (err != ESP_LOADER_SUCCESS) {
+        ESP_LOGE(TAG, "Erasing flash failed with error %d.", err);
+        return err;
+    }
+    ESP_LOGI(TAG, "Start programming, binary_size %lu, compressed_size %u", info.raw_size, size);
 
-        int progress = (int)(((float)written / binary_size) * 100);
-        ESP_LOGI(TAG, "Progress: %d %%", progress);
-        fflush(stdout);
-    };
+    err = flash_stream(image, offset + sizeof(info), size, esp_loader_flash_deflate_write, NULL);
+    if (err != ESP_LOADER_SUCCESS) {
+        return err;
+    }
 
     ESP_LOGI(TAG, "Finished programming");
 
-    err = esp_loader_flash_verify();
+    // The loader computes the MD5 of the data it was sent, which is compressed here, so check the flash contents
+    // against the digest of the raw binary instead.
+    err = esp_loader_flash_verify_known_md5(address, info.raw_size, info.md5);
     if (err != ESP_LOADER_SUCCESS) {
         ESP_LOGE(TAG, "MD5 does not match. err: %d", err);
         return err;
@@ -156,6 +457,122 @@ static esp_loader_error_t flash_binary(FILE *firmware, size_t size, size_t addre
     return ESP_LOADER_SUCCESS;
 }
 
+static esp_loader_error_t flash_subfile(esp_rcp_image_t *image, const esp_rcp_subfile_info_t *subfile,
+                                        size_t address)
+{
+    if (subfile->tag & FILETAG_FLAG_COMPRESSED) {
+        return flash_compressed_binary(image, subfile->offset, subfile->size, address);
+    }
+    return flash_binary(image, subfile->offset, subfile->size, address);
+}
+
+typedef struct rcp_region_digests {
+    uint32_t region_size;
+    uint32_t region_count;
+    uint32_t raw_size;
+    uint8_t (*md5)[RCP_REGION_MD5_SIZE];
+} rcp_region_digests_t;
+
+static esp_err_t load_region_digests(esp_rcp_image_t *image, uint32_t tag, rcp_region_digests_t *digests)
+{
+    esp_rcp_subfile_info_t subfile;
+    esp_rcp_region_digests_t header;
+    esp_rcp_region_digests_entry_t entry;
+    uint32_t offset;
+
+    memset(digests, 0, sizeof(*digests));
+    if (esp_rcp_image_find_subfile(image, FILETAG_RCP_REGION_DIGESTS, &subfile) != ESP_OK) {
+        // The images of version 1 carry no region digests, their subfiles are flashed as a whole.
+        return ESP_ERR_NOT_FOUND;
+    }
+    offset = subfile.offset;
+    ESP_RETURN_ON_ERROR(esp_rcp_image_read(image, offset, &header, sizeof(header)), TAG,
+                        "Failed to read region digests");
+    offset += sizeof(header);
+    ESP_RETURN_ON_FALSE(header.region_size > 0 && header.region_size % RCP_FLASH_SECTOR_SIZE == 0,
+                        ESP_ERR_INVALID_SIZE, TAG, "Invalid region size %lu", header.region_size);
+    for (uint32_t i = 0; i < header.entry_count; i++) {
+        ESP_RETURN_ON_ERROR(esp_rcp_image_read(image, offset, &entry, sizeof(entry)), TAG,
+                            "Failed to read region digests");
+        offset += sizeof(entry);
+        uint32_t region_count = (entry.raw_size + header.region_size - 1) / header.region_size;
+        if (entry.tag != tag) {
+            offset += region_count * RCP_REGION_MD5_SIZE;
+            continue;
+        }
+        digests->md5 = malloc(region_count * RCP_REGION_MD5_SIZE);
+        ESP_RETURN_ON_FALSE(digests->md5, ESP_ERR_NO_MEM, TAG, "Failed to allocate region digests");
+        if (esp_rcp_image_read(image, offset, digests->md5, region_count * RCP_REGION_MD5_SIZE) != ESP_OK) {
+            free(digests->md5);
+            digests->md5 = NULL;
+            ESP_LOGE(TAG, "Failed to read region digests");
+            return ESP_FAIL;
+        }
+        digests->region_size = header.region_size;
+        digests->region_count = region_count;
+        digests->raw_size = entry.raw_size;
+        return ESP_OK;
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+static esp_loader_error_t flash_binary_range(esp_rcp_image_t *image, const esp_rcp_subfile_info_t *subfile,
+                                             uint32_t start, uint32_t end, size_t address)
+{
+    return flash_binary(image, subfile->offset + start, end - start, address + start);
+}
+
+// Compare the MD5 of each region of the RCP flash with the digests shipped in the image, and only erase and write
+// the regions that differ. A compressed subfile cannot be written partially, so it is skipped or flashed as a whole.
+static esp_loader_error_t flash_subfile_regions(esp_rcp_image_t *image, const esp_rcp_subfile_info_t *subfile,
+                                                size_t address, const rcp_region_digests_t *digests)
+{
+    esp_loader_error_t err = ESP_LOADER_SUCCESS;
+    bool compressed = subfile->tag & FILETAG_FLAG_COMPRESSED;
+    uint32_t dirty_start = UINT32_MAX;
+    uint32_t skipped = 0;
+
+    if (!compressed && digests->raw_size != subfile->size) {
+        return flash_subfile(image, subfile, address);
+    }
+    for (uint32_t i = 0; i < digests->region_count; i++) {
+        uint32_t region_start = i * digests->region_size;
+        uint32_t region_size = digests->raw_size - region_start < digests->region_size
+            ? digests->raw_size - region_start
+            : digests->region_size;
+        bool unchanged =
+            esp_loader_flash_verify_known_md5(address + region_start, region_size, digests->md5[i]) ==
+            ESP_LOADER_SUCCESS;
+
+        if (unchanged) {
+            skipped++;
+            if (!compressed) {
+                flash_progress_add(region_size);
+            }
+        }
+        if (compressed) {
+            if (!unchanged) {
+                return flash_subfile(image, subfile, address);
+            }
+        } else if (!unchanged && dirty_start == UINT32_MAX) {
+            dirty_start = region_start;
+        } else if (unchanged && dirty_start != UINT32_MAX) {
+            err = flash_binary_range(image, subfile, dirty_start, region_start, address);
+            if (err != ESP_LOADER_SUCCESS) {
+                return err;
+            }
+            dirty_start = UINT32_MAX;
+        }
+    }
+    if (dirty_start != UINT32_MAX) {
+        err = flash_binary_range(image, subfile, dirty_start, digests->raw_size, address);
+    } else if (compressed) {
+        flash_progress_add(subfile->size);
+    }
+    ESP_LOGI(TAG, "Skipped %lu of %lu unchanged regions at 0x%x", skipped, digests->region_count, address);
+    return err;
+}
+
 static void load_rcp_update_seq(esp_rcp_update_handle *handle)
 {
     int8_t seq = 0;
@@ -194,14 +611,26 @@ esp_err_t esp_rcp_submit_new_image()
                         "RCP update not initialized");
     s_handle.update_seq = esp_rcp_get_next_update_seq();
     s_handle.verified = true;
+    // The slot holds a new image, its header is parsed again on the next opening and its metadata cached again below.
+    esp_rcp_image_invalidate_index(s_handle.update_seq);
+    if (esp_rcp_image_meta_erase(s_handle.update_seq) != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to discard the metadata of image %d", s_handle.update_seq);
+    }
 
     int8_t new_seq = s_handle.update_seq | RCP_VERIFIED_FLAG;
     esp_err_t error = nvs_set_i8(s_handle.nvs_handle, RCP_SEQ_KEY, new_seq);
     if (error == ESP_OK) {
-        return nvs_commit(s_handle.nvs_handle);
-    } else {
-        return error;
+        error = nvs_commit(s_handle.nvs_handle);
     }
+    if (error == ESP_OK) {
+        // The version is then checked on boot without opening the image.
+        esp_rcp_image_t image;
+        if (esp_rcp_image_open(s_handle.update_seq, &image) == ESP_OK) {
+            cache_image_meta(s_handle.update_seq, &image);
+            esp_rcp_image_close(&image);
+        }
+    }
+    return error;
 }
 
 esp_err_t esp_rcp_update_init(const esp_rcp_update_config_t *update_config)
@@ -209,6 +638,7 @@ esp_err_t esp_rcp_update_init(const esp_rcp_update_config_t *update_config)
     ESP_RETURN_ON_ERROR(nvs_open("storage", NVS_READWRITE, &s_handle.nvs_handle), "TAG", "Failed to open nvs");
     ESP_RETURN_ON_FALSE(update_config->rcp_type > RCP_TYPE_INVALID && update_config->rcp_type < RCP_TYPE_MAX,
                         ESP_ERR_INVALID_ARG, TAG, "Unsupported RCP type");
+    ESP_RETURN_ON_ERROR(esp_rcp_image_store_init(), TAG, "Failed to initialize the image store");
 
     s_handle.update_config = *update_config;
     load_rcp_update_seq(&s_handle);
@@ -230,7 +660,23 @@ static esp_err_t esp_rcp_boot_pin_mux(void)
 }
 #endif
 
-esp_err_t esp_rcp_update(void)
+// The bytes of the flashed subfiles as stored in the image.
+static uint32_t get_flash_size(esp_rcp_image_t *image)
+{
+    static const esp_rcp_filetag_t k_flashed_tags[] = {FILETAG_RCP_BOOTLOADER, FILETAG_RCP_PARTITION_TABLE,
+                                                       FILETAG_RCP_FIRMWARE};
+    esp_rcp_subfile_info_t subfile;
+    uint32_t size = 0;
+
+    for (size_t i = 0; i < sizeof(k_flashed_tags) / sizeof(k_flashed_tags[0]); i++) {
+        if (esp_rcp_image_find_subfile(image, k_flashed_tags[i], &subfile) == ESP_OK) {
+            size += subfile.size;
+        }
+    }
+    return size;
+}
+
+esp_err_t esp_rcp_loader_connect(void)
 {
     ESP_RETURN_ON_FALSE(s_handle.update_config.rcp_type != RCP_TYPE_INVALID, ESP_ERR_INVALID_STATE, TAG,
                         "RCP update not initialized");
@@ -244,39 +690,13 @@ esp_err_t esp_rcp_update(void)
         .gpio0_trigger_pin = s_handle.update_config.boot_pin,
     };
     ESP_RETURN_ON_ERROR(loader_port_esp32_init(&loader_config), TAG, "Failed to initialize UART port");
-    ESP_RETURN_ON_ERROR(connect_to_target(s_handle.update_config.target_chip, s_handle.update_config.update_baudrate),
-                        TAG, "Failed to connect to RCP");
+    s_handle.link_baudrate = s_handle.update_config.uart_baudrate;
+    ESP_RETURN_ON_ERROR(connect_to_target(), TAG, "Failed to connect to RCP");
+    return ESP_OK;
+}
 
-    char fullpath[RCP_FILENAME_MAX_SIZE];
-    int update_seq = esp_rcp_get_update_seq();
-    sprintf(fullpath, "%s_%d/" ESP_RCP_IMAGE_FILENAME, s_handle.update_config.firmware_dir, update_seq);
-    FILE *fp = fopen(fullpath, "r");
-    ESP_RETURN_ON_FALSE(fp != NULL, ESP_ERR_NOT_FOUND, TAG, "Cannot find rcp image");
-    esp_rcp_subfile_info_t subfile;
-    seek_to_subfile(fp, FILETAG_RCP_FLASH_ARGS, &subfile);
-    int num_flash_binaries = subfile.size / sizeof(rcp_flash_arg_t);
-
-    for (int i = 0; i < num_flash_binaries; i++) {
-        rcp_flash_arg_t flash_args;
-        fread(&flash_args, 1, sizeof(flash_args), fp);
-        int num_retry = 0;
-        long current = ftell(fp);
-        if (seek_to_subfile(fp, flash_args.tag, &subfile) != ESP_OK) {
-            ESP_LOGE(TAG, "Failed to seek to subfile with tag %lu", flash_args.tag);
-            abort();
-        }
-        while (flash_binary(fp, subfile.size, flash_args.offset) != ESP_LOADER_SUCCESS) {
-            ESP_LOGW(TAG, "Failed to flash %s, retrying...", fullpath);
-            num_retry++;
-            if (num_retry > RCP_UPDATE_MAX_RETRY) {
-                ESP_LOGE(TAG, "Failed to update RCP, abort and reboot");
-                abort();
-            }
-            seek_to_subfile(fp, flash_args.tag, &subfile);
-        }
-        fseek(fp, current, SEEK_SET);
-    }
-    fclose(fp);
+esp_err_t esp_rcp_loader_disconnect(void)
+{
     esp_loader_reset_target();
     loader_port_esp32_deinit();
 
@@ -286,6 +706,79 @@ esp_err_t esp_rcp_update(void)
     return ESP_OK;
 }
 
+esp_err_t esp_rcp_update_register_progress_callback(esp_rcp_progress_cb_t callback, void *user_ctx)
+{
+    s_handle.progress_callback = callback;
+    s_handle.progress_user_ctx = user_ctx;
+    return ESP_OK;
+}
+
+esp_err_t esp_rcp_update(void)
+{
+    ESP_RETURN_ON_FALSE(s_handle.update_config.rcp_type != RCP_TYPE_INVALID, ESP_ERR_INVALID_STATE, TAG,
+                        "RCP update not initialized");
+
+    int update_seq = esp_rcp_get_update_seq();
+    esp_rcp_image_t image;
+    ESP_RETURN_ON_ERROR(esp_rcp_image_open(update_seq, &image), TAG, "Cannot find rcp image");
+    // Reject a corrupted image before the RCP is reset into its serial loader and erased.
+    esp_err_t err = esp_rcp_image_verify_digests(&image);
+    if (err != ESP_OK && err != ESP_ERR_NOT_FOUND) {
+        ESP_LOGE(TAG, "RCP image %d is corrupted: %s", update_seq, esp_err_to_name(err));
+        esp_rcp_image_close(&image);
+        return ESP_ERR_INVALID_CRC;
+    }
+    cache_image_meta(update_seq, &image);
+    err = esp_rcp_loader_connect();
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to connect to RCP");
+        esp_rcp_image_close(&image);
+        return err;
+    }
+    esp_rcp_subfile_info_t flash_args_info;
+    esp_rcp_progress_begin(&s_handle.flash_progress, ESP_RCP_PROGRESS_PHASE_RCP_FLASH, get_flash_size(&image),
+                           s_handle.progress_callback, s_handle.progress_user_ctx);
+    if (esp_rcp_image_find_subfile(&image, FILETAG_RCP_FLASH_ARGS, &flash_args_info) != ESP_OK) {
+        flash_args_info.size = 0;
+    }
+    int num_flash_binaries = flash_args_info.size / sizeof(esp_rcp_flash_arg_t);
+
+    for (int i = 0; i < num_flash_binaries && err == ESP_OK; i++) {
+        esp_rcp_flash_arg_t flash_args;
+        esp_rcp_subfile_info_t subfile;
+        if (esp_rcp_image_read(&image, flash_args_info.offset + i * sizeof(flash_args), &flash_args,
+                               sizeof(flash_args)) != ESP_OK ||
+            esp_rcp_image_find_subfile(&image, flash_args.tag, &subfile) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to find subfile %d of image %d", i, update_seq);
+            err = ESP_ERR_NOT_FOUND;
+            break;
+        }
+        rcp_region_digests_t digests;
+        bool has_digests = load_region_digests(&image, flash_args.tag, &digests) == ESP_OK;
+        uint32_t bytes_done = s_handle.flash_progress.progress.bytes_done;
+        while ((has_digests ? flash_subfile_regions(&image, &subfile, flash_args.offset, &digests)
+                            : flash_subfile(&image, &subfile, flash_args.offset)) != ESP_LOADER_SUCCESS) {
+            // The link is recovered and the baudrate stepped down as long as there is a slower one to try.
+            if (recover_link() != ESP_OK) {
+                ESP_LOGE(TAG, "Failed to flash subfile %lu of image %d", flash_args.tag, update_seq);
+                err = ESP_FAIL;
+                break;
+            }
+            ESP_LOGW(TAG, "Failed to flash subfile %lu of image %d, retrying...", flash_args.tag, update_seq);
+            esp_rcp_progress_update(&s_handle.flash_progress, bytes_done);
+        }
+        free(digests.md5);
+    }
+    esp_rcp_image_close(&image);
+    esp_rcp_progress_end(&s_handle.flash_progress, err == ESP_OK);
+    esp_err_t disconnect_err = esp_rcp_loader_disconnect();
+    if (err == ESP_OK) {
+        err = disconnect_err;
+    }
+    ESP_LOGI(TAG, "RCP update %s at %lu", err == ESP_OK ? "done" : "failed", s_handle.link_baudrate);
+    return err;
+}
+
 void esp_rcp_update_deinit(void)
 {
     nvs_close(s_handle.nvs_handle);
@@ -15,10 +15,10 @@
  #include "esp_openthread.h"
  #include "esp_openthread_border_router.h"
  #include "esp_openthread_types.h"
+ #include "esp_ot_boot_timeline.h"
  #include "esp_ot_config.h"
  #include "esp_ot_ota_commands.h"
  #include "esp_ot_wifi_cmd.h"
- #include "esp_spiffs.h"
  #include "esp_vfs_eventfd.h"
  #include "mdns.h"
  #include "nvs_flash.h"
@@ -44,32 +44,14 @@
  
  extern const uint8_t server_cert_pem_start[] asm("_binary_ca_cert_pem_start");
  extern const uint8_t server_cert_pem_end[] asm("_binary_ca_cert_pem_end");
+ #if CONFIG_OPENTHREAD_BR_WEB_HTTPS
+ extern const char web_server_cert_pem_start[] asm("_binary_web_server_cert_pem_start");
+ extern const char web_server_key_pem_start[] asm("_binary_web_server_key_pem_start");
+ #endif
  
  static SemaphoreHandle_t wifi_connect_semaphore = NULL;
  static bool wifi_connect_success = false;
- 
- static esp_err_t init_spiffs(void)
- {
-     #if CONFIG_AUTO_UPDATE_RCP
-     esp_vfs_spiffs_conf_t rcp_fw_conf = {
-         .base_path = "/" CONFIG_RCP_PARTITION_NAME,
-         .partition_label = CONFIG_RCP_PARTITION_NAME,
-         .max_files = 10,
-         .format_if_mount_failed = false
-     };
-     ESP_RETURN_ON_ERROR(esp_vfs_spiffs_register(&rcp_fw_conf), TAG, "Failed to mount rcp firmware storage");
-     #endif
-     #if CONFIG_OPENTHREAD_BR_START_WEB
-     esp_vfs_spiffs_conf_t web_server_conf = {
-         .base_path = "/spiffs",
-         .partition_label = "web_storage",
-         .max_files = 10,
-         .format_if_mount_failed = false
-     };
-     ESP_RETURN_ON_ERROR(esp_vfs_spiffs_register(&web_server_conf), TAG, "Failed to mount web storage");
-     #endif
-     return ESP_OK;
- }
+ static TaskHandle_t s_reset_button_task = NULL;
  
  void url_decode(const char *src, char *dst)
  {
@@ -96,32 +78,6 @@
      *dst++ = '\0';
  }
  
- static bool check_reset_button(void)
- {
-     gpio_config_t io_conf = {
-         .pin_bit_mask = (1ULL << RESET_BUTTON_GPIO),
-         .mode = GPIO_MODE_INPUT,
-         .pull_up_en = GPIO_PULLUP_ENABLE,
-         .pull_down_en = GPIO_PULLDOWN_DISABLE,
-         .intr_type = GPIO_INTR_DISABLE,
-     };
-     gpio_config(&io_conf);
- 
-     ESP_LOGI(TAG, "Checking reset button");
- 
-     int held_time = 0;
- 
-     while (held_time < RESET_HOLD_TIME_MS) {
-         if (gpio_get_level(RESET_BUTTON_GPIO) == 0)
-             return true;
- 
-         vTaskDelay(pdMS_TO_TICKS(100));
-         held_time += 100;
-     }
- 
-     return false;
- }
- 
  static void reset_wifi_credentials(void)
  {
      nvs_handle_t nvs_handle;
@@ -146,6 +102,59 @@
      return (err == ESP_OK && required_size > 1);
  }
  
+ static void IRAM_ATTR reset_button_isr_handler(void *arg)
+ {
+     BaseType_t task_woken = pdFALSE;
+ 
+     vTaskNotifyGiveFromISR(s_reset_button_task, &task_woken);
+     portYIELD_FROM_ISR(task_woken);
+ }
+ 
+ static void reset_button_task(void *arg)
+ {
+     bool pressed = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(RESET_HOLD_TIME_MS)) > 0;
+ 
+     gpio_isr_handler_remove(RESET_BUTTON_GPIO);
+     gpio_set_intr_type(RESET_BUTTON_GPIO, GPIO_INTR_DISABLE);
+     // The device restarts into the setup AP, where a button still pressed does not restart it again.
+     if (pressed && wifi_credentials_exist()) {
+         ESP_LOGI(TAG, "Reset button was pressed. Clearing Wi-Fi settings.");
+         reset_wifi_credentials();
+         esp_restart();
+     }
+     vTaskDelete(NULL);
+ }
+ 
+ /**
+  * The reset button is watched by an interrupt for RESET_HOLD_TIME_MS after boot instead of being polled before the
+  * boot continues. A press in this window clears the Wi-Fi settings and restarts the device, which then starts the
+  * setup AP. The interrupt only notifies a task, which also closes the window.
+  */
+ static esp_err_t init_reset_button(void)
+ {
+     gpio_config_t io_conf = {
+         .pin_bit_mask = (1ULL << RESET_BUTTON_GPIO),
+         .mode = GPIO_MODE_INPUT,
+         .pull_up_en = GPIO_PULLUP_ENABLE,
+         .pull_down_en = GPIO_PULLDOWN_DISABLE,
+         .intr_type = GPIO_INTR_NEGEDGE,
+     };
+ 
+     ESP_RETURN_ON_FALSE(xTaskCreate(reset_button_task, "reset_button", 3072, NULL, 5, &s_reset_button_task) == pdPASS,
+                         ESP_ERR_NO_MEM, TAG, "Failed to create reset button task");
+     ESP_RETURN_ON_ERROR(gpio_config(&io_conf), TAG, "Failed to configure reset button");
+     // The handler is placed in IRAM, so the press is also seen while the flash cache is disabled.
+     esp_err_t err = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+     ESP_RETURN_ON_FALSE(err == ESP_OK || err == ESP_ERR_INVALID_STATE, err, TAG, "Failed to install GPIO ISR service");
+     ESP_RETURN_ON_ERROR(gpio_isr_handler_add(RESET_BUTTON_GPIO, reset_button_isr_handler, NULL), TAG,
+                         "Failed to add reset button handler");
+     // The button may have been pressed before the interrupt is enabled.
+     if (gpio_get_level(RESET_BUTTON_GPIO) == 0) {
+         xTaskNotifyGive(s_reset_button_task);
+     }
+     return ESP_OK;
+ }
+ 
  static void wifi_start_ap(void)
  {
      esp_netif_create_default_wifi_ap();
@@ -524,9 +533,13 @@
      };
      esp_rcp_update_config_t rcp_update_config = ESP_OPENTHREAD_RCP_UPDATE_CONFIG();
  
+     esp_ot_boot_timeline_mark(ESP_OT_BOOT_STAGE_APP_START);
      ESP_ERROR_CHECK(esp_vfs_eventfd_register(&eventfd_config));
      ESP_ERROR_CHECK(nvs_flash_init());
-     ESP_ERROR_CHECK(init_spiffs());
+     esp_ot_boot_timeline_mark(ESP_OT_BOOT_STAGE_NVS_READY);
+     ESP_ERROR_CHECK(init_reset_button());
+     // The SPIFFS partitions are mounted on first use: the web storage by the web server, the RCP firmware
+     // storage by esp_rcp_update.
      ESP_ERROR_CHECK(esp_netif_init());
      ESP_ERROR_CHECK(esp_event_loop_create_default());
  
@@ -536,17 +549,16 @@
  
      ESP_ERROR_CHECK(mdns_init());
      ESP_ERROR_CHECK(mdns_hostname_set("esp-ot-br"));
+     esp_ot_boot_timeline_mark(ESP_OT_BOOT_STAGE_NETIF_READY);
      #if CONFIG_OPENTHREAD_CLI_OTA
      esp_set_ota_server_cert((char *)server_cert_pem_start);
      #endif
  
-     if (check_reset_button()) {
-         ESP_LOGI(TAG, "Reset button was pressed. Clearing Wi-Fi settings.");
-         reset_wifi_credentials();
-     }
- 
      if (wifi_credentials_exist()) {
          #if CONFIG_OPENTHREAD_BR_START_WEB
+         #if CONFIG_OPENTHREAD_BR_WEB_HTTPS
+         esp_br_web_set_server_cert(web_server_cert_pem_start, web_server_key_pem_start);
+         #endif
          esp_br_web_start("/spiffs");
          #endif
          launch_openthread_border_router(&platform_config, &rcp_update_config);
@@ -12,6 +12,7 @@
 #include <string.h>
 
 #include "esp_check.h"
+#include "esp_event.h"
 #include "esp_log.h"
 #include "esp_netif.h"
 #include "esp_openthread.h"
@@ -20,10 +21,12 @@
 #include "esp_openthread_lock.h"
 #include "esp_openthread_netif_glue.h"
 #include "esp_openthread_types.h"
+#include "esp_ot_boot_timeline.h"
 #include "esp_ot_cli_extension.h"
 #include "esp_rcp_update.h"
 #include "esp_vfs_eventfd.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
 #include "freertos/task.h"
 #include "openthread/backbone_router_ftd.h"
 #include "openthread/border_router.h"
@@ -41,6 +44,10 @@
 #include "esp_ot_wifi_cmd.h"
 #endif
 
+#if CONFIG_OPENTHREAD_CLI_OTA
+#include "esp_br_http_ota.h"
+#endif
+
 #if CONFIG_OPENTHREAD_BR_AUTO_START
 #include "esp_wifi.h"
 #include "example_common_private.h"
@@ -49,8 +56,10 @@
 
 #define TAG "esp_ot_br"
 #define RCP_VERSION_MAX_SIZE 100
+#define BOOT_OT_READY_BIT BIT0
 
 static esp_openthread_platform_config_t s_openthread_platform_config;
+static EventGroupHandle_t s_boot_events;
 
 #if CONFIG_AUTO_UPDATE_RCP
 static void update_rcp(void)
@@ -102,11 +111,29 @@ static void rcp_failure_handler(void)
 #endif
 }
 
+static void ot_role_changed_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data)
+{
+    esp_openthread_role_changed_event_t *event = (esp_openthread_role_changed_event_t *)event_data;
+
+    if (event->current_role >= OT_DEVICE_ROLE_CHILD) {
+        esp_ot_boot_timeline_mark(ESP_OT_BOOT_STAGE_THREAD_ATTACHED);
+    }
+    if (event->current_role >= OT_DEVICE_ROLE_ROUTER) {
+        esp_ot_boot_timeline_mark(ESP_OT_BOOT_STAGE_THREAD_ROUTING);
+    }
+}
+
+/**
+ * The backbone is connected while the OpenThread stack is initialized and the RCP is checked, the border routing
+ * features are then initialized once the OpenThread stack is ready.
+ *
+ * esp_ot_wifi_connect() and example_ethernet_connect() only use the Wi-Fi or Ethernet driver, esp_netif and the
+ * Wi-Fi config in NVS, they never touch the OpenThread instance. The instance is only used after BOOT_OT_READY_BIT
+ * is set, under the OpenThread lock. An RCP update may restart the chip in the middle of the connection, which
+ * only drops the backbone link and is reconnected on the next boot.
+ */
 static void ot_br_init(void *ctx)
 {
-#if CONFIG_OPENTHREAD_CLI_WIFI
-    ESP_ERROR_CHECK(esp_ot_wifi_config_init());
-#endif
 #if CONFIG_OPENTHREAD_BR_AUTO_START
 #if CONFIG_EXAMPLE_CONNECT_WIFI || CONFIG_EXAMPLE_CONNECT_ETHERNET
     bool wifi_or_ethernet_connected = false;
@@ -134,6 +161,10 @@ static void ot_br_init(void *ctx)
     ESP_ERROR_CHECK(example_ethernet_connect());
     wifi_or_ethernet_connected = true;
 #endif
+    if (wifi_or_ethernet_connected) {
+        esp_ot_boot_timeline_mark(ESP_OT_BOOT_STAGE_BACKBONE_UP);
+    }
+    xEventGroupWaitBits(s_boot_events, BOOT_OT_READY_BIT, pdFALSE, pdTRUE, portMAX_DELAY);
     if (wifi_or_ethernet_connected) {
         esp_openthread_lock_acquire(portMAX_DELAY);
         esp_openthread_set_backbone_netif(get_example_netif());
@@ -145,6 +176,7 @@ static void ot_br_init(void *ctx)
         otError error = otDatasetGetActiveTlvs(esp_openthread_get_instance(), &dataset);
         ESP_ERROR_CHECK(esp_openthread_auto_start((error == OT_ERROR_NONE) ? &dataset : NULL));
         esp_openthread_lock_release();
+        esp_ot_boot_timeline_mark(ESP_OT_BOOT_STAGE_BR_INIT);
     } else {
         ESP_LOGE(TAG, "Auto-start mode failed, please try to start manually");
     }
@@ -163,9 +195,11 @@ static void ot_task_worker(void *ctx)
     esp_openthread_register_rcp_failure_handler(rcp_failure_handler);
     esp_openthread_set_compatibility_error_callback(rcp_failure_handler);
     ESP_ERROR_CHECK(esp_openthread_init(&s_openthread_platform_config));
+    esp_ot_boot_timeline_mark(ESP_OT_BOOT_STAGE_OT_INIT);
 #if CONFIG_AUTO_UPDATE_RCP
     try_update_ot_rcp(&s_openthread_platform_config);
 #endif
+    esp_ot_boot_timeline_mark(ESP_OT_BOOT_STAGE_RCP_CHECKED);
     // Initialize border routing features
     esp_openthread_lock_acquire(portMAX_DELAY);
     ESP_ERROR_CHECK(esp_netif_attach(openthread_netif, esp_openthread_netif_glue_init(&s_openthread_platform_config)));
@@ -176,8 +210,9 @@ static void ot_task_worker(void *ctx)
     esp_cli_custom_command_init();
     esp_openthread_cli_create_task();
     esp_openthread_lock_release();
+    esp_ot_boot_timeline_mark(ESP_OT_BOOT_STAGE_CLI_READY);
 
-    xTaskCreate(ot_br_init, "ot_br_init", 6144, NULL, 4, NULL);
+    xEventGroupSetBits(s_boot_events, BOOT_OT_READY_BIT);
     // Run the main loop
     esp_openthread_launch_mainloop();
 
@@ -199,6 +234,19 @@ void launch_openthread_border_router(const esp_openthread_platform_config_t *pla
 #else
     OT_UNUSED_VARIABLE(update_config);
 #endif
+#if CONFIG_OPENTHREAD_CLI_OTA
+    if (esp_br_http_ota_init() != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to complete the interrupted OTA update");
+    }
+#endif
+#if CONFIG_OPENTHREAD_CLI_WIFI
+    ESP_ERROR_CHECK(esp_ot_wifi_config_init());
+#endif
+    s_boot_events = xEventGroupCreate();
+    assert(s_boot_events != NULL);
+    ESP_ERROR_CHECK(esp_event_handler_register(OPENTHREAD_EVENT, OPENTHREAD_EVENT_ROLE_CHANGED,
+                                               &ot_role_changed_handler, NULL));
 
     xTaskCreate(ot_task_worker, "ot_br_main", 8192, xTaskGetCurrentTaskHandle(), 5, NULL);
+    xTaskCreate(ot_br_init, "ot_br_init", 6144, NULL, 4, NULL);
 }